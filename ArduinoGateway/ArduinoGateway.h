@@ -23,6 +23,40 @@
 // too many protocols will slow down interrupt handling and may provide unrielable results
 #define A_MEGA 0
 
+// Decode 433MHz messages in loop() instead of in the interrupt handler (1), or decode in the
+// interrupt handler (0). In deferred mode the interrupt only buffers pulses, so Serial output of
+// the callbacks can no longer make us miss edges. But loop() must not block for long. The sensors
+// are read without waiting for their conversions, see SensorSweep.h.
+#define A_DEFERRED 0
+
+// Send 433MHz messages from a Timer1 interrupt (1), so loop() continues while a message is being
+// sent, or wait in the parse functions until the message is sent (0). Timer1 is then no longer
+// available for PWM on pins 9 and 10 or for the Servo library.
+#define A_TXTIMER 1
+
+// Keep the compiled frames of the last commands (1), so a command that is sent again is not
+// compiled again, or compile every command (0). Takes about 500 bytes of RAM, so for the Mega.
+#define A_TXCACHE 0
+
+// Aggregate the frames of the wireless sensors (WT440, Auriol) over a window of S_WINDOW seconds
+// (1), and send one message per sensor per window with the mean, or send every frame (0).
+// "> n 0 9" prints the table with last, min, max and mean, "> n 0 9 seconds" sets the window.
+// Takes 34 bytes of RAM per sensor, see AGGREGATE_SENSORS in SensorAggregator.h.
+#define A_AGGREGATE 0
+#define S_WINDOW 300
+
+// Raw capture mode (1): command "> n 0 5 1" makes the gateway stream the raw receiver pulses over
+// Serial, for learning new protocols with extras/host/rawtrace, "> n 0 5 0" stops it. While
+// capturing nothing is decoded and the sensors are not read. Takes 128 bytes of RAM.
+#define A_CAPTURE 1
+
+// Binary frames to and from the daemon (1): command "> n 0 10 1" switches Serial from text lines to
+// COBS frames with a CRC16 and fixed-layout records, "> n 0 10 0" switches back. Fewer bytes per
+// message, and a corrupted message is dropped instead of misread. See HostLink.h, and
+// extras/host/linkdump for a decoder. Takes about 75 bytes of RAM. Either way the messages go
+// through the output queue of HostLink, LINK_LINES lines of LINK_LINE bytes (4 of 40).
+#define A_BINARY 1
+
 // Enable Receivers of handsets. 
 // If you set to 0, the receiver functions will NOT be compiled and included.
 #define R_KOPOU  1
@@ -33,6 +67,10 @@
 #define R_BLOKKER 0
 #define R_QUHWA 1
 
+// Generic table-driven receiver (1) for remotes and sensors without a receiver of their own. The
+// table is OokTable.h, written by extras/host/ookinfer from a trace captured with A_CAPTURE.
+#define R_OOK 0
+
 // Enable transmitters yes (1) or no (0)
 #define T_QUHWA 1
 
@@ -52,3 +90,10 @@
 #define S_DS3231 0      //RTC I2C sensor      
 #define S_PIR 0         //PIR sensor connected to pin 6
 
+
+// The wired sensors are read every S_INTERVAL seconds, but a value is only sent when it changed
+// at least its deadband (see setup()), or when it was not sent for S_HEARTBEAT seconds. Admin
+// command "> n 0 7 task seconds" changes the interval of a sensor, "> n 0 8 value tenths seconds"
+// the deadband and heartbeat of a value.
+#define S_INTERVAL 15
+#define S_HEARTBEAT 300
@@ -63,11 +63,25 @@
 #include <RemoteReceiver.h>
 #include <auriolReceiver.h>		// if auriolCode undefined, preprocessor will fail.
 #include <quhwaReceiver.h>
-#include <InterruptChain.h>
+#include <OokReceiver.h>
+#include <DecoderChain.h>
+#include <DecoderSet.h>
+#include <DupCache.h>
+#include <PulseCapture.h>
+#include <PulseTransmitter.h>
+#include <FrameCache.h>
+#include <SensorSweep.h>
+#include <ReportFilter.h>
+#include <SensorAggregator.h>
+#include <HostLink.h>
 
 //
 // Sensors Include
 //
+#if R_OOK==1
+#include "OokTable.h"			// Written by extras/host/ookinfer
+#endif
+
 #if S_DALLAS==1
 #include <OneWire.h>
 #include <DallasTemperature.h>
@@ -90,13 +104,17 @@
 #include "DS3232RTC.h"		//http://github.com/JChristensen/DS3232RTC
 #endif
 
-unsigned long time;			// fill up with millis();
 boolean debug;				// If set, more informtion is output to the serial port
 int  readCnt;				// Character count in buffer
 char readChar;				// Last character read from tty
 char readLine[32];			// Buffer of characters read
 unsigned int msgCnt;		// Not unique, as at some time number will wrap.
 
+// All messages to the daemon go through Host: text lines, or binary frames after "> n 0 10 1".
+// After setup() they are queued, and loop() writes them as Serial has room, so a callback in the
+// interrupt never waits for Serial.
+HostLink Host(Serial);
+
 // Use a bit array (coded in long) to keep track of what protocol is enabled.
 // Best is to make this dynamic and not compile time. However,only the Arduino Mega has enough memory
 // to run all codecs with all their declarations without problems.
@@ -111,6 +129,13 @@ unsigned long codecs;		// must be at least 32 bits for 32 positions. Use long in
   DallasTemperature sensors(&oneWire);
   int numberOfDevices; 		// Number of temperature devices found
 #endif
+// Values of ReportFilter, the Dallas devices follow V_DALLAS
+#define V_HTU21D_T 0
+#define V_HTU21D_H 1
+#define V_BMP085_T 2
+#define V_BMP085_P 3
+#define V_BH1750 4
+#define V_DALLAS 5
 #if S_HTU21D==1
   HTU21D myHumidity;		// Init Sensor(s)
 #endif
@@ -132,8 +157,8 @@ void setup() {
 	codecs = 0;
 
 #if A_MEGA==1
-	Serial.println(F("! Mega Gateway"));
-	Serial.print(F("! debug: ")); Serial.println(debug);
+	Host.println(F("! Mega Gateway"));
+	Host.print(F("! debug: ")); Host.println(debug);
 #endif
 
   // Create a transmitter using digital pin S_TRANSMITTER (default is 8) to transmit,
@@ -151,6 +176,8 @@ void setup() {
   
 	// Initialize receiver on interrupt 0 (= digital pin 2), calls the callback (for example "showKakuCode")
 	// after 2 identical codes have been received in a row. (thus, keep the button pressed for a moment)
+	// A button that is kept pressed is reported once, repeats are dropped by DupCache.
+	DupCache::init();
 
 	KakuReceiver::init(-1, 2, showKakuCode);
 	RemoteReceiver::init(-1, 2, showRemoteCode);
@@ -169,50 +196,55 @@ void setup() {
 #if S_AURIOL==1
 	auriolReceiver::init(-1, 2, showAuriolCode);
 #endif
+#if R_OOK==1
+	OokReceiver::init(showOokCode);
+	OokReceiver::loadTable(ookTable, OOK_TABLE_SIZE);
+#endif
+#if A_AGGREGATE==1
+	SensorAggregator::init(showAggregate, S_WINDOW);
+#endif
 
-  // Change interrupt mode to CHANGE (on flanks). First argument is interrupt number
-  InterruptChain::setMode(0, CHANGE);
+  // Attach the decoder chain to interrupt 0 (= digital pin 2). Interrupt mode is CHANGE (on flanks).
+  // The chain timestamps every edge only once and passes the pulse to all decoders.
+  DecoderChain::init(0, A_DEFERRED);
+  PulseTransmitter::init(A_TXTIMER);
   
-  // Define the interrupt chain
+  // Define the decoder chain
   // The sequence might be relevant, defines the order of execution, put easy protocols first
   // onCodec: First 16 bits are for sensors (+16), last 16 bits for devices,
-  // By removing a line below, that type of device will not be scanned anymore :-)
+  // A decoder with flag 0 below is not compiled in, and not scanned anymore :-)
   //
-
-#if S_AURIOL==1
-	InterruptChain::addInterruptCallback(0, auriolReceiver::interruptHandler);	onCodec(AURIOL);
-#endif
-	InterruptChain::addInterruptCallback(0, RemoteReceiver::interruptHandler);	onCodec(ACTION);
-	InterruptChain::addInterruptCallback(0, KakuReceiver::interruptHandler);	onCodec(KAKU);
-	InterruptChain::addInterruptCallback(0, livoloReceiver::interruptHandler);	onCodec(LIVOLO);
-#if R_KOPOU==1
-	InterruptChain::addInterruptCallback(0, kopouReceiver::interruptHandler);	onCodec(KOPOU);
-#endif
-#if R_QUHWA==1
-	InterruptChain::addInterruptCallback(0, quhwaReceiver::interruptHandler);	onCodec(QUHWA);
-#endif
-#if S_WT440==1
-	InterruptChain::addInterruptCallback(0, wt440Receiver::interruptHandler);	onCodec(WT440);
-#endif
-
-	time = millis();
+	typedef DecoderSet<
+		Decoder<AURIOL, auriolReceiver::handlePulse, S_AURIOL>,
+		Decoder<ACTION, RemoteReceiver::handlePulse, R_ACTION>,
+		Decoder<KAKU, KakuReceiver::handlePulse, R_KAKU>,
+		Decoder<LIVOLO, livoloReceiver::handlePulse, R_LIVOLO>,
+		Decoder<KOPOU, kopouReceiver::handlePulse, R_KOPOU>,
+		Decoder<QUHWA, quhwaReceiver::handlePulse, R_QUHWA>,
+		Decoder<WT440, wt440Receiver::handlePulse, S_WT440>,
+		Decoder<OOK, OokReceiver::handlePulse, R_OOK>
+	> Receivers;
+	Receivers::attach();
+	DecoderStatistics ds;
+	for (byte i = 0; DecoderChain::getStatistics(i, ds); i++) onCodec(ds.codec);
 
 #if S_DALLAS==1
-	sensors.begin();
+	sensors.begin();							// Searches the bus once, the addresses are kept
+	sensors.setWaitForConversion(false);		// dallasTask() polls, so we keep decoding
 	onCodec(ONBOARD);
 	numberOfDevices = sensors.getDeviceCount();
-	Serial.print("! #Dallas: "); Serial.println(numberOfDevices);
+	Host.print("! #Dallas: "); Host.println(numberOfDevices);
 #endif
 #if S_HTU21D==1
 	myHumidity.begin(); 
 	myHumidity.setResolution(0);
 	onCodec(ONBOARD);
-	if (myHumidity.readHumidity() == 998) Serial.println(F("! No HTU21D")); // First read value after starting does not make sense.  
+	if (myHumidity.readHumidity() == 998) Host.println(F("! No HTU21D")); // First read value after starting does not make sense.  
 #endif
 #if S_BMP085==1
 	bmp085.begin(); 
 	onCodec(ONBOARD);
-	if (bmp085.Calibration() == 998) Serial.println(F("! No BMP085"));	// OnBoard
+	if (bmp085.Calibration() == 998) Host.println(F("! No BMP085"));	// OnBoard
 #endif
 #if S_BH1750==1
 	LightSensor.begin();
@@ -220,31 +252,75 @@ void setup() {
 	LightSensor.SetAddress(Device_Address_H);							//Address 0x23 or 0x5C
 	LightSensor.SetMode(Continuous_H_resolution_Mode2);
 	if (LightSensor.GetLightIntensity() == (int) -1) {
-		Serial.println(F("! No BH1750"));
+		Host.println(F("! No BH1750"));
 	};
 #endif
+
+	// The sensors are read every S_INTERVAL seconds by SensorSweep, and a value is only reported
+	// when it changed at least its deadband, see ReportFilter.h. Admin commands 7 and 8 change this.
+#if S_DALLAS==1
+	SensorSweep::add(dallasTask, S_INTERVAL);
+	for (byte i = V_DALLAS; i < REPORT_VALUES; i++) ReportFilter::setup(i, 0.2, S_HEARTBEAT);
+#endif
+#if S_HTU21D==1
+	SensorSweep::add(htu21dTask, S_INTERVAL);
+	ReportFilter::setup(V_HTU21D_T, 0.2, S_HEARTBEAT);		// Celsius
+	ReportFilter::setup(V_HTU21D_H, 1.0, S_HEARTBEAT);		// Percent
+#endif
+#if S_BMP085==1
+	SensorSweep::add(bmp085Task, S_INTERVAL);
+	ReportFilter::setup(V_BMP085_T, 2, S_HEARTBEAT);		// Tenths of a degree
+	ReportFilter::setup(V_BMP085_P, 50, S_HEARTBEAT);		// Pa
+#endif
+#if S_BH1750==1
+	SensorSweep::add(bh1750Task, S_INTERVAL);
+	ReportFilter::setup(V_BH1750, 10, S_HEARTBEAT);			// Lux
+#endif
 #if A_MEGA==1
 	printCodecs();
 	if (debug==1) {
-		Serial.print(F("Pin 2 is interrupt: "));
-		Serial.println(digitalPinToInterrupt(2));
+		Host.print(F("Pin 2 is interrupt: "));
+		Host.println(digitalPinToInterrupt(2));
 	}
 #endif
+	Host.setQueue(true);						// From now on the callbacks only queue
 }
 
 // --------------------------------------------------------------------------------
 //
 void loop() {
   char * pch;
-  // Must make sure digital transmitter pin is low when not used
-  digitalWrite(S_TRANSMITTER, LOW);
+  if (PulseTransmitter::busy()) {
+    DecoderChain::disable();					// Do not decode our own message
+  }
+  else {
+    // Must make sure digital transmitter pin is low when not used
+    digitalWrite(S_TRANSMITTER, LOW);
+    DecoderChain::enable();
+  }
+
+#if A_DEFERRED==1
+  DecoderChain::process();						// Decode the received pulses, calls the callbacks
+#endif
   
   while (Serial.available()) {
-    InterruptChain::disable(0);					// Set interrupts off  
+    DecoderChain::disable();					// Set interrupts off  
 	readChar = Serial.read();					// Read the requested byte from serial
+#if A_BINARY==1
+	if (Host.isBinary()) {
+	  if (Host.receive(readChar, readLine, sizeof(readLine))) {
+		Host.setQueue(false);					// Answer at once, the decoders are off
+		parseCmd(readLine);
+		Host.setQueue(true);
+	  }
+	}
+	else
+#endif
 	if (readChar == '\n') {						// If there is a newLine in the input
 	  readLine[readCnt]='\0';	  				// Overwrite the \n char, close the string
+	  Host.setQueue(false);						// Answer at once, the decoders are off
 	  parseCmd(readLine);						// ACTION: Parsing the readLine for actions
+	  Host.setQueue(true);
 	  readLine[0]='\0';
 	  readCnt=0;  
 	}
@@ -253,12 +329,35 @@ void loop() {
 	  readCnt++;
 	  readLine[readCnt]='\0';
 	}
-	InterruptChain::enable(0);					// Set interrupts on again
+	if (!PulseTransmitter::busy()) DecoderChain::enable();	// Set interrupts on again, unless sending
   }//available
 
+#if A_CAPTURE==1
+  if (PulseCapture::capturing()) {
+    captureFlush();								// Serial carries the pulse stream only
+    return;
+  }
+#endif
+
+#if A_AGGREGATE==1
+  SensorAggregator::process();					// Report the windows of the wireless sensors that passed
+#endif
+  Host.process(Serial.availableForWrite());		// Messages of the callbacks, as far as Serial has room
   readSensors();								// Better for callbacks if there are sleeps
 }
 
+#if A_CAPTURE==1
+// --------------------------------------------------------------------------------
+// Write the captured pulses to Serial, as much as fits in its buffer without waiting.
+//
+void captureFlush() {
+	byte buf[SERIAL_TX_BUFFER_SIZE];
+	int room = Serial.availableForWrite();
+	byte n = PulseCapture::read(buf, room < (int) sizeof(buf) ? room : sizeof(buf));
+	if (n > 0) Serial.write(buf, n);
+}
+#endif
+
 // ***************************** Codecs Admin *************************************
 
 //
@@ -266,46 +365,40 @@ void loop() {
 //
 void onCodec (byte codec) {
 	codecs |= ( (unsigned long) 0x0001 << codec	);		// AND
-#if A_MEGA==1
-  // We support dynamic enablement and disable of sensors and devices
-  
-#endif
+	DecoderChain::setDecoder(codec, true);			// Sensors and devices without a decoder are not in the chain
 }
 
 //
-// We really should disable interrupts for codecs that are in the interrupt chain too.
+// Switch a codec off. A receiver codec is taken out of the decoder chain, so it costs no interrupt time.
 //
 void offCodec (byte codec) {
 	codecs &= ~( (unsigned long) 0x0001 << codec );		// NAND, no effect for 0, but for 1 bit makes 0
-#if A_MEGA==1
-	// We support dynamic enablement and disable of sensors and devices
-	
-#endif
+	DecoderChain::setDecoder(codec, false);
 }
 
 void setCodec (byte codec, byte val) {
-  if (val = 0) offCodec(codec);
+  if (val == 0) offCodec(codec);
   else onCodec(codec);
 }
 
 #if A_MEGA==1
 void printCodecs() {
-	Serial.print(F("! Codecs enabled: "));
-	if ((codecs >> KAKU) & 0x0001) Serial.print(F("KAKU "));
-	if ((codecs >> ACTION) & 0x0001) Serial.print(F("ACTION "));
-	if ((codecs >> BLOKKER) & 0x0001) Serial.print(F("BLOKKER "));
-	if ((codecs >> KAKUOLD) & 0x0001) Serial.print(F("KAKOLD "));
-	if ((codecs >> ELRO) & 0x0001) Serial.print(F("ELRO "));
-	if ((codecs >> KOPOU) & 0x0001) Serial.print(F("KOPOU "));
-	if ((codecs >> LIVOLO) & 0x0001) Serial.print(F("LIVOLO "));
-	if ((codecs >> QUHWA) & 0x0001) Serial.print(F("QUWAH "));
+	Host.print(F("! Codecs enabled: "));
+	if ((codecs >> KAKU) & 0x0001) Host.print(F("KAKU "));
+	if ((codecs >> ACTION) & 0x0001) Host.print(F("ACTION "));
+	if ((codecs >> BLOKKER) & 0x0001) Host.print(F("BLOKKER "));
+	if ((codecs >> KAKUOLD) & 0x0001) Host.print(F("KAKOLD "));
+	if ((codecs >> ELRO) & 0x0001) Host.print(F("ELRO "));
+	if ((codecs >> KOPOU) & 0x0001) Host.print(F("KOPOU "));
+	if ((codecs >> LIVOLO) & 0x0001) Host.print(F("LIVOLO "));
+	if ((codecs >> QUHWA) & 0x0001) Host.print(F("QUWAH "));
 	
-	if ((codecs >> ONBOARD) & 0x0001) Serial.print(F("ONBOARD "));
-	if ((codecs >> WT440) & 0x0001) Serial.print(F("WT440 "));
-	if ((codecs >> OREGON) & 0x0001) Serial.print(F("OREGON "));
-	if ((codecs >> AURIOL) & 0x0001) Serial.print(F("AURIOL "));
-	if ((codecs >> CRESTA) & 0x0001) Serial.print(F("CRESTA "));
-	Serial.println();
+	if ((codecs >> ONBOARD) & 0x0001) Host.print(F("ONBOARD "));
+	if ((codecs >> WT440) & 0x0001) Host.print(F("WT440 "));
+	if ((codecs >> OREGON) & 0x0001) Host.print(F("OREGON "));
+	if ((codecs >> AURIOL) & 0x0001) Host.print(F("AURIOL "));
+	if ((codecs >> CRESTA) & 0x0001) Host.print(F("CRESTA "));
+	Host.println();
 }
 #endif
 
@@ -313,110 +406,199 @@ void printCodecs() {
 
 
 // --------------------------------------------------------------------------------
-// 
-void readSensors() {
-	if ((millis() - time) > 63000) {				// 63 seconds, so avoiding collisions with other cron jobs
-		time = millis();
-#if S_DALLAS
-		uint8_t ind;
-		DeviceAddress tempDeviceAddress; 			// We'll use this variable to store a found device address
-		sensors.requestTemperatures();
-		for(int i=0; i<numberOfDevices; i++)
+// Sensor tasks, run by SensorSweep every S_INTERVAL seconds. Step 0 starts a conversion,
+// the next steps collect it. Return the ms until the next step, or SWEEP_DONE.
+// A value is only printed when ReportFilter says it changed enough, or for the heartbeat.
+//
+#if S_DALLAS==1
+// The addresses come from the table made by sensors.begin(), not from the bus.
+unsigned int dallasTask(byte step) {
+	if (step == 0) {
+		sensors.requestTemperatures();				// Returns at once, the conversion takes up to 750 ms
+		return sensors.millisToWaitForConversion();
+	}
+	if (!sensors.isConversionComplete()) {
+		return 10;
+	}
+	uint8_t ind;
+	DeviceAddress tempDeviceAddress; 			// We'll use this variable to store a found device address
+	for(int i=0; i<numberOfDevices; i++)
+	{
+		// Address found by sensors.begin(), no bus search
+		if(sensors.getAddress(tempDeviceAddress, i))
 		{
-			// Search the wire for address
-			if(sensors.getAddress(tempDeviceAddress, i))
-			{
-					
-				Serial.print(F("< "));
-				Serial.print(msgCnt++);
-				Serial.print(F(" 3 0 "));				// Internal Sensor
-				
-				// Address bus is tempDeviceAddress, channel 0
-				// For LamPI, print in different format compatible with WiringPI
-				for (uint8_t j= 0; j < 7; j++)			// Skip int[7], this is CRC
-				{
-					if (j<1) ind=j; else ind=7-j;
-					if (j==1) Serial.print("-");
-					if (tempDeviceAddress[ind] < 16) Serial.print("0");
-					Serial.print(tempDeviceAddress[ind], HEX);
-				}
-				Serial.print (F(" 0 "));				// Channel
-				// It responds almost immediately. Let's print out the data
-				float tempC = sensors.getTempC(tempDeviceAddress);
-				Serial.print(tempC,1);
-				Serial.print(F(" 0"));					// No Humidity, make 0
-				
-				// Output the device ID
-				if (debug) {
-					Serial.print(" ! ds18b20 dev ");
-					Serial.print(i, DEC);
-				}
-				Serial.println();
-			} 
-			//else ghost device! Check your power requirements and cabling
-		}
+			float tempC = sensors.getTempC(tempDeviceAddress);
+			if (!ReportFilter::changed(V_DALLAS + i, tempC)) continue;
+#if A_BINARY==1
+			if (Host.isBinary()) {
+				Host.sendDallas(tempDeviceAddress, tenths(tempC));
+				msgCnt++;
+				continue;
+			}
 #endif
 
-#if S_HTU21D==1
-		// HTU21 or SHT21
-		//delay(50);
-		float humd = myHumidity.readHumidity();
-		float temp = myHumidity.readTemperature();
-		if (((int)humd != 999) && ((int)humd != 998 )) {	// Timeout (no sensor) or CRC error
-			Serial.print(F("< "));
-			Serial.print(msgCnt);
-			Serial.print(F(" 3 0 40 0 "));		// Address bus 40, channel 0
-			Serial.print(temp,1);
-			Serial.print(F(" "));
-			Serial.print(humd,1);
+			Host.print(F("< "));
+			Host.print(msgCnt++);
+			Host.print(F(" 3 0 "));				// Internal Sensor
+			
+			// Address bus is tempDeviceAddress, channel 0
+			// For LamPI, print in different format compatible with WiringPI
+			for (uint8_t j= 0; j < 7; j++)			// Skip int[7], this is CRC
+			{
+				if (j<1) ind=j; else ind=7-j;
+				if (j==1) Host.print("-");
+				if (tempDeviceAddress[ind] < 16) Host.print("0");
+				Host.print(tempDeviceAddress[ind], HEX);
+			}
+			Host.print (F(" 0 "));				// Channel
+			Host.printFixed(tenths(tempC), 1);
+			Host.print(F(" 0"));					// No Humidity, make 0
+			
+			// Output the device ID
 			if (debug) {
-				Serial.print(F(" ! HTU21 T: "));
-				Serial.print(temp/10);
+				Host.print(" ! ds18b20 dev ");
+				Host.print(i, DEC);
 			}
-			Serial.println();
-			msgCnt++;
-		}
-		else if (debug>=1) Serial.println(F(" ! No HTU21"));
-#endif
-#if S_BMP085==1		
-		// BMP085 or BMP180
-		short temperature = bmp085.GetTemperature();
-		if ((temperature != 998) && (temperature != 0)){
-			long pressure = bmp085.GetPressure();
-			float altitude = (float)44330 * (1 - pow(((float) pressure/bmp085.p0), 0.190295));
-			Serial.print(F("< "));
-			Serial.print(msgCnt);
-			Serial.print(F(" 3 0 77 0 "));					// Address bus 77, channel 0
-			Serial.print(temperature, DEC);
-			Serial.print(F(" "));
-			Serial.print(pressure, DEC);
-			Serial.print(F(" "));
-			Serial.print(altitude, 2);
-			if (debug>=1) {
-				Serial.print(F(" ! bmp: t: "));
-				Serial.print((float)(temperature/10), 1);
+			Host.println();
+		} 
+		//else ghost device! Check your power requirements and cabling
+	}
+	return SWEEP_DONE;
+}
+#endif
+
+#if S_HTU21D==1
+unsigned int htu21dTask(byte step) {
+	static float humd;
+	switch (step) {
+		case 0:
+			myHumidity.startHumidity();
+			return HTU21D_HUMD_DELAY;
+		case 1:
+			humd = myHumidity.collectHumidity();
+			if (((int)humd == 999) || ((int)humd == 998 )) {	// Timeout (no sensor) or CRC error
+				if (debug>=1) Host.println(F(" ! No HTU21"));
+				return SWEEP_DONE;
 			}
-			Serial.println();
-			msgCnt++;
-		}
+			myHumidity.startTemperature();
+			return HTU21D_TEMP_DELAY;
+	}
+	// HTU21 or SHT21
+	float temp = myHumidity.collectTemperature();
+	boolean changed = ReportFilter::changed(V_HTU21D_T, temp);
+	if (ReportFilter::changed(V_HTU21D_H, humd)) changed = true;
+	if (!changed) return SWEEP_DONE;
+	ReportFilter::sent(V_HTU21D_T, temp);			// Both go in one message
+	ReportFilter::sent(V_HTU21D_H, humd);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendSensor(ONBOARD, 0, 0x40, 0, tenths(temp), tenths(humd), 1);
+		msgCnt++;
+		return SWEEP_DONE;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 3 0 40 0 "));		// Address bus 40, channel 0
+	Host.printFixed(tenths(temp), 1);
+	Host.print(F(" "));
+	Host.printFixed(tenths(humd), 1);
+	if (debug) {
+		Host.print(F(" ! HTU21 T: "));
+		Host.printFixed(tenths(temp), 2);			// temp / 10
+	}
+	Host.println();
+	msgCnt++;
+	return SWEEP_DONE;
+}
+#endif
+
+#if S_BMP085==1
+unsigned int bmp085Task(byte step) {
+	static short temperature;
+	switch (step) {
+		case 0:
+			bmp085.StartTemperature();
+			return BMP085_UT_DELAY;
+		case 1:
+			temperature = bmp085.CollectTemperature();
+			if ((temperature == 998) || (temperature == 0)) return SWEEP_DONE;
+			bmp085.StartPressure();
+			return BMP085_UP_DELAY;
+	}
+	// BMP085 or BMP180
+	long pressure = bmp085.CollectPressure();
+	boolean changed = ReportFilter::changed(V_BMP085_T, temperature);
+	if (ReportFilter::changed(V_BMP085_P, pressure)) changed = true;
+	if (!changed) return SWEEP_DONE;
+	ReportFilter::sent(V_BMP085_T, temperature);	// Both go in one message
+	ReportFilter::sent(V_BMP085_P, pressure);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendSensor(ONBOARD, 0, 0x77, 0, temperature, pressure, 0);	// Tenths of a degree, Pa
+		msgCnt++;
+		return SWEEP_DONE;
+	}
+#endif
+	float altitude = (float)44330 * (1 - pow(((float) pressure/bmp085.p0), 0.190295));
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 3 0 77 0 "));					// Address bus 77, channel 0
+	Host.print(temperature, DEC);
+	Host.print(F(" "));
+	Host.print(pressure, DEC);
+	Host.print(F(" "));
+	Host.printFixed((long)(altitude * 100), 2);
+	if (debug>=1) {
+		Host.print(F(" ! bmp: t: "));
+		Host.printFixed(temperature, 1);
+	}
+	Host.println();
+	msgCnt++;
+	return SWEEP_DONE;
+}
 #endif
+
 #if S_BH1750==1
-		uint16_t lux = LightSensor.GetLightIntensity();		// Get Lux value
-		if (lux != (int) -1) {
-			Serial.print(F("< "));
-			Serial.print(msgCnt);
-			Serial.print(F(" 3 0 23 0 "));						// Address 23 or 5C
-			Serial.print(lux);
-			if (debug>=1) {
-				Serial.print(F(" ! Lumi: "));
-				Serial.print(lux);
-				Serial.print(F(" lux"));
-			}
-			Serial.println();
+// Measures continuously, so there is nothing to wait for
+unsigned int bh1750Task(byte step) {
+	uint16_t lux = LightSensor.GetLightIntensity();		// Get Lux value
+	if (lux != (int) -1 && ReportFilter::changed(V_BH1750, lux)) {
+#if A_BINARY==1
+		if (Host.isBinary()) {
+			Host.sendSensor(ONBOARD, 0, 0x23, 0, lux, 0, 0);
 			msgCnt++;
+			return SWEEP_DONE;
 		}
 #endif
+		Host.print(F("< "));
+		Host.print(msgCnt);
+		Host.print(F(" 3 0 23 0 "));						// Address 23 or 5C
+		Host.print(lux);
+		if (debug>=1) {
+			Host.print(F(" ! Lumi: "));
+			Host.print(lux);
+			Host.print(F(" lux"));
+		}
+		Host.println();
+		msgCnt++;
 	}
+	return SWEEP_DONE;
+}
+#endif
+
+// --------------------------------------------------------------------------------
+// A float of a sensor in tenths, rounded, for Host.printFixed()
+//
+long tenths(float value) {
+	return (long)(value * 10 + (value < 0 ? -0.5 : 0.5));
+}
+
+// --------------------------------------------------------------------------------
+// Runs the sensor tasks that are due, see SensorSweep.h. Never waits.
+//
+void readSensors() {
+	SensorSweep::process();
 }
 
 
@@ -434,14 +616,17 @@ void parseCmd(char *readLine)
   char *pch;								// Pointer to character position
 	
   if (readLine[0] != '>') {
-	Serial.println(F("! ERR: cmd \">\" "));
+	Host.println(F("! ERR: cmd \">\" "));
 	return;
   } else { 
-	Serial.println(readLine);
+#if A_CAPTURE==1
+	if (!PulseCapture::capturing())			// Do not break the pulse stream
+#endif
+	Host.println(readLine);
 	pch = readLine+1;
   }
   if (strlen(readLine) <= 3) {
-	Serial.println(F("! ERR: syntax"));
+	Host.println(F("! ERR: syntax"));
 	return;
   }
   pch = strtok(pch, " ,."); cnt = atoi(pch);
@@ -453,20 +638,77 @@ void parseCmd(char *readLine)
 	  pch = strtok (NULL, " ,."); adm = atoi(pch);
 	  switch (adm) {
 		case 0:	// List device Codecs
-			Serial.print(F("< "));
-			Serial.print(msgCnt);
-			Serial.print(F(" 0 0 "));
-			Serial.println(codecs,BIN);
+#if			A_BINARY==1
+			if (Host.isBinary()) { Host.sendAdmin(0, codecs); msgCnt++; break; }
+#endif
+			Host.print(F("< "));
+			Host.print(msgCnt);
+			Host.print(F(" 0 0 "));
+			Host.println(codecs,BIN);
 			msgCnt++;
 		break;
 		case 1:	// List codec value for ONE sensor only
 			pch = strtok (NULL, " ,."); codec = atoi(pch);
 			pch = strtok (NULL, " ,."); val = atoi(pch);
 			if (val == 1) onCodec(codec); else offCodec(codec);
-			Serial.print("! set Cod = "); Serial.println(codecs,BIN);
+			Host.print("! set Cod = "); Host.println(codecs,BIN);
 		break;
 		case 2:	// Ask for statistics
-			Serial.print("! Stat = "); Serial.println("");
+			Host.print("! Stat = "); Host.println("");
+#if			A_DEFERRED==1
+			Host.print(F("! Pulse buffer: high "));
+			Host.print(DecoderChain::getHighWater());
+			Host.print(F(" of ")); Host.print(PULSE_BUFSIZE);
+			Host.print(F(", overflows ")); Host.println(DecoderChain::getOverflows());
+#endif
+			Host.print(F("! Output: dropped ")); Host.print(Host.getDropped());
+			Host.print(F(", high ")); Host.print(Host.getHighWater());
+			Host.print(F(" of ")); Host.print(LINK_LINES); Host.println(F(" lines"));
+			Host.resetStatistics();
+			{
+			  DecoderProfile dp;
+			  DecoderStatistics ds;
+			  DecoderChain::getProfile(dp);
+			  Host.print(F("! Edges ")); Host.print(dp.edges);
+			  Host.print(F(", per s ")); Host.print(dp.elapsed >= 1000 ? dp.edges / (dp.elapsed / 1000) : 0);	// edges * 1000 would overflow
+			  Host.print(F(", isr us min ")); Host.print(dp.isrMin);
+			  Host.print(F(" avg ")); Host.print(dp.isrAvg);
+			  Host.print(F(" max ")); Host.print(dp.isrMax);
+			  Host.print(F(", off ms max ")); Host.print(dp.maxDisabled);
+			  Host.print(F(", squelched ")); Host.println(dp.squelched);
+			  for (byte i = 0; DecoderChain::getStatistics(i, ds); i++) {
+				Host.print(F("! Codec ")); Host.print(ds.codec);
+				Host.print(F(": ok ")); Host.print(ds.decoded);
+				Host.print(F(", rej ")); Host.print(ds.rejected);
+				Host.print(F(", dup ")); Host.print(ds.duplicates);
+				Host.print(F(", sup ")); Host.print(ds.suppressed);
+#if DECODER_PROFILE > 1
+				Host.print(F(", us avg ")); Host.print(ds.calls > 0 ? ds.micros / ds.calls : 0);
+				Host.print(F(" max ")); Host.print(ds.maxMicros);
+				Host.print(F(" sum ")); Host.print(ds.micros);
+#endif
+				Host.println();
+			  }
+			  DecoderChain::resetStatistics();
+			}
+			{
+			  KakuStatistics ks;
+			  KakuEstimate ke;
+			  KakuReceiver::getStatistics(ks);
+			  Host.print(F("! Kaku: ok ")); Host.print(ks.accepted);
+			  Host.print(F(", glitch ")); Host.print(ks.glitches);
+			  Host.print(F(", start ")); Host.print(ks.startBit);
+			  Host.print(F(", timing ")); Host.print(ks.timing);
+			  Host.print(F(", bit ")); Host.print(ks.invalidBit);
+			  Host.print(F(", narrowed ")); Host.println(ks.narrowed);
+			  for (byte i = 0; KakuReceiver::getEstimate(i, ke); i++) {
+				Host.print(F("! Kaku ")); Host.print(ke.address);
+				Host.print(F(": T ")); Host.print(ke.period);
+				Host.print(F(", sd ")); Host.print(ke.jitter);
+				Host.print(F(", frames ")); Host.println(ke.frames);
+			  }
+			  KakuReceiver::resetStatistics();
+			}
 #if			MEGA==1
 			
 #endif
@@ -474,22 +716,130 @@ void parseCmd(char *readLine)
 		case 3:	// Debug level
 			pch = strtok (NULL, " ,."); debug = atoi(pch);
 			if (debug >= 1) { debug = 1; } else { debug = 0; }
+#if			A_BINARY==1
+			if (Host.isBinary()) { Host.sendAdmin(3, debug); msgCnt++; break; }
+#endif
 			
-			Serial.print(F("< "));
-			Serial.print(msgCnt);
-			Serial.print(F(" 0 3 "));
-			Serial.print(debug);
+			Host.print(F("< "));
+			Host.print(msgCnt);
+			Host.print(F(" 0 3 "));
+			Host.print(debug);
 			if (debug) {
-				Serial.print(F(" ! Debug ON"));
+				Host.print(F(" ! Debug ON"));
 			}
-			Serial.println("");
+			Host.println("");
 			msgCnt++;
 		break;
 		case 4:
-			Serial.println(F(VERSION));
+			Host.println(F(VERSION));
+			ReportFilter::force();			// The daemon asks at its start, send it every sensor value
+		break;
+#if		A_CAPTURE==1
+		case 5:	// Raw capture on (1) or off (0)
+			pch = strtok (NULL, " ,."); val = atoi(pch);
+#if			A_BINARY==1
+			if (val == 1 && Host.isBinary()) {
+				Host.println(F("! ERR: capture needs text mode"));
+				break;
+			}
+#endif
+			if (val == 1) {
+				Host.println(F("! Capture on"));
+				Serial.flush();
+				PulseCapture::start();
+			}
+			else if (PulseCapture::capturing()) {
+				byte buf[16];
+				byte n;
+				PulseCapture::stop();
+				while ((n = PulseCapture::read(buf, sizeof(buf))) > 0) {
+					Serial.write(buf, n);			// The stream ends here, so waiting is fine
+				}
+				Host.println("");
+				Host.print(F("! Capture off, lost ")); Host.println(PulseCapture::getLost());
+			}
+		break;
+#endif
+#if		S_DALLAS==1
+		case 6:	// Search the Dallas bus again, after adding or removing a device
+			sensors.begin();
+			numberOfDevices = sensors.getDeviceCount();
+			Host.print(F("! #Dallas: ")); Host.println(numberOfDevices);
+		break;
+#endif
+		case 7:	// Seconds between two readings of sensor task n, "> n 0 7 task seconds", 0 to stop
+			pch = strtok (NULL, " ,."); val = atoi(pch);
+			pch = strtok (NULL, " ,.");
+			if (pch != NULL) SensorSweep::setInterval(val, atoi(pch));
+			for (byte i = 0; i < SensorSweep::count(); i++) {
+				Host.print(F("! Task ")); Host.print(i);
+				Host.print(F(": every ")); Host.print(SensorSweep::getInterval(i));
+				Host.println(F(" s"));
+			}
+			Host.print(F("! Last sweep ms ")); Host.println(SensorSweep::getDuration());
+		break;
+		case 8:	// Report value n on a change of tenths, or after seconds, "> n 0 8 value tenths seconds"
+			pch = strtok (NULL, " ,."); val = atoi(pch);
+			pch = strtok (NULL, " ,.");
+			if (pch != NULL) {
+				float deadband = atoi(pch) / 10.0;
+				pch = strtok (NULL, " ,.");
+				ReportFilter::setup(val, deadband, pch != NULL ? atoi(pch) : S_HEARTBEAT);
+			}
+			{
+			  float deadband;
+			  unsigned int heartbeat;
+			  for (byte i = 0; ReportFilter::getSetup(i, deadband, heartbeat); i++) {
+				Host.print(F("! Value ")); Host.print(i);
+				Host.print(F(": deadband ")); Host.printFixed(tenths(deadband), 1);
+				Host.print(F(", heartbeat ")); Host.print(heartbeat);
+				Host.println(F(" s"));
+			  }
+			  Host.print(F("! Sent ")); Host.print(ReportFilter::getSent());
+			  Host.print(F(", held ")); Host.println(ReportFilter::getHeld());
+			  ReportFilter::resetStatistics();
+			}
+		break;
+#if		A_AGGREGATE==1
+		case 9:	// Table of the wireless sensors, "> n 0 9 seconds" also sets the window, 0 to not aggregate
+			pch = strtok (NULL, " ,.");
+			if (pch != NULL) SensorAggregator::setWindow(atoi(pch));
+			{
+			  SensorAggregate sa;
+			  Host.print(F("! Window ")); Host.print(SensorAggregator::getWindow());
+			  Host.print(F(" s, frames ")); Host.print(SensorAggregator::getFrames());
+			  Host.print(F(", reports ")); Host.println(SensorAggregator::getReports());
+			  for (byte i = 0; SensorAggregator::get(i, sa); i++) {
+				Host.print(F("! Codec ")); Host.print(sa.codec);
+				Host.print(F(" ")); Host.print(sa.address);
+				Host.print(F(" ")); Host.print(sa.channel);
+				Host.print(F(" ")); Host.print(sa.type);
+				for (byte j = 0; j < AGGREGATE_VALUES; j++) {
+					Host.print(F(": last ")); Host.print(sa.last[j]);
+					Host.print(F(" min ")); Host.print(sa.min[j]);
+					Host.print(F(" max ")); Host.print(sa.max[j]);
+					Host.print(F(" mean ")); Host.print(SensorAggregator::mean(sa, j));
+				}
+				Host.print(F(", frames ")); Host.print(sa.count);
+				Host.print(F(", age s ")); Host.println((millis() - sa.time) / 1000);
+			  }
+			  SensorAggregator::resetStatistics();
+			}
+		break;
+#endif
+#if		A_BINARY==1
+		case 10:	// Binary frames (1) or text lines (0) to and from the daemon, see HostLink.h
+			pch = strtok (NULL, " ,."); val = atoi(pch);
+			Host.print(F("< "));				// The last message in the old format
+			Host.print(msgCnt);
+			Host.print(F(" 0 10 "));
+			Host.println(val == 1 ? 1 : 0);
+			msgCnt++;
+			Host.setBinary(val == 1);
 		break;
+#endif
 		default:
-			Serial.println(F("! ERR admin cmd"));
+			Host.println(F("! ERR admin cmd"));
 	  }
 	break;
 	case 1:								// transmit a key value from the Arduino
@@ -502,7 +852,7 @@ void parseCmd(char *readLine)
 				parseAction(pch);
 			break;
 			case BLOKKER:				// 2
-				Serial.println(F("! ERR: Blokker"));
+				Host.println(F("! ERR: Blokker"));
 			break;
 			case LIVOLO:				// 5
 				parseLivolo(pch);
@@ -513,21 +863,38 @@ void parseCmd(char *readLine)
 			break;
 #endif
 			default:
-				Serial.println(F("! ERR: Codec"));
+				Host.println(F("! ERR: Codec"));
 				return;
 		}
 		msgCnt++;
 	break;
 	case 2:								// 
-		Serial.print(F("! cmd 2 not found "));
+		Host.print(F("! cmd 2 not found "));
 	break;
 	default:
-		Serial.print(F("! Unknown command "));
-		Serial.println(cmd);
+		Host.print(F("! Unknown command "));
+		Host.println(cmd);
   }
   msgCnt++;
 }
 
+// --------------------------------------------------------------------------------
+// Find the compiled 433MHz frame of command value for device (codec, group, unit).
+// Returns true if frame points to a frame compiled before, false if the caller must
+// compile the frame into it.
+//
+#define KAKU_ON 16				// Command value of Kaku "on", 0 is off and 1-15 the dim levels
+
+boolean getFrame(byte codec, unsigned long group, byte unit, int value, PulseFrame *&frame) {
+#if A_TXCACHE==1
+	return FrameCache::get(codec, group, unit, value, frame);
+#else
+	static PulseFrame buffer;
+	frame = &buffer;
+	return false;
+#endif
+}
+
 // --------------------------------------------------------------------------------
 // Do parsing of Kaku specific command
 // print back to caller the received code
@@ -541,27 +908,26 @@ void parseKaku(char *pch)
   int group;
   int unit;
   int level;
-  KakuTransmitter transmitter(8, 260, 3);
   pch = strtok (NULL, " ,."); group = atoi(pch);
   pch = strtok (NULL, " ,."); unit = atoi(pch);  
   pch = strtok (NULL, " ,."); level = atoi(pch);
 
   if (pch[0] == 'o') { // pch == 'on' as sent by PI-arduino
-	if (pch[1] == 'n') {
-		transmitter.sendUnit(group, unit, true);				// "on"
-	}
-	else transmitter.sendUnit(group, unit, false);				// "off" (must be probably)
+	if (pch[1] == 'n') level = KAKU_ON;						// "on"
+	else level = 0;											// "off" (must be probably)
   }
-  else if (level == 0) {										// value 0 is off for dim and switch
-    transmitter.sendUnit(group, unit, false);
-  } 
-  else if (level >= 1 && level <= 15) {
-    transmitter.sendDim(group, unit, level);					// 1 - 15
-  } 
-  else {
-    Serial.println(F("! ERROR dim not between 0 and 15!"));
+  else if (level < 0 || level > 15) {						// value 0 is off for dim and switch
+    Host.println(F("! ERROR dim not between 0 and 15!"));
+	return;
   }
-  Serial.print(F(" ! Kaku send: ")); Serial.println(pch);
+  PulseFrame *frame;
+  if (!getFrame(KAKU, group, unit, level, frame)) {
+	KakuTransmitter transmitter(8, 260, 3);
+	if (level == KAKU_ON || level == 0) transmitter.frameUnit(*frame, group, unit, level == KAKU_ON);
+	else transmitter.frameDim(*frame, group, unit, level);	// 1 - 15
+  }
+  PulseTransmitter::transmit(*frame);
+  Host.print(F(" ! Kaku send: ")); Host.println(pch);
 }
 
 
@@ -580,14 +946,18 @@ void parseAction(char *pch)
 	pch = strtok (NULL, " ,."); if (atoi(pch) == 1) lvl = true;
 
 	if (debug >= 1) {
-		Serial.print(F(" ! Action Xmt G:"));
-		Serial.print(group);
-		Serial.print(F(", U:"));
-		Serial.print(unit);
-		Serial.print(F(", L:"));
-		Serial.println(lvl);
-	}
-	atransmitter.sendSignal(group, unit, lvl);
+		Host.print(F(" ! Action Xmt G:"));
+		Host.print(group);
+		Host.print(F(", U:"));
+		Host.print(unit);
+		Host.print(F(", L:"));
+		Host.println(lvl);
+	}
+	PulseFrame *frame;
+	if (!getFrame(ACTION, group, unit, lvl, frame)) {
+		atransmitter.frameSignal(*frame, group, unit, lvl);
+	}
+	PulseTransmitter::transmit(*frame);
 }
 
 // --------------------------------------------------------------------------------
@@ -605,10 +975,14 @@ void parseLivolo(char *pch)
 	pch = strtok (NULL, " ,."); group = atoi(pch);
 	pch = strtok (NULL, " ,."); unit = atoi(pch);  
 	pch = strtok (NULL, " ,."); level = atoi(pch);
-	Serial.print(F("! Livolo:: G: ")); Serial.print(group);
-	Serial.print(F(", U: ")); Serial.print(unit);
-	Serial.print(F(", L: ")); Serial.println(level);
-	livolo.sendButton(group, unit);
+	Host.print(F("! Livolo:: G: ")); Host.print(group);
+	Host.print(F(", U: ")); Host.print(unit);
+	Host.print(F(", L: ")); Host.println(level);
+	PulseFrame *frame;
+	if (!getFrame(LIVOLO, group, unit, 0, frame)) {
+		livolo.frameButton(*frame, group, unit);
+	}
+	PulseTransmitter::transmit(*frame);
 }
 
 // --------------------------------------------------------------------------------
@@ -627,93 +1001,119 @@ void parseQuhwa(char *pch)
 	pch = strtok (NULL, " ,."); group = atol(pch);
 	pch = strtok (NULL, " ,."); unit = atoi(pch);  
 	pch = strtok (NULL, " ,."); level = atoi(pch);
-	Serial.print(F("! Quhwa:: G: ")); Serial.print(group);
-	Serial.print(F(", U: ")); Serial.print(unit);
-	Serial.print(F(", L: ")); Serial.println(level);
-	quhwa.sendButton(group, unit);
+	Host.print(F("! Quhwa:: G: ")); Host.print(group);
+	Host.print(F(", U: ")); Host.print(unit);
+	Host.print(F(", L: ")); Host.println(level);
+	PulseFrame *frame;
+	if (!getFrame(QUHWA, group, unit, 0, frame)) {
+		quhwa.frameButton(*frame, group, unit);
+	}
+	PulseTransmitter::transmit(*frame);
 }
 #endif
 
 // ************************* RECEIVER STUFF BELOW *********************************
+//
+// The callbacks may interrupt loop() while it prints, so every callback keeps its output in a
+// HostMessage of its own, see HostLink.h.
 
 // --------------------------------------------------------------------------------
 // WT440
 #if S_WT440==1
-void showWt440Code(wt440Code receivedCode) {
-	
-	Serial.print(F("< "));
-	Serial.print(msgCnt);
-	switch (receivedCode.wconst) {
+// Prints the message of a WT440 frame, or of the mean of a window, without the end of line
+void printWt440(byte address, byte channel, byte wconst, int temperature, int humidity) {
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		static const byte types[8] = { 4, 0, 0, 0, 3, 0, 1, 2 };	// The message type of every wconst
+		Host.sendSensor(WT440, types[wconst & 7], address, channel, temperature, humidity, 0);
+		return;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	switch (wconst) {
 		case 0x0:
-			Serial.print(F(" 3 4 ")); 				// PIR
+			Host.print(F(" 3 4 ")); 				// PIR
 		break;
 		case 0x4:
-			Serial.print(F(" 3 3 ")); 				// Battery
+			Host.print(F(" 3 3 ")); 				// Battery
 		break;
 		case 0x6:
-			Serial.print(F(" 3 1 "));				// Normal WT440 message format with Humidity
+			Host.print(F(" 3 1 "));				// Normal WT440 message format with Humidity
 		break;
 		case 0x7:
-			Serial.print(F(" 3 2 "));				// BMP085 and BMP180 mis-use
+			Host.print(F(" 3 2 "));				// BMP085 and BMP180 mis-use
 		break;
 		//default:
 	}
-	Serial.print(receivedCode.address);				// Values from 0x0 to 0xF (4 bits)
-	Serial.print(" ");
-	Serial.print(receivedCode.channel);				// Values fro 0x0 to 0x3 (2 bits)
-	Serial.print(" ");
-	Serial.print(receivedCode.temperature);			// May be used for battery when wconst == 0x4
-	Serial.print(" ");
-	Serial.print(receivedCode.humidity);			// Can be misused as airpressure is wconst == B111 (7)
+	Host.print(address);							// Values from 0x0 to 0xF (4 bits)
+	Host.print(" ");
+	Host.print(channel);							// Values fro 0x0 to 0x3 (2 bits)
+	Host.print(" ");
+	Host.print(temperature);						// May be used for battery when wconst == 0x4
+	Host.print(" ");
+	Host.print(humidity);							// Can be misused as airpressure is wconst == B111 (7)
+}
+
+void showWt440Code(wt440Code receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_AGGREGATE==1
+	if (receivedCode.wconst != 0x0 && SensorAggregator::add(WT440, receivedCode.address,	// Not the PIR
+		receivedCode.channel, receivedCode.wconst, receivedCode.temperature, receivedCode.humidity)) return;
+#endif
+
+	printWt440(receivedCode.address, receivedCode.channel, receivedCode.wconst,
+		receivedCode.temperature, receivedCode.humidity);
 
 	if (debug >= 1) {
-		Serial.print(F(" ! WT440:: ")); 
+		Host.print(F(" ! WT440:: ")); 
 #if A_MEGA==1
 		switch (receivedCode.wconst) {
 		case 0x00:
-			Serial.print(F(" PIR DEV: ")); 				// PIR
-			Serial.print(receivedCode.address);
-			Serial.print(F(" "));
-			Serial.print(receivedCode.temperature);
+			Host.print(F(" PIR DEV: ")); 				// PIR
+			Host.print(receivedCode.address);
+			Host.print(F(" "));
+			Host.print(receivedCode.temperature);
 		break;
 		case 0x4:
-			Serial.print(F(" BATT DEV: ")); 			// Battery
-			Serial.print(receivedCode.address);
-			Serial.print(F(" "));
-			Serial.print((float)receivedCode.temperature / 10, 1);
-			Serial.print(F("%"));
+			Host.print(F(" BATT DEV: ")); 			// Battery
+			Host.print(receivedCode.address);
+			Host.print(F(" "));
+			Host.printFixed(receivedCode.temperature, 1);
+			Host.print(F("%"));
 		break;
 		case 0x6:
-			Serial.print(F(" WT440 DEV: "));			// Normal WT440 message format with Humidity
-			Serial.print(receivedCode.address);
-			Serial.print(F(" TEMP: "));	
-			Serial.print((float)(receivedCode.temperature - 6400) / 128, 1);
-			Serial.print(F(" HUM: "));
-			Serial.print(receivedCode.humidity,1);
-			Serial.print(F("%"));
+			Host.print(F(" WT440 DEV: "));			// Normal WT440 message format with Humidity
+			Host.print(receivedCode.address);
+			Host.print(F(" TEMP: "));	
+			Host.printFixed(((long)receivedCode.temperature - 6400) * 10 / 128, 1);
+			Host.print(F(" HUM: "));
+			Host.print(receivedCode.humidity,1);
+			Host.print(F("%"));
 		break;
 		case 0x7:
-			Serial.print(F(" BMP DEV: "));				// BMP085 and BMP180 mis-use
-			Serial.print(receivedCode.address);
-			Serial.print(F(" TEMP: "));
-			Serial.print((float)(receivedCode.temperature - 6400) / 128, 1);
-			Serial.print(F(" P: "));
-			Serial.print(receivedCode.humidity + 930);
+			Host.print(F(" BMP DEV: "));				// BMP085 and BMP180 mis-use
+			Host.print(receivedCode.address);
+			Host.print(F(" TEMP: "));
+			Host.printFixed(((long)receivedCode.temperature - 6400) * 10 / 128, 1);
+			Host.print(F(" P: "));
+			Host.print(receivedCode.humidity + 930);
 		break;
 		//default:
 		}
 #endif
 
 # if STATISTICS==1
-		Serial.print(F(", W: "));Serial.print(receivedCode.wconst);
-		Serial.print(F(", P: ")); Serial.print(receivedCode.par);
-		Serial.print(F(", P1: ")); Serial.print(receivedCode.min1Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max1Period);
-		Serial.print(F(", P2: ")); Serial.print(receivedCode.min2Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max2Period);
+		Host.print(F(", W: "));Host.print(receivedCode.wconst);
+		Host.print(F(", P: ")); Host.print(receivedCode.par);
+		Host.print(F(", P1: ")); Host.print(receivedCode.min1Period);
+		Host.print(F("-")); Host.print(receivedCode.max1Period);
+		Host.print(F(", P2: ")); Host.print(receivedCode.min2Period);
+		Host.print(F("-")); Host.print(receivedCode.max2Period);
 # endif
 	}
-	Serial.println("");
+	Host.println("");
 	msgCnt++;
 }
 #endif
@@ -725,31 +1125,77 @@ void showWt440Code(wt440Code receivedCode) {
 // Auriol starts at 8
 #if S_AURIOL==1
 //
+// Prints the message of an Auriol frame, or of the mean of a window, without the end of line
+void printAuriol(byte address, byte channel, int temperature, int humidity) {
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendSensor(AURIOL, 8, address, channel, temperature, humidity, 0);
+		return;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 3 8 "));
+	Host.print(address);
+	Host.print(F(" "));
+	Host.print(channel);
+	Host.print(F(" "));
+	Host.print(temperature);
+	Host.print(F(" "));
+	Host.print(humidity);
+}
+
 void showAuriolCode(auriolCode receivedCode) {
-	
-	Serial.print(F("< "));
-	Serial.print(msgCnt);
-	Serial.print(F(" 3 8 "));
-	Serial.print(receivedCode.address);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.channel);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.temperature);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.humidity);
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_AGGREGATE==1
+	if (SensorAggregator::add(AURIOL, receivedCode.address, receivedCode.channel, 0,
+		receivedCode.temperature, receivedCode.humidity)) return;
+#endif
+
+	printAuriol(receivedCode.address, receivedCode.channel, receivedCode.temperature, receivedCode.humidity);
 
 	if (debug >= 1) {
-		Serial.print(F(" ! Auriol Cs: ")); Serial.print(receivedCode.csum);
-		Serial.print(F(", N1: ")); Serial.print(receivedCode.n1,BIN);
-		Serial.print(F(", N2: ")); Serial.print(receivedCode.n2,BIN);	
+		Host.print(F(" ! Auriol Cs: ")); Host.print(receivedCode.csum);
+		Host.print(F(", N1: ")); Host.print(receivedCode.n1,BIN);
+		Host.print(F(", N2: ")); Host.print(receivedCode.n2,BIN);	
 # if STATISTICS==1
-		Serial.print(F(", 1P: ")); Serial.print(receivedCode.min1Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max1Period);
-		Serial.print(F(", 2P: ")); Serial.print(receivedCode.min2Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max2Period);
+		Host.print(F(", 1P: ")); Host.print(receivedCode.min1Period);
+		Host.print(F("-")); Host.print(receivedCode.max1Period);
+		Host.print(F(", 2P: ")); Host.print(receivedCode.min2Period);
+		Host.print(F("-")); Host.print(receivedCode.max2Period);
 # endif
 	}
-	Serial.println("");
+	Host.println("");
+	msgCnt++;
+}
+#endif
+
+#if A_AGGREGATE==1
+// --------------------------------------------------------------------------------
+// One message per sensor per window, with the mean of its frames. See SensorAggregator.h
+//
+void showAggregate(const SensorAggregate &aggregate) {
+	switch (aggregate.codec) {
+#if S_WT440==1
+		case WT440:
+			printWt440(aggregate.address, aggregate.channel, aggregate.type,
+				SensorAggregator::mean(aggregate, 0), SensorAggregator::mean(aggregate, 1));
+		break;
+#endif
+#if S_AURIOL==1
+		case AURIOL:
+			printAuriol(aggregate.address, aggregate.channel,
+				SensorAggregator::mean(aggregate, 0), SensorAggregator::mean(aggregate, 1));
+		break;
+#endif
+		default:
+			return;
+	}
+	if (debug >= 1) {
+		Host.print(F(" ! mean of ")); Host.print(aggregate.count);
+	}
+	Host.println("");
 	msgCnt++;
 }
 #endif
@@ -760,61 +1206,71 @@ void showAuriolCode(auriolCode receivedCode) {
 // Callback function is called only when a valid code is received.
 //
 void showKakuCode(KakuCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_BINARY==1
+  if (Host.isBinary()) {
+	int value = receivedCode.switchType == KakuCode::off ? 0 : receivedCode.switchType == KakuCode::on ? LINK_ON
+		: receivedCode.dimLevelPresent ? receivedCode.dimLevel : LINK_DIM;
+	Host.sendDevice(KAKU, receivedCode.address, receivedCode.groupBit ? LINK_GROUP : receivedCode.unit, value);
+	msgCnt++;
+	return;
+  }
+#endif
 
   // Print the received code. 2 for received codes and 0 for codec of Kaku
-  Serial.print(F("< "));
-  Serial.print(msgCnt);
-  Serial.print(F(" 2 0 "));
-  Serial.print(receivedCode.address);
+  Host.print(F("< "));
+  Host.print(msgCnt);
+  Host.print(F(" 2 0 "));
+  Host.print(receivedCode.address);
   msgCnt++;
   
   if (receivedCode.groupBit) {
-    Serial.print(F(" G "));
+    Host.print(F(" G "));
   } 
   else {
-    Serial.print(F(" "));
-    Serial.print(receivedCode.unit);
+    Host.print(F(" "));
+    Host.print(receivedCode.unit);
   }
   
   switch (receivedCode.switchType) {
     case KakuCode::off:
-      Serial.print(F(" 0"));
+      Host.print(F(" 0"));
       break;
     case KakuCode::on:
-      Serial.print(F(" on"));
+      Host.print(F(" on"));
       break;
     case KakuCode::dim:
-      // Serial.print(F(" dim "));
+      // Host.print(F(" dim "));
 	  if (receivedCode.dimLevelPresent) {
-		Serial.print(F(" "));
-		Serial.print(receivedCode.dimLevel);
+		Host.print(F(" "));
+		Host.print(receivedCode.dimLevel);
 	  }
     break;
   }
   if (debug) {
-	Serial.print(F(" ! Kaku G: "));
-	Serial.print(receivedCode.address);
-	Serial.print(F(" N "));
-	Serial.print(receivedCode.unit);
-	Serial.print(F(" "));
+	Host.print(F(" ! Kaku G: "));
+	Host.print(receivedCode.address);
+	Host.print(F(" N "));
+	Host.print(receivedCode.unit);
+	Host.print(F(" "));
 	switch (receivedCode.switchType) {
 		case KakuCode::off:
-			Serial.print(F(" 0"));
+			Host.print(F(" 0"));
 		break;
 		case KakuCode::on:
-			Serial.print(F(" on"));
+			Host.print(F(" on"));
 		break;
 		case KakuCode::dim:
-			Serial.print(F(" dim "));
+			Host.print(F(" dim "));
 			if (receivedCode.dimLevelPresent) {
-				Serial.print(F(" "));
-				Serial.print(receivedCode.dimLevel);
+				Host.print(F(" "));
+				Host.print(receivedCode.dimLevel);
 			}
 		break;
 	}
   }
-  Serial.println("");
-  Serial.flush();
+  Host.println("");
 }
 
 
@@ -823,26 +1279,35 @@ void showKakuCode(KakuCode receivedCode) {
 // LIVOLO
 //
 void showLivoloCode(livoloCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendDevice(LIVOLO, receivedCode.address, receivedCode.unit, receivedCode.level);
+		msgCnt++;
+		return;
+	}
+#endif
 	
-	Serial.print(F("< "));
-	Serial.print(msgCnt);
-	Serial.print(F(" 2 5 "));
-	Serial.print(receivedCode.address);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.unit);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.level);
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 2 5 "));
+	Host.print(receivedCode.address);
+	Host.print(F(" "));
+	Host.print(receivedCode.unit);
+	Host.print(F(" "));
+	Host.print(receivedCode.level);
 
 	if (debug >= 1) {
-		Serial.print(F(" ! Livolo ")); 
+		Host.print(F(" ! Livolo ")); 
 #if STATISTICS==1
-		Serial.print(F(", P1: ")); Serial.print(receivedCode.min1Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max1Period);
-		Serial.print(F(", P3: ")); Serial.print(receivedCode.min3Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max3Period);
+		Host.print(F(", P1: ")); Host.print(receivedCode.min1Period);
+		Host.print(F("-")); Host.print(receivedCode.max1Period);
+		Host.print(F(", P3: ")); Host.print(receivedCode.min3Period);
+		Host.print(F("-")); Host.print(receivedCode.max3Period);
 #endif
 	}
-	Serial.println("");
+	Host.println("");
 	msgCnt++;
 }
 
@@ -851,24 +1316,33 @@ void showLivoloCode(livoloCode receivedCode) {
 //
 #if R_KOPOU==1
 void showKopouCode(kopouCode receivedCode) {
-	Serial.print(F("< "));
-	Serial.print(msgCnt);
-	Serial.print(F(" 2 6 "));
-	Serial.print(receivedCode.address);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.unit);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.level);
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendDevice(KOPOU, receivedCode.address, receivedCode.unit, receivedCode.level);
+		msgCnt++;
+		return;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 2 6 "));
+	Host.print(receivedCode.address);
+	Host.print(F(" "));
+	Host.print(receivedCode.unit);
+	Host.print(F(" "));
+	Host.print(receivedCode.level);
 	
 	if (debug >= 1) {
-		Serial.print(F(" ! Kopou ")); 
+		Host.print(F(" ! Kopou ")); 
 #if STATISTICS==1
-		Serial.print(F(", P: ")); Serial.print(receivedCode.period);
-		Serial.print(F(", P1: ")); Serial.print(receivedCode.minPeriod);
-		Serial.print(F("-")); Serial.print(receivedCode.maxPeriod);
+		Host.print(F(", P: ")); Host.print(receivedCode.period);
+		Host.print(F(", P1: ")); Host.print(receivedCode.minPeriod);
+		Host.print(F("-")); Host.print(receivedCode.maxPeriod);
 #endif
 	}
-	Serial.println("");
+	Host.println("");
 	msgCnt++;
 }
 #endif
@@ -878,30 +1352,73 @@ void showKopouCode(kopouCode receivedCode) {
 //
 #if R_QUHWA==1
 void showQuhwaCode(quhwaCode receivedCode) {
-	Serial.print(F("< "));
-	Serial.print(msgCnt);
-	Serial.print(F(" 2 7 "));
-	Serial.print(receivedCode.address);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.unit);
-	Serial.print(F(" "));
-	Serial.print(receivedCode.level);
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendDevice(QUHWA, receivedCode.address, receivedCode.unit, receivedCode.level);
+		msgCnt++;
+		return;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 2 7 "));
+	Host.print(receivedCode.address);
+	Host.print(F(" "));
+	Host.print(receivedCode.unit);
+	Host.print(F(" "));
+	Host.print(receivedCode.level);
 	
 	if (debug >= 1) {
-		Serial.print(F(" ! Quhwa ")); 
+		Host.print(F(" ! Quhwa ")); 
 # if STATISTICS==1
-		Serial.print(F(", 1P: ")); Serial.print(receivedCode.min1Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max1Period);
-		Serial.print(F(", 3P: ")); Serial.print(receivedCode.min3Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max3Period);
+		Host.print(F(", 1P: ")); Host.print(receivedCode.min1Period);
+		Host.print(F("-")); Host.print(receivedCode.max1Period);
+		Host.print(F(", 3P: ")); Host.print(receivedCode.min3Period);
+		Host.print(F("-")); Host.print(receivedCode.max3Period);
 # endif
 	}
-	Serial.println("");
+	Host.println("");
 	msgCnt++;
 }
 #endif
 
 
+// --------------------------------------------------------------------------------
+// OOK
+// Generic receiver, the protocols are in OokTable.h. The raw code is reported with the codec
+// of the row, the daemon maps it to a device or sensor.
+//
+#if R_OOK==1
+void showOokCode(OokCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
+	HostMessage message(Host);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendDevice(receivedCode.codec, receivedCode.code, receivedCode.protocol, 0);
+		msgCnt++;
+		return;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(receivedCode.codec >= ONBOARD && receivedCode.codec != OOK ? F(" 3 ") : F(" 2 "));
+	Host.print(receivedCode.codec);
+	Host.print(F(" "));
+	Host.print(receivedCode.code);
+	Host.print(F(" "));
+	Host.print(receivedCode.protocol);
+
+	if (debug >= 1) {
+		Host.print(F(" ! Ook ")); Host.print(receivedCode.code, HEX);
+		Host.print(F(", bits: ")); Host.print(receivedCode.bits);
+	}
+	Host.println("");
+	msgCnt++;
+}
+#endif
+
 // --------------------------------------------------------------------------------
 // REMOTE
 // General receiver for old Kaku, Impulse, etc.
@@ -910,6 +1427,8 @@ void showQuhwaCode(quhwaCode receivedCode) {
 // Must be recognizing the correct remote later (based on period?)
 //
 void showRemoteCode(unsigned long receivedCode, unsigned int period) {
+	if (DupCache::suppressAction(receivedCode)) return;
+	HostMessage message(Host);
 	int i;
 	byte level = 0;
 	byte unit = 0;
@@ -941,25 +1460,32 @@ void showRemoteCode(unsigned long receivedCode, unsigned int period) {
 		}
 	}
 	// Following code should be equal for ALL receivers of this type
-	Serial.print(F("< "));
-	Serial.print(msgCnt);
-	Serial.print(F(" 2 "));					
-	Serial.print(codec);		// action is type 1, blokker type 2, old=3, elro=4, livolo 5.
-	Serial.print(F(" "));
-	Serial.print(address);
-	Serial.print(F(" "));
-	Serial.print(unit);
-	Serial.print(F(" "));
-	Serial.print(level);
+#if A_BINARY==1
+	if (Host.isBinary()) {
+		Host.sendDevice(codec, address, unit, level);
+		msgCnt++;
+		return;
+	}
+#endif
+	Host.print(F("< "));
+	Host.print(msgCnt);
+	Host.print(F(" 2 "));					
+	Host.print(codec);		// action is type 1, blokker type 2, old=3, elro=4, livolo 5.
+	Host.print(F(" "));
+	Host.print(address);
+	Host.print(F(" "));
+	Host.print(unit);
+	Host.print(F(" "));
+	Host.print(level);
 
 	if (debug >= 1) {
-		Serial.print(F(" ! Remote:: period: ")); 
-		Serial.print(period); 
+		Host.print(F(" ! Remote:: period: ")); 
+		Host.print(period); 
 #if STATISTICS==1
-		Serial.print(F(", P: ")); Serial.print(period);
+		Host.print(F(", P: ")); Host.print(period);
 #endif	 
 	}
-	Serial.println("");
+	Host.println("");
 	msgCnt++;
 }
 
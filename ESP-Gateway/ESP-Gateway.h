@@ -16,6 +16,8 @@
 #define A_SERVER 1				// Define local WebServer only if this define is set
 
 #define A_MAXBUFSIZE 192		// Must be larger than 128, but small enough to work
+#define A_UPLINKSIZE 1024		// Messages to the daemon are collected in this buffer and sent once per loop()
+#define A_LOGLINES 4			// Console lines of the receiver callbacks that wait for loop()
 #define BAUDRATE 115200			// Works for debug messages to serial momitor (if attached).
 
 // LamPI Daemon definitions. 
@@ -32,6 +34,41 @@
 
 #define SERVERPORT 8080			// local webserver port
 
+// Decode 433MHz messages in loop() instead of in the interrupt handler (1), or decode in the
+// interrupt handler (0). In deferred mode the interrupt only buffers pulses, so the Serial output
+// of the callbacks can no longer make us miss edges. But loop() must not block for long, so the
+// blocking WiFi reads limit its use for now. In both modes the messages to the daemon are written
+// by loop() only.
+#define A_DEFERRED 0
+
+// Send 433MHz messages from a timer1 interrupt (1), so loop() keeps serving WiFi while a message
+// is being sent, or wait in the parse functions until the message is sent (0). A Kaku dim message
+// takes more than 100 ms.
+#define A_TXTIMER 1
+
+// Send 433MHz commands of the daemon through the transmit scheduler (1), or one after the other
+// as they come in (0). The scheduler drops a command when a newer one for the same device comes in,
+// interleaves the repeats of the devices and waits while a 433MHz message is being received.
+// Needs A_TXTIMER.
+#define A_TXSCHEDULER 1
+
+// Keep the compiled frames of the last commands of the daemon (1), so a command that is sent again
+// is not compiled again, or compile every command (0). See FrameCache.h.
+#define A_TXCACHE 1
+
+// Aggregate the frames of the wireless sensors (WT440, Auriol) over a window of S_WINDOW seconds
+// (1), and send one message per sensor per window with the mean, or send every frame (0). Admin
+// command AGGREGATE shows the table with last, min, max and mean, AGGREGATE=<seconds> sets the window.
+#define A_AGGREGATE 1
+#define S_WINDOW 300
+
+// Raw capture mode (1): admin command CAPTURE=1 makes the gateway stream the raw receiver pulses
+// to a TCP client on CAPTUREPORT (nc <ip> 8081 > remote.raw), for learning new protocols with
+// extras/host/rawtrace. CAPTURE=0 stops it. While capturing nothing is decoded and the sensors
+// are not read. Needs A_SERVER.
+#define A_CAPTURE 1
+#define CAPTUREPORT 8081
+
 // Enable Receivers of handsets. 
 // If you set to 0, the receiver functions will NOT be compiled and included.
 // However be careful with the amount of receivers (R_ ) to enable as parsing
@@ -44,6 +81,11 @@
 #define R_BLOKKER 0
 #define R_QUHWA 1
 
+// Generic table-driven receiver (1) for remotes and sensors without a receiver of their own. The
+// table is OokTable.h, written by extras/host/ookinfer from a trace captured with A_CAPTURE.
+// A row can also be set with admin command OOK=<row>:<fields>, as printed by ookinfer.
+#define R_OOK 0
+
 // Enable transmitters yes (1) or no (0)
 #define T_QUHWA 0
 
@@ -64,6 +106,12 @@
 #define S_PIR 1					//PIR sensor connected to pin 6
 #define S_DHT 0					// Temperature/Humidity Sensors
 
+// The wired sensors are read every S_INTERVAL seconds, but a value is only sent when it changed
+// at least its deadband (see setup()), or when it was not sent for S_HEARTBEAT seconds. Web
+// commands SENSORS=<task>:<seconds> and REPORT=<value>:<tenths>:<seconds> change them.
+#define S_INTERVAL 15
+#define S_HEARTBEAT 300
+
 #if STATISTICS==1
 // A lot of sensor and device statistics can be gathered during operation
 // as we do not have a live logging connection we need this to inspect the ESP
@@ -59,6 +59,8 @@
 #include "OneWireESP.h"				// Special, renamed, version for ESP
 #include <Streaming.h>          	//http://arduiniana.org/libraries/streaming/
 #include <ArduinoJson.h>
+#include "UplinkWriter.h"			// JSON messages to the daemon
+#include "FrameReader.h"			// JSON commands of the daemon
 #include <pins_arduino.h>
 
 // Transmitters Include
@@ -84,16 +86,35 @@
 #include <RemoteReceiver.h>			// for Action receivers
 #include <auriolReceiver.h>			//http://github.com/platenspeler
 #include <quhwaReceiver.h>			//http://github.com/platenspeler
-#include <InterruptChain.h>			// Randy Simons
+#include <OokReceiver.h>				//http://github.com/platenspeler
+#if R_OOK==1
+#include "OokTable.h"				// Written by extras/host/ookinfer
+#endif
+#include <DecoderChain.h>				// Based on InterruptChain of Randy Simons
+#include <DecoderSet.h>
+#include <DupCache.h>
+#include <PulseCapture.h>
+#include <PulseTransmitter.h>
+#include <TxScheduler.h>
+#include <FrameCache.h>
+#include <SensorSweep.h>
+#include <ReportFilter.h>
+#include <SensorAggregator.h>
 
 // Use WiFiClient class to create TCP connections
 // For the gateway we will keep the connection open as long as we can
 // and re-estanblish when broken.
 // And we create a management server too to get statistics and timings
 WiFiClient client;
+UplinkBuffer uplink(client);			// Messages to the daemon, sent at the end of loop()
+FrameReader daemonReader;				// Commands from the daemon
 #if A_SERVER==1
 WiFiServer server(SERVERPORT);
 #endif
+#if A_CAPTURE==1
+WiFiServer captureServer(CAPTUREPORT);	// Raw pulse stream, see PulseCapture.h
+WiFiClient captureClient;
+#endif
 
 //
 // Sensors Include
@@ -106,6 +127,14 @@ DallasTemperature sensors(&oneWire);
 int numberOfDevices; 				// Number of temperature devices found
 #endif
 
+// Values of ReportFilter, the Dallas devices follow V_DALLAS
+#define V_HTU21D_T 0
+#define V_HTU21D_H 1
+#define V_BMP085_T 2
+#define V_BMP085_P 3
+#define V_BH1750 4
+#define V_DALLAS 5
+
 #if S_HTU21D==1
 #include <HTU21D.h>
 HTU21D myHumidity;					// Init HTU Sensor(s)
@@ -145,6 +174,56 @@ QueueChain wQueue;					// Wifi Queue
 
 String OutString;					// Used for debugging, both Serial and on-line
 
+char logLines[A_LOGLINES][A_MAXBUFSIZE];	// Console lines of the receiver callbacks, see ConsoleLine
+byte logLevel[A_LOGLINES];
+volatile byte logHead;						// Next free line, written by the callbacks only
+volatile byte logTail;						// Oldest line, written by logFlush() only
+volatile byte logDropped;
+char consoleLine[A_MAXBUFSIZE];				// Console line of a callback run by loop()
+
+int printConsole(const char *s, int d);
+
+// --------------------------------------------------------------------------------
+// A console line of a receiver callback, printed into a fixed buffer without String. When the
+// callback interrupted loop() the buffer is the next line of logLines, which logFlush() prints
+// from loop(); else it is consoleLine, printed at once. Only the callbacks add to logLines.
+//
+class ConsoleLine : public Print {
+  public:
+	ConsoleLine(int level) : _level(level), _len(0) {
+		if (!DecoderChain::inInterrupt()) _buf = consoleLine;
+		else if ((logHead + 1) % A_LOGLINES == logTail) _buf = NULL;	// Full
+		else _buf = logLines[logHead];
+	}
+
+	virtual size_t write(uint8_t c) {
+		if (_buf != NULL && _len < A_MAXBUFSIZE - 41) _buf[_len++] = c;	// The room printConsole() needs
+		return(1);
+	}
+	using Print::write;
+
+	void end() {
+		if (_buf == NULL) {
+			logDropped++;
+		}
+		else if (_buf == consoleLine) {
+			_buf[_len] = '\0';
+			printConsole(_buf, _level);
+		}
+		else {
+			_buf[_len] = '\0';
+			logLevel[logHead] = _level;
+			logHead = (logHead + 1) % A_LOGLINES;
+		}
+		_len = 0;
+	}
+
+  private:
+	char *_buf;
+	int _level;
+	int _len;
+};
+
 // ********************************************************************************
 // SETUP
 // Setup all sensor routines and the 433 Interrupts
@@ -220,9 +299,14 @@ void setup() {
 	OutString += SERVERPORT;
 	printConsole(OutString, 1);
 #endif
+#if A_CAPTURE==1
+	captureServer.begin();
+#endif
   
 	// Initialize receiver on interrupt 0 (= digital pin 2), calls the callback (for example "showKakuCode")
 	// after 2 identical codes have been received in a row. (thus, keep the button pressed for a moment)
+	// A button that is kept pressed is reported once, repeats are dropped by DupCache.
+	DupCache::init();
 #if R_KAKU==1
 	KakuReceiver::init(-1, 2, showKakuCode);
 	OutString += F("KAKU ");
@@ -250,49 +334,47 @@ void setup() {
 #if S_AURIOL==1
 	auriolReceiver::init(-1, 2, showAuriolCode);
 	OutString += F("AURIOL ") ;
+#endif
+#if R_OOK==1
+	OokReceiver::init(showOokCode);
+	OokReceiver::loadTable(ookTable, OOK_TABLE_SIZE);
+	OutString += F("OOK ") ;
+#endif
+#if A_AGGREGATE==1
+	SensorAggregator::init(showAggregate, S_WINDOW);
 #endif
 	printConsole(OutString,1);
 
-	// Change interrupt mode to CHANGE (on flanks)
-	InterruptChain::setMode(digitalPinToInterrupt(A_RECEIVER), CHANGE);
+	// Attach the decoder chain to the receiver pin. Interrupt mode is CHANGE (on flanks)
+	DecoderChain::init(digitalPinToInterrupt(A_RECEIVER), A_DEFERRED);
+	PulseTransmitter::init(A_TXTIMER);
+#if A_TXSCHEDULER==1
+	TxScheduler::init(channelBusy);
+#endif
   
-	// Define the interrupt chain
+	// Define the decoder chain
 	// The sequence might be relevant, defines the order of execution, put easy protocols first
 	// onCodec: First 16 bits are for sensors (+16), last 16 bits for devices,
-	// By removing a line below, that type of device will not be scanned anymore :-)
+	// A decoder with flag 0 below is not compiled in, and not scanned anymore :-)
 	//
-#if S_WT440==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), wt440Receiver::interruptHandler);  
-	onCodec(WT440);
-#endif
-#if S_AURIOL==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), auriolReceiver::interruptHandler);
-	onCodec(AURIOL);
-#endif
-#if R_ACTION==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), RemoteReceiver::interruptHandler);
-	onCodec(ACTION);
-#endif
-#if R_KAKU==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), KakuReceiver::interruptHandler);
-	onCodec(KAKU);
-#endif
-#if R_LIVOLO==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), livoloReceiver::interruptHandler);
-	onCodec(LIVOLO);
-#endif
-#if R_KOPOU==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), kopouReceiver::interruptHandler);	
-	onCodec(KOPOU);
-#endif
-#if R_QUHWA==1
-	InterruptChain::addInterruptCallback(digitalPinToInterrupt(A_RECEIVER), quhwaReceiver::interruptHandler);	
-	onCodec(QUHWA);
-#endif
+	typedef DecoderSet<
+		Decoder<WT440, wt440Receiver::handlePulse, S_WT440>,
+		Decoder<AURIOL, auriolReceiver::handlePulse, S_AURIOL>,
+		Decoder<ACTION, RemoteReceiver::handlePulse, R_ACTION>,
+		Decoder<KAKU, KakuReceiver::handlePulse, R_KAKU>,
+		Decoder<LIVOLO, livoloReceiver::handlePulse, R_LIVOLO>,
+		Decoder<KOPOU, kopouReceiver::handlePulse, R_KOPOU>,
+		Decoder<QUHWA, quhwaReceiver::handlePulse, R_QUHWA>,
+		Decoder<OOK, OokReceiver::handlePulse, R_OOK>
+	> Receivers;
+	Receivers::attach();
+	DecoderStatistics ds;
+	for (byte i = 0; DecoderChain::getStatistics(i, ds); i++) onCodec(ds.codec);
 
 // Sensors
 #if S_DALLAS==1
-	sensors.begin();
+	sensors.begin();							// Searches the bus once, the addresses are kept
+	sensors.setWaitForConversion(false);		// dallasTask() polls, so we keep serving WiFi
 	numberOfDevices = sensors.getDeviceCount();
 	OutString += F("! #Dallas: "); 
 	OutString += numberOfDevices;
@@ -327,6 +409,27 @@ void setup() {
 	else { onCodec(ONBOARD); onCodec(C_BH1750); }
 #endif
 
+	// The sensors are read every S_INTERVAL seconds by SensorSweep, and a value is only sent
+	// when it changed at least its deadband, see ReportFilter.h. SENSORS and REPORT change this.
+#if S_DALLAS==1
+	SensorSweep::add(dallasTask, S_INTERVAL);
+	for (byte i = V_DALLAS; i < REPORT_VALUES; i++) ReportFilter::setup(i, 0.2, S_HEARTBEAT);
+#endif
+#if S_HTU21D==1
+	SensorSweep::add(htu21dTask, S_INTERVAL);
+	ReportFilter::setup(V_HTU21D_T, 0.2, S_HEARTBEAT);		// Celsius
+	ReportFilter::setup(V_HTU21D_H, 1.0, S_HEARTBEAT);		// Percent
+#endif
+#if S_BMP085==1
+	SensorSweep::add(bmp085Task, S_INTERVAL);
+	ReportFilter::setup(V_BMP085_T, 0.2, S_HEARTBEAT);		// Celsius
+	ReportFilter::setup(V_BMP085_P, 1, S_HEARTBEAT);		// hPa
+#endif
+#if S_BH1750==1
+	SensorSweep::add(bh1750Task, S_INTERVAL);
+	ReportFilter::setup(V_BH1750, 10, S_HEARTBEAT);			// Lux
+#endif
+
 	printCodecs();
 	if (debug>=1) {
 		OutString += F("! Pin A_RECEIVER is pin ");
@@ -360,8 +463,18 @@ void setup() {
 // ********************************************************************************
 
 void loop() {
-  // We can safely do below, as the transmitter is not used in interrupt routines, but by queueHandler.
-  digitalWrite(A_TRANSMITTER, LOW);					// make sure digital transmitter pin is low when not used
+  // The transmitter pin is driven by the timer interrupt while a message is being sent.
+  if (PulseTransmitter::busy()) {
+	DecoderChain::disable();						// Do not decode our own message
+  }
+  else {
+	digitalWrite(A_TRANSMITTER, LOW);				// make sure digital transmitter pin is low when not used
+	DecoderChain::enable();
+  }
+
+#if A_DEFERRED==1
+  DecoderChain::process();							// Decode the received pulses, calls the callbacks
+#endif
 
   // WiFI has/takes priority over Serial commands (probably depreciated in next release).  
   // Are we connected to WiFI network, if not do so.
@@ -396,6 +509,10 @@ void loop() {
 	retries = 0;									// If WLAN connected reset retries
   }
 
+#if A_CAPTURE==1
+  captureFlush();									// Send the raw pulses, if capturing
+#endif
+
   // Check whether we're still connected to the server
   if (!client.connected()) {						// If HOST connection is lost
 	OutString += F("! Reconnecting to host ...");
@@ -429,16 +546,47 @@ void loop() {
   WifiServer();
 #endif
 
+#if A_AGGREGATE==1
+  SensorAggregator::process();						// Queue the windows of the wireless sensors that passed
+#endif
+  logFlush();										// Console lines of the receiver callbacks
   // If there are any new messages on the queue, take them off and process
   handleQueue();  // Read if interrupts put something in QUEUE
+
+#if A_TXSCHEDULER==1
+  TxScheduler::process();							// Send the next repeats of the daemon commands
+#endif
   
   // Handle Sensors reading (based on time). Lowest priority, lowest in chain. 
   // As long as we read these messages once in a while we're OK.
   //delay(1);
+#if A_CAPTURE==1
+  if (!PulseCapture::capturing())					// The blocking reads would lose pulses
+#endif
   readSensors();									// Better for callbacks if there are sleeps
+
+  uplink.send();									// All messages of this loop in one TCP segment
 }//loop
 
 
+#if A_CAPTURE==1
+// --------------------------------------------------------------------------------
+// Write the captured pulses to the capture client. Without a client they are dropped; a client
+// that connects later starts reading at the next frame marker.
+//
+void captureFlush() {
+	if (!captureClient.connected()) {
+		captureClient = captureServer.available();
+	}
+	byte buf[CAPTURE_BUFSIZE];
+	byte n = PulseCapture::read(buf, sizeof(buf) - 1);
+	if (n > 0 && captureClient.connected()) {
+		captureClient.write((const uint8_t *) buf, n);
+	}
+}
+#endif
+
+
 // ***************************** Codecs Admin *************************************
 // 
 // This section defines the functions needed to enable/disable the various codecs
@@ -452,17 +600,16 @@ void loop() {
 //
 void onCodec (byte codec) {
 	codecs |= ( (unsigned long) 0x0001 << codec	);	// AND
-
-  // We support dynamic enablement and disable of sensors and devices
+	DecoderChain::setDecoder(codec, true);		// Sensors and devices without a decoder are not in the chain
 }
 
 // --------------------------------------------------------------------------------
-// We really should disable interrupts for codecs that are in the interrupt chain too.
+// Switch a codec off. A receiver codec is taken out of the decoder chain, so it
+// costs no interrupt time.
 //
 void offCodec (byte codec) {
 	codecs &= ~( (unsigned long) 0x0001 << codec );	// NAND, no effect for 0, but for 1 bit makes 0
-
-	// We support dynamic enablement and disable of sensors and devices
+	DecoderChain::setDecoder(codec, false);
 }
 
 // --------------------------------------------------------------------------------
@@ -536,17 +683,153 @@ void printCodecs() {
 // ********************************************************************************
 
 
+// --------------------------------------------------------------------------------
+// Sensor tasks, run by SensorSweep every S_INTERVAL seconds. Step 0 starts a conversion,
+// the next steps collect it. Return the ms until the next step, or SWEEP_DONE.
+// A value is only sent when ReportFilter says it changed enough, or for the heartbeat.
+//
+#if S_DALLAS==1
+// Dallas sensors (can be more than 1) have channel codes 3 and above!
+// The addresses come from the table made by sensors.begin(), not from the bus.
+unsigned int dallasTask(byte step) {
+	if (step == 0) {
+		sensors.requestTemperatures();				// Returns at once, the conversion takes up to 750 ms
+		return sensors.millisToWaitForConversion();
+	}
+	if (!sensors.isConversionComplete()) {
+		return 10;
+	}
+	DeviceAddress tempDeviceAddress; 			// We'll use this variable to store a found device address
+	for(int i=0; i<numberOfDevices; i++)
+	{
+		// Address found by sensors.begin(), no bus search
+		if(sensors.getAddress(tempDeviceAddress, i))
+		{
+			float tempC = sensors.getTempC(tempDeviceAddress);
+			if (!ReportFilter::changed(V_DALLAS + i, tempC)) continue;
+			// Output the device ID
+			if (debug>=2) {
+				OutString += F("! DS18B20 dev ");
+				OutString += i;
+				printConsole(OutString,2);
+			}
+			//delay(1);
+			if (SensorTransmit(_ADDR, (3+i), (char *)"esp8266" ,(char *) "temperature", tempC) < 0) {
+				OutString += F("ERROR SensorTransmit");
+				printConsole(OutString,1);
+			}
+		} 
+		//else ghost device! Check your power requirements and cabling
+	}
+	return SWEEP_DONE;
+}
+#endif
+
+#if S_HTU21D==1
+// HTU21 or SHT21 has channel code 0
+unsigned int htu21dTask(byte step) {
+	static float humd;
+	switch (step) {
+		case 0:
+			myHumidity.startHumidity();
+			return HTU21D_HUMD_DELAY;
+		case 1:
+			humd = myHumidity.collectHumidity();
+			if (((int)humd == 999) || ((int)humd == 998 )) {	// Timeout (no sensor) or CRC error
+				if (debug>=1) { OutString += F(" ! No HTU21"); printConsole(OutString,1); };
+				return SWEEP_DONE;
+			}
+			myHumidity.startTemperature();
+			return HTU21D_TEMP_DELAY;
+	}
+	float temp = myHumidity.collectTemperature();
+	boolean changed = ReportFilter::changed(V_HTU21D_T, temp);
+	if (ReportFilter::changed(V_HTU21D_H, humd)) changed = true;
+	if (!changed) return SWEEP_DONE;
+	ReportFilter::sent(V_HTU21D_T, temp);				// Both are sent
+	ReportFilter::sent(V_HTU21D_H, humd);
+	if (debug>=2) {
+		Serial << F(" ! HTU21 T: ") << temp << endl;
+	}
+	if (SensorTransmit(_ADDR, 0, (char *)"esp8266" ,(char *)"temperature", temp) < 0) {
+		Serial.println(F("ERROR SensorTransmit"));
+	}
+	if (SensorTransmit(_ADDR, 0, (char *)"esp8266" ,(char *)"humidity", humd) < 0) {
+		Serial.println(F("ERROR SensorTransmit"));
+	}
+	msgCnt++;
+	return SWEEP_DONE;
+}
+#endif
+
+#if S_BMP085==1
+// BMP085 or BMP180 Temperature/Airpressure sensors has channel code 1
+unsigned int bmp085Task(byte step) {
+	static short temperature;
+	switch (step) {
+		case 0:
+			if (bmp085.Calibration() == 998) {					// Hope we can call this function without exception
+				if (debug>=2) { OutString += F(" ! No BMP085"); printConsole(OutString,2); }
+				return SWEEP_DONE;
+			}
+			bmp085.StartTemperature();
+			return BMP085_UT_DELAY;
+		case 1:
+			temperature = bmp085.CollectTemperature();
+			if ((temperature == 998) || (temperature == 0)) {
+				Serial.println(F(" ! Error reading BMP085"));
+				return SWEEP_DONE;
+			}
+			bmp085.StartPressure();
+			return BMP085_UP_DELAY;
+	}
+	long pressure = bmp085.CollectPressure();
+	//float altitude = (float)44330 * (1 - pow(((float) pressure/bmp085.p0), 0.190295));
+	boolean changed = ReportFilter::changed(V_BMP085_T, (float)temperature/10);
+	if (ReportFilter::changed(V_BMP085_P, pressure/100)) changed = true;
+	if (!changed) return SWEEP_DONE;
+	ReportFilter::sent(V_BMP085_T, (float)temperature/10);	// Both are sent
+	ReportFilter::sent(V_BMP085_P, pressure/100);
+	if (debug>=2) {
+		Serial << F("! BMP: t: ") << (float)(temperature/10) << endl;
+	}
+	if (SensorTransmit(_ADDR, 1, (char *)"esp8266" ,(char *)"temperature", (float)temperature/10) < 0) {
+		Serial.println(F("ERROR SensorTransmit"));
+	}
+	if (SensorTransmit(_ADDR, 1, (char *)"esp8266", (char *)"airpressure", (pressure/100)) < 0) {
+		Serial.println(F("ERROR SensorTransmit"));
+	}
+	msgCnt++;
+	return SWEEP_DONE;
+}
+#endif
+
+#if S_BH1750==1
+// Luminescense sensor has channel code 2. Measures continuously, so there is nothing to wait for
+unsigned int bh1750Task(byte step) {
+	uint16_t lux = LightSensor.GetLightIntensity();			// Get Lux value
+	if (lux != (int) -1 && ReportFilter::changed(V_BH1750, lux)) {
+		if (SensorTransmit(_ADDR, 2, (char *)"esp8266", (char *)"luminescense", (float)lux) < 0) {
+			if (debug>=1) Serial.println(F("ERROR SensorTransmit"));
+		}
+		msgCnt++;
+	}
+	return SWEEP_DONE;
+}
+#endif
+
 // --------------------------------------------------------------------------------
 // Read ONBOARD sensors
 //
 // The list of supported onBoard sensors is limited, but can be easily expanded.
-// Based on the most common used sensors that are enabled at compile-time the function
-// it will calculate is value and send it to the daemon socket currently connected.
+// Every sensor is a task of SensorSweep, that reads it every S_INTERVAL seconds and
+// sends the values that changed to the daemon socket currently connected.
 //
 void readSensors() {
-	// Only start reading sensors when enough time hase elapsed.
+	SensorSweep::process();
+
 	int delta = millis() - myTime;
-	if ((delta < 0) || (delta > 63000)){			// 63 seconds, so avoiding collisions with other cron jobs
+	if ((delta < 0) || (delta > 63000)){
 	  myTime = millis();
 	  // We use sensorLoops to record how many times we came here before timer expired
 	  if (debug >= 2) {
@@ -561,88 +844,6 @@ void readSensors() {
 		printConsole(OutString,2);
 	  }
 	  sensorLoops = 0;
-		
-#if S_DALLAS==1
-		// Dallas sensors (can be more than 1) have channel codes 3 and above!
-		uint8_t ind;
-		DeviceAddress tempDeviceAddress; 			// We'll use this variable to store a found device address
-		sensors.requestTemperatures();
-		for(int i=0; i<numberOfDevices; i++)
-		{
-			// Search the wire for address
-			if(sensors.getAddress(tempDeviceAddress, i))
-			{
-				float tempC = sensors.getTempC(tempDeviceAddress);
-				// Output the device ID
-				if (debug>=2) {
-					OutString += F("! DS18B20 dev ");
-					OutString += i;
-					printConsole(OutString,2);
-				}
-				//delay(1);
-				if (SensorTransmit(_ADDR, (3+i), (char *)"esp8266" ,(char *) "temperature", tempC) < 0) {
-					OutString += F("ERROR SensorTransmit");
-					printConsole(OutString,1);
-				}
-			} 
-			//else ghost device! Check your power requirements and cabling
-		}
-#endif
-
-#if S_HTU21D==1
-		// HTU21 or SHT21 has channel code 0
-		float humd = myHumidity.readHumidity();
-		float temp = myHumidity.readTemperature();
-		if (((int)humd != 999) && ((int)humd != 998 )) {	// Timeout (no sensor) or CRC error
-			if (debug>=2) {
-				Serial << F(" ! HTU21 T: ") << temp << endl;
-			}
-			if (SensorTransmit(_ADDR, 0, (char *)"esp8266" ,(char *)"temperature", temp) < 0) {
-				Serial.println(F("ERROR SensorTransmit"));
-			}
-			if (SensorTransmit(_ADDR, 0, (char *)"esp8266" ,(char *)"humidity", humd) < 0) {
-				Serial.println(F("ERROR SensorTransmit"));
-			}
-			msgCnt++;
-		}
-		else if (debug>=1) { OutString += F(" ! No HTU21"); printConsole(OutString,1); };
-#endif
-
-#if S_BMP085==1		
-	  // BMP085 or BMP180 Temperature/Airpressure sensors has channel code 1
-	  if (bmp085.Calibration() != 998) {					// Hope we can call this function without exception
-		short temperature = bmp085.GetTemperature();
-		if ((temperature != 998) && (temperature != 0)) {
-			long pressure = bmp085.GetPressure();
-			//float altitude = (float)44330 * (1 - pow(((float) pressure/bmp085.p0), 0.190295));
-			if (debug>=2) {
-				Serial << F("! BMP: t: ") << (float)(temperature/10) << endl;
-				delay(1);									// Too make sure that this message gets printed
-			}
-			if (SensorTransmit(_ADDR, 1, (char *)"esp8266" ,(char *)"temperature", (float)temperature/10) < 0) {
-				Serial.println(F("ERROR SensorTransmit"));
-			}
-			delay(1);
-			if (SensorTransmit(_ADDR, 1, (char *)"esp8266", (char *)"airpressure", (pressure/100)) < 0) {
-				Serial.println(F("ERROR SensorTransmit"));
-			}
-			msgCnt++;
-		}
-		else { Serial.println(F(" ! Error reading BMP085")); }
-	  }
-	  else if (debug>=2) { OutString += F(" ! No BMP085"); printConsole(OutString,2); }
-#endif
-
-#if S_BH1750==1
-// Luminescense sensor has channel code 2
-		uint16_t lux = LightSensor.GetLightIntensity();			// Get Lux value
-		if (lux != (int) -1) {
-			if (SensorTransmit(_ADDR, 2, (char *)"esp8266", (char *)"luminescense", (float)lux) < 0) {
-				if (debug>=1) Serial.println(F("ERROR SensorTransmit"));
-			}
-			msgCnt++;
-		}
-#endif
 	}
 	else { sensorLoops++; }
 }
@@ -732,6 +933,7 @@ int HostReconnect(char *host, int httpPort){
 #if STATISTICS==1
 		myStat.lastWifiConnect = millis();
 #endif
+		ReportFilter::force();							// The daemon gets every sensor value at once
 	}
 	else {
 		digitalWrite(BUILTIN_LED,LOW);
@@ -747,13 +949,7 @@ int HostReconnect(char *host, int httpPort){
 // Function transmitting Onboard Sensor Wifi messages to host
 //
 int SensorTransmit( uint32_t address, uint8_t channel, char *brand, char *label, float value) {
-	char tbuf[A_MAXBUFSIZE];
-	int ival = (int) value;						// Make integer part
-	int fval = (int) ((value - ival)*10);		// Fraction
-
-	sprintf (tbuf,
-	"{\"tcnt\":\"%d\",\"type\":\"json\",\"action\":\"sensor\",\"brand\":\"%s\",\"address\":\"%lu\",\"channel\":\"%d\",\"%s\":\"%d.%d\"}"
-	, msgCnt, brand, address, channel, label, ival, fval);
+	long tenths = (long) (value*10);
 
 	// We cannot block the program in interrupt whith reconnections.
 	// Therefore only is connected we're able to send the message.
@@ -763,13 +959,15 @@ int SensorTransmit( uint32_t address, uint8_t channel, char *brand, char *label,
 #if STATISTICS==1
 		myStat.lastWifiWrite=millis();			// Update statistics with this transmission
 #endif
-		client.write((const char *)tbuf, strlen(tbuf));
+		UplinkMessage msg(uplink, msgCnt, "sensor");
+		msg.add("brand", brand);
+		msg.add("address", (unsigned long) address);
+		msg.add("channel", (long) channel);
+		msg.addTenths(label, tenths);
+		msg.end();
 
-		if (debug>=1)
+		if (debug>=1) {
 			OutString += F("SEND: ");
-			OutString += " <";
-			OutString += strlen(tbuf);
-			OutString += "> ";
 			OutString += address;
 			OutString += ":";
 			OutString += channel;
@@ -778,10 +976,9 @@ int SensorTransmit( uint32_t address, uint8_t channel, char *brand, char *label,
 			OutString += ", ";
 			OutString += label;
 			OutString += ": ";
-			OutString += ival;
-			OutString += ".";
-			OutString += fval;
+			OutString += value;
 			printConsole(OutString,1);
+		}
 		msgCnt++;
 	}
 	else {
@@ -800,38 +997,29 @@ int SensorTransmit( uint32_t address, uint8_t channel, char *brand, char *label,
 // Take a sensor structure off the queue and send it to the daemon over the
 // communication socket.
 //
-int sensorQueue(queueItem qi) {
-	char tbuf[A_MAXBUFSIZE];
-	int ival = (int) qi.value;					// Make interger part
-	int fval = (int) ((qi.value - ival)*10);	// Fraction
-	// Copy to string
-	sprintf (tbuf,
-		"{\"tcnt\":\"%d\",\"type\":\"json\",\"action\":\"sensor\",\"brand\":\"%s\",\"address\":\"%lu\",\"channel\":\"%d\",\"%s\":\"%d.%d\"}"
-		, msgCnt, qi.brand, qi.address, qi.channel, qi.label, ival, fval);
+int sensorQueue(const queueItem &qi) {
 	// Send to WiFi Transmit
 	if (client.connected()) {
 #if STATISTICS==1
 		myStat.lastWifiWrite=millis();
 #endif
-		client.write((const char *)tbuf, strlen(tbuf));
+		UplinkMessage msg(uplink, msgCnt, "sensor");
+		msg.add("brand", QueueChain::codecName(qi.brand));
+		msg.add("address", (unsigned long) qi.address);
+		msg.add("channel", (long) qi.channel);
+		msg.addTenths(QueueChain::labelName(qi.label), qi.value);
+		msg.end();
 		if (debug>=1) {
 			OutString += F("SEND: ");
-			OutString += " <";
-			OutString += strlen(tbuf);
-			OutString += "> ";
 			OutString += qi.address;
 			OutString += ":";
 			OutString += qi.channel;
 			OutString += ", brand: ";
-			OutString += qi.brand;
+			OutString += QueueChain::codecName(qi.brand);
 			OutString += ", ";
-			OutString += qi.label;
+			OutString += QueueChain::labelName(qi.label);
 			OutString += ": ";
-			OutString += ival;
-			OutString += ".";
-			OutString += fval;
-			// Here add brand and values
-			//OutString += tbuf;
+			OutString += (float) qi.value / 10;
 			printConsole(OutString,1);
 		}
 		msgCnt++;
@@ -847,14 +1035,25 @@ int sensorQueue(queueItem qi) {
 // DEVICE QUEUE
 // Handle the queue with your devices glasses on ...
 //
-int deviceQueue(queueItem qi) {
-	char tbuf[A_MAXBUFSIZE];
-	char message[16];
+int deviceQueue(const queueItem &qi) {
+	char val[8];
+	char message[32];
 	
-	// Copy to string
-	sprintf (tbuf,
-		"{\"tcnt\":\"%d\",\"type\":\"json\",\"action\":\"%s\",\"cmd\":\"%s\",\"gaddr\":\"%lu\",\"uaddr\":\"%d\",\"val\":\"%s\",\"message\":\"%s\"}"
-		, msgCnt, qi.action, qi.cmd, qi.gaddr, qi.uaddr, qi.val, qi.message);
+	// The value and the message in the format of the daemon
+	switch (qi.label) {
+		case Q_ONOFF:
+			sprintf(val, "%s", (qi.value ? "on" : "off"));
+			sprintf(message, "!A%luD%dF%d", (unsigned long)qi.gaddr, qi.uaddr, (qi.value ? 1 : 0));
+			break;
+		case Q_DIM:
+			sprintf(val, "%2ld", (long)qi.value);
+			sprintf(message, "!A%luD%dFdP%ld", (unsigned long)qi.gaddr, qi.uaddr, (long)qi.value);
+			break;
+		default:
+			sprintf(val, "%ld", (long)qi.value);
+			sprintf(message, "!A%luD%dF%ld", (unsigned long)qi.gaddr, qi.uaddr, (long)qi.value);
+	}
+
 	// Send to WiFi Transmit
 	if (client.connected()) {
 #if STATISTICS==1
@@ -866,9 +1065,15 @@ int deviceQueue(queueItem qi) {
 			if (debug>=1) Serial << F("Address ") << qi.gaddr << F(" reserved to LamPI") << endl;
 			return(-1);
 		}
-		client.write((const char *)tbuf, strlen(tbuf));
+		UplinkMessage msg(uplink, msgCnt, QueueChain::actionName(qi.action));
+		msg.add("cmd", QueueChain::codecName(qi.cmd));
+		msg.add("gaddr", (unsigned long) qi.gaddr);
+		msg.add("uaddr", (long) qi.uaddr);
+		msg.add("val", val);
+		msg.add("message", message);
+		msg.end();
 		if (debug>=1)
-			Serial << F("SEND: ") << qi.gaddr << ":" << qi.uaddr << " <" << strlen(tbuf) << "> " << tbuf << endl;
+			Serial << F("SEND: ") << qi.gaddr << ":" << qi.uaddr << " " << val << " " << message << endl;
 		msgCnt++;
 	}
 	else {
@@ -895,26 +1100,26 @@ int handleQueue() {
 	queueItem qi;
 	while ((QueueChain::processQueue(&qi)) >= 0) {
 		// We have a valid action the queue
-		// Maybe make the action an enumerated type ...
-		if (strcmp(qi.action, "sensor")==0) {
+		switch (qi.action) {
+		case Q_SENSOR:
 			// sensor
 			sensorQueue(qi);
-		}
-		else if (strcmp(qi.action, "gui")==0) {
+			break;
+		case Q_GUI:
 			// Could be gui
 			if (debug >=2) {
 				Serial << F("handleQueue:: Gui read") << endl;
 			}
 			deviceQueue(qi);
-		}
-		else if (strcmp(qi.action, "handset")==0) {
+			break;
+		case Q_HANDSET:
 			// or handset
 			if (debug >= 2) {
 				Serial << F("handleQueue:: Handset read") << endl;
 			}
 			deviceQueue(qi);
-		}
-		else {
+			break;
+		default:
 			Serial << F("handleQueue:: ERROR unknow action") << endl;
 		}
 	}
@@ -922,6 +1127,49 @@ int handleQueue() {
 }
 
 
+
+// --------------------------------------------------------------------------------
+// Find the compiled 433MHz frame of command value for device (codec, gaddr, uaddr).
+// Returns true if frame points to a frame compiled before, false if the caller must
+// compile the frame into it.
+//
+#define KAKU_ON 16				// Command value of Kaku "on", 0 is off and 1-15 the dim levels
+
+boolean getFrame(byte codec, unsigned long gaddr, byte uaddr, int value, PulseFrame *&frame) {
+#if A_TXCACHE==1
+	return FrameCache::get(codec, gaddr, uaddr, value, frame);
+#else
+	static PulseFrame buffer;
+	frame = &buffer;
+	return false;
+#endif
+}
+
+// --------------------------------------------------------------------------------
+// Send a compiled 433MHz frame for device (codec, gaddr, uaddr). With the scheduler
+// the frame only replaces an older command for the same device and is sent later
+// by TxScheduler::process() in loop().
+//
+void transmitFrame(byte codec, unsigned long gaddr, byte uaddr, const PulseFrame &frame) {
+#if A_TXSCHEDULER==1
+	if (!TxScheduler::add(codec, gaddr, uaddr, frame)) {
+		OutString += F(" ! ERROR transmit scheduler full, command dropped");
+		printConsole(OutString,1);
+	}
+#else
+	PulseTransmitter::transmit(frame);
+#endif
+}
+
+#if A_TXSCHEDULER==1
+// --------------------------------------------------------------------------------
+// Tells the transmit scheduler whether a 433MHz message is coming in, so we do not
+// transmit over it.
+//
+boolean channelBusy() {
+	return KakuReceiver::isReceiving(0);
+}
+#endif
 // --------------------------------------------------------------------------------
 // WIFI RECEIVE
 //
@@ -929,7 +1177,6 @@ int handleQueue() {
 // Daemon commands are json encoded
 //
 int WifiReceive() {
-	int ind;
 
 	// Read all the lines of the reply from server and print them to Serial
 	//
@@ -937,105 +1184,125 @@ int WifiReceive() {
 		digitalWrite(BUILTIN_LED, HIGH);
 		OutString += F("! WifiReceive: not connected");
 		printConsole(OutString,1);
+		daemonReader.reset();
 		return(-1);
 	}
-	else {
-		//delay(5);
-	}
 	
-	// Reading until a \r\n does not work and leads to timeout.
-	// Server will only send JSON messages which are packed in {}
-	if (client.available()) {
-		// Read until } character, but as not included as part of result, append immediately
-		String line = client.readStringUntil('}') + "}"; 
+	// Server will only send JSON messages which are packed in {}.
+	// Only take the bytes that are there, the rest of a command comes in a next loop().
+	int n = client.available();
+	while (n-- > 0) {
+		if (daemonReader.feed(client.read())) {
 #if STATISTICS==1
-		myStat.lastWifiRead=millis();
+			myStat.lastWifiRead=millis();
 #endif
+			WifiCommand(daemonReader.frame(), daemonReader.length());
+		}
+	}
+	return(0);
+}
 
-		// Now decode the JSON string received from the server
-		StaticJsonBuffer<256> jsonBuffer;
-		JsonObject& root = jsonBuffer.parseObject(line.c_str());
-		
-		if (!root.success()) {
-			OutString += F(" ! ERROR WifiReceive:: Json Decode");
-			printConsole(OutString,1);
-			return(-1);
+// --------------------------------------------------------------------------------
+// WIFI COMMAND
+//
+// Decode and execute one command of the daemon. line is parsed in place.
+//
+int WifiCommand(char *line, int len) {
+	// Now decode the JSON string received from the server
+	StaticJsonBuffer<256> jsonBuffer;
+	JsonObject& root = jsonBuffer.parseObject(line);
+	
+	if (!root.success()) {
+		OutString += F(" ! ERROR WifiReceive:: Json Decode");
+		printConsole(OutString,1);
+		return(-1);
+	}
+	//delay(1);
+	const char * action = root["action"];
+	if (action == NULL) action = "";
+	
+	if (strcmp(action,"alarm")==0) {
+		OutString += F(" ! ERROR WifiReceive:: ALARM received");
+		printConsole(OutString,1);
+		//delay(5);
+		return(-1);
+	}
+	int tcnt = root["tcnt"];
+	const char * type  = root["type"];
+	const char * cmd = root["cmd"];						// Only if this token is present
+	if (cmd == NULL) cmd = "";
+	unsigned int gaddr = root["gaddr"];
+	byte uaddr = root["uaddr"];
+	const char * val = root["val"];
+	if (val == NULL) val = "";
+	const char * message = root["message"];
+	
+	OutString += F("READ:  <");
+	OutString += len;
+	OutString += "> ";
+	OutString += gaddr;
+	OutString += ":";
+	OutString += uaddr;
+	OutString += ", ";
+	OutString += cmd;
+	OutString += ", value: ";
+	OutString += val;
+	printConsole(OutString,1);
+	
+	// Parse and transmit KAKU message	
+	if (strcmp(cmd, "kaku")==0) {
+		int value = atoi(val) /2 ;						// XXX Dimlevel of devices is 0-15, socket LamPI level 0-31
+		if (val[0] == 'o') {
+			if (val[1]=='n') value = KAKU_ON;
+			else if (val[1]=='f') value = 0;
+			else { OutString += F(" ! wifiReceive:: Unknown button command"); printConsole(OutString,1); return(-1); }
 		}
-		//delay(1);
-		const char * action = root["action"];
-		
-		if (strcmp(action,"alarm")==0) {
-			OutString += F(" ! ERROR WifiReceive:: ALARM received");
+		else if (value < 0 || value > 15) {
+			OutString += F(" ! ERROR dim not between 0 and 15!");
 			printConsole(OutString,1);
-			//delay(5);
 			return(-1);
 		}
-		int tcnt = root["tcnt"];
-		const char * type  = root["type"];
-		const char * cmd = root["cmd"];						// Only if this token is present
-		unsigned int gaddr = root["gaddr"];
-		byte uaddr = root["uaddr"];
-		const char * val = root["val"];
-		const char * message = root["message"];
-		
-		OutString += F("READ:  <");
-		OutString += line.length();
-		OutString += "> ";
-		OutString += gaddr;
-		OutString += ":";
-		OutString += uaddr;
-		OutString += ", ";
-		OutString += cmd;
-		OutString += ", value: ";
-		OutString += val;
-		printConsole(OutString,1);
-		
-		// Parse and transmit KAKU message	
-		if (strcmp(cmd, "kaku")==0) {
-			int value = atoi(val) /2 ;						// XXX Dimlevel of devices is 0-15, socket LamPI level 0-31
+		PulseFrame *frame;
+		if (!getFrame(KAKU, gaddr, uaddr, value, frame)) {
 			KakuTransmitter transmitter(A_TRANSMITTER, 260, 3);
-			if (val[0] == 'o') {
-				if (val[1]=='n') transmitter.sendUnit(gaddr, uaddr, true);
-				else if (val[1]=='f') transmitter.sendUnit(gaddr, uaddr, false);
-				else { OutString += F(" ! wifiReceive:: Unknown button command"); printConsole(OutString,1); }
-			}
-			else if (value == 0) {
-				transmitter.sendUnit(gaddr, uaddr, false);
-			} 
-			else if (value >= 1 && value <= 15) {
-				transmitter.sendDim(gaddr, uaddr, value);
-			} 
-			else {
-				OutString += F(" ! ERROR dim not between 0 and 15!");
-				printConsole(OutString,1);
-			}
-		} 
-		// This is an action command
-		else if (strcmp(cmd, "action")==0) {
-			OutString += F(" ! action cmd");
-			printConsole(OutString,1);
+			if (value == KAKU_ON || value == 0) transmitter.frameUnit(*frame, gaddr, uaddr, value == KAKU_ON);
+			else transmitter.frameDim(*frame, gaddr, uaddr, value);
+		}
+		transmitFrame(KAKU, gaddr, uaddr, *frame);
+	} 
+	// This is an action command
+	else if (strcmp(cmd, "action")==0) {
+		OutString += F(" ! action cmd");
+		printConsole(OutString,1);
+		boolean on = strcmp(val, "on")==0;
+		PulseFrame *frame;
+		if (!getFrame(ACTION, gaddr, uaddr, on, frame)) {
 			ActionTransmitter atransmitter(A_TRANSMITTER, 195, 3);		// Timing 195us pulse
-			if (strcmp(val, "on")==0) atransmitter.sendSignal(gaddr,uaddr,true);
-			else atransmitter.sendSignal(gaddr,uaddr,false);
+			atransmitter.frameSignal(*frame, gaddr, uaddr, on);
 		}
-		// Livolo
-		else if (strcmp(cmd, "livolo")==0) {
-			OutString += F(" ! livolo cmd");
-			printConsole(OutString,1);
+		transmitFrame(ACTION, gaddr, uaddr, *frame);
+	}
+	// Livolo
+	else if (strcmp(cmd, "livolo")==0) {
+		OutString += F(" ! livolo cmd");
+		printConsole(OutString,1);
+		PulseFrame *frame;
+		if (!getFrame(LIVOLO, gaddr, uaddr, 0, frame)) {
 			Livolo livolo(A_TRANSMITTER);
-			livolo.sendButton(gaddr, uaddr);
-		}
-		// zwave
-		else if (strcmp(cmd, "zwave")==0) {
-			OutString += F(" ! Zwave cmd Ignored");
-			printConsole(OutString,2);
-		} 
-		else {
-			OutString += F(" ! Command not recognized: ");
-			printConsole(OutString,1);
+			livolo.frameButton(*frame, gaddr, uaddr);
 		}
+		transmitFrame(LIVOLO, gaddr, uaddr, *frame);
+	}
+	// zwave
+	else if (strcmp(cmd, "zwave")==0) {
+		OutString += F(" ! Zwave cmd Ignored");
+		printConsole(OutString,2);
+	} 
+	else {
+		OutString += F(" ! Command not recognized: ");
+		printConsole(OutString,1);
 	}
-//XXX	InterruptChain::enable(digitalPinToInterrupt(A_RECEIVER));			// XXX Set interrupts on
+//XXX	DecoderChain::enable();			// XXX Set interrupts on
 	return(0);
 }
 
@@ -1045,7 +1312,9 @@ int WifiReceive() {
 // This funtion implements the WiFI Webserver (very simple one). The purpose
 // of this server is to receive simple admin commands, and execute these
 // results are sent back to the web client.
-// Commands: DEBUG, ADDRESS, IP, CONFIG, CODECS, KAKU, GETTIME, SETTIME
+// Commands: DEBUG, ADDRESS, IP, CONFIG, CODECS, CODECS=<codec>:<0|1>, CAPTURE=<0|1>,
+// OOK=<row>:<14 fields>, DALLAS, SENSORS=<task>:<seconds>, REPORT=<value>:<tenths>:<seconds>,
+// AGGREGATE, AGGREGATE=<seconds>, KAKU, GETTIME, SETTIME
 //
 #if A_SERVER==1
 void WifiServer() {
@@ -1115,6 +1384,36 @@ void WifiServer() {
 			response +="<tr><td style=\"border: 1px solid black;\">Last Handset LIVOLO</td><td style=\"border: 1px solid black;\">"; response +=printTime(myStat.lastSensorLIVOLO);response+="</tr>";
 			response +="</table>";
 #endif
+			{
+			DecoderProfile dp;
+			DecoderStatistics ds;
+			DecoderChain::getProfile(dp);
+			response +="<br>Receiver: "; response+=dp.edges; response+=" edges, interrupt ";
+			response +=dp.isrMin; response+="/"; response+=dp.isrAvg; response+="/"; response+=dp.isrMax;
+			response +=" us min/avg/max, off at most "; response+=dp.maxDisabled; response+=" ms, ";
+			response +=dp.squelched; response+=" edges squelched";
+			for (byte i = 0; DecoderChain::getStatistics(i, ds); i++) {
+				response +="<br>Codec "; response+=ds.codec; response+=": "; response+=ds.decoded;
+				response +=" decoded, "; response+=ds.rejected; response+=" rejected, ";
+				response +=ds.duplicates; response+=" duplicates, "; response+=ds.suppressed; response+=" suppressed";
+			}
+			}
+			response +="<br>Uplink: "; response+=uplink.getMessages(); response+=" messages in ";
+			response +=uplink.getSegments(); response+=" writes";
+			response +="<br>Queue: "; response+=QueueChain::count(); response+=" waiting, max ";
+			response +=QueueChain::getHighWater(); response+=" of "; response+=MAX_QUEUE; response+=", ";
+			response +=QueueChain::getDropped(); response+=" dropped";
+#if A_TXSCHEDULER==1
+			response +="<br>Transmitter: "; response+=TxScheduler::pending(); response+=" waiting, ";
+			response +=TxScheduler::getCoalesced(); response+=" replaced, ";
+			response +=TxScheduler::getDeferrals(); response+=" deferred";
+#endif
+#if A_TXCACHE==1
+			response +="<br>Frame cache: "; response+=FrameCache::getHits(); response+=" hits, ";
+			response +=FrameCache::getMisses(); response+=" compiled";
+#endif
+			response +="<br>Sensors: last sweep "; response+=SensorSweep::getDuration(); response+=" ms, ";
+			response +=ReportFilter::getSent(); response+=" values sent, "; response+=ReportFilter::getHeld(); response+=" held";
 		}
 		// These can be used as a single argument
 		if (strcmp(cmd, "DEBUG")==0) {								// Set debug level 0-2
@@ -1130,10 +1429,41 @@ void WifiServer() {
 			response+=(IPAddress) WiFi.localIP()[2]; response += ".";
 			response+=(IPAddress) WiFi.localIP()[3];
 		}
-		if (strcmp(cmd, "CODECS")==0) { 							// List all codecs in use
+		if (strcmp(cmd, "CODECS")==0) { 							// List all codecs in use, or CODECS=<codec>:<0|1>
+			if (arg != NULL && isdigit(arg[0])) {
+				byte codec = atoi(arg);
+				pch = strtok(NULL, " /:=");
+				setCodec(codec, (pch != NULL && pch[0] == '0') ? 0 : 1);
+			}
 			String s; listCodecs(&s); 
 			response += s; 
 		}
+#if A_CAPTURE==1
+		if (strcmp(cmd, "CAPTURE")==0) {							// Stream raw pulses to CAPTUREPORT (1) or decode (0)
+			if (arg != NULL && arg[0] == '1') PulseCapture::start();
+			else if (arg != NULL && arg[0] == '0') PulseCapture::stop();
+			response += " capture="; response += PulseCapture::capturing();
+			response += ", port "; response += CAPTUREPORT;
+			response += ", lost "; response += PulseCapture::getLost();
+		}
+#endif
+#if R_OOK==1
+		if (strcmp(cmd, "OOK")==0 && arg != NULL) {					// Set a row of the OOK table, as printed by ookinfer
+			byte row = atoi(arg);
+			unsigned int f[14];
+			byte n;
+			for (n = 0; n < 14 && (pch = strtok(NULL, " /:=")) != NULL && isdigit(pch[0]); n++) f[n] = atoi(pch);
+			if (n == 14) {
+				OokProtocol p = { (byte)f[0], (byte)f[1], f[2], f[3], { f[4], f[5], f[6] },
+					(byte)f[7], (byte)f[8], (byte)f[9], (byte)f[10], (byte)f[11], (byte)f[12], (byte)f[13] };
+				response += OokReceiver::setProtocol(row, p) ? " ook row " : " ook row out of range ";
+			}
+			else {
+				response += " ook needs 14 fields, row ";
+			}
+			response += row;
+		}
+#endif
 		if (strcmp(cmd, "KAKU")==0) { 								// Send a KAKU message to device
 			KakuTransmitter transmitter(A_TRANSMITTER, 260, 3);
 			int gaddr = atoi(arg);
@@ -1143,22 +1473,87 @@ void WifiServer() {
 			response += "KAKU "; response += gaddr; response += " ";
 			response += uaddr; response += " ";	response += pch ;
 			
+			PulseFrame frame;
 			if (pch[0] == 'O') {
-				if (pch[1]=='N') transmitter.sendUnit(gaddr, uaddr, true);
-				else if (pch[1]=='F') transmitter.sendUnit(gaddr, uaddr, false);
+				if (pch[1]=='N') { transmitter.frameUnit(frame, gaddr, uaddr, true); transmitFrame(KAKU, gaddr, uaddr, frame); }
+				else if (pch[1]=='F') { transmitter.frameUnit(frame, gaddr, uaddr, false); transmitFrame(KAKU, gaddr, uaddr, frame); }
 				else  {response +="! WifiServer:: Unknown KAKU command"; response+=pch; }
 			}
 			else if (value == 0) {
-				transmitter.sendUnit(gaddr, uaddr, false);
+				transmitter.frameUnit(frame, gaddr, uaddr, false);
+				transmitFrame(KAKU, gaddr, uaddr, frame);
 			} 
 			else if (value >= 1 && value <= 15) {
-				transmitter.sendDim(gaddr, uaddr, value);
+				transmitter.frameDim(frame, gaddr, uaddr, value);
+				transmitFrame(KAKU, gaddr, uaddr, frame);
 			} 
 			else {
 				OutString += F(" ! ERROR dim not between 0 and 15!");
 				printConsole(OutString,1);
 			}
 		}
+#if S_DALLAS==1
+		if (strcmp(cmd, "DALLAS")==0) {								// Search the Dallas bus again
+			sensors.begin();
+			numberOfDevices = sensors.getDeviceCount();
+			response += " dallas devices="; response += numberOfDevices;
+		}
+#endif
+		if (strcmp(cmd, "SENSORS")==0) {							// List the sensor tasks, or SENSORS=<task>:<seconds>
+			if (arg != NULL && isdigit(arg[0])) {
+				byte task = atoi(arg);
+				pch = strtok(NULL, " /:=");
+				if (pch != NULL && isdigit(pch[0])) SensorSweep::setInterval(task, atoi(pch));
+			}
+			for (byte i = 0; i < SensorSweep::count(); i++) {
+				response += "<br>Task "; response += i; response += ": every ";
+				response += SensorSweep::getInterval(i); response += " s";
+			}
+			response += "<br>Last sweep "; response += SensorSweep::getDuration(); response += " ms";
+		}
+#if A_AGGREGATE==1
+		if (strcmp(cmd, "AGGREGATE")==0) {							// Table of the wireless sensors, or AGGREGATE=<seconds>
+			if (arg != NULL && isdigit(arg[0])) SensorAggregator::setWindow(atoi(arg));
+			SensorAggregate sa;
+			response += " window="; response += SensorAggregator::getWindow(); response += " s, ";
+			response += SensorAggregator::getFrames(); response += " frames, ";
+			response += SensorAggregator::getReports(); response += " reports";
+			response += "<table><tr><th>Codec</th><th>Address</th><th>Channel</th><th>Type</th>";
+			response += "<th>Last</th><th>Min</th><th>Max</th><th>Mean</th><th>Frames</th><th>Age s</th></tr>";
+			for (byte i = 0; SensorAggregator::get(i, sa); i++) {
+				response += "<tr><td>"; response += sa.codec; response += "</td><td>"; response += sa.address;
+				response += "</td><td>"; response += sa.channel; response += "</td><td>"; response += sa.type;
+				response += "</td><td>"; response += sa.last[0]; response += "/"; response += sa.last[1];
+				response += "</td><td>"; response += sa.min[0]; response += "/"; response += sa.min[1];
+				response += "</td><td>"; response += sa.max[0]; response += "/"; response += sa.max[1];
+				response += "</td><td>"; response += SensorAggregator::mean(sa, 0); response += "/";
+				response += SensorAggregator::mean(sa, 1);
+				response += "</td><td>"; response += sa.count;
+				response += "</td><td>"; response += (millis() - sa.time) / 1000; response += "</td></tr>";
+			}
+			response += "</table>";
+			SensorAggregator::resetStatistics();
+		}
+#endif
+		if (strcmp(cmd, "REPORT")==0) {								// List the values, or REPORT=<value>:<tenths>:<seconds>
+			if (arg != NULL && isdigit(arg[0])) {
+				byte value = atoi(arg);
+				pch = strtok(NULL, " /:=");
+				if (pch != NULL && isdigit(pch[0])) {
+					float deadband = atoi(pch) / 10.0;
+					pch = strtok(NULL, " /:=");
+					ReportFilter::setup(value, deadband, (pch != NULL && isdigit(pch[0])) ? atoi(pch) : S_HEARTBEAT);
+				}
+			}
+			float deadband;
+			unsigned int heartbeat;
+			for (byte i = 0; ReportFilter::getSetup(i, deadband, heartbeat); i++) {
+				response += "<br>Value "; response += i; response += ": deadband "; response += deadband;
+				response += ", heartbeat "; response += heartbeat; response += " s";
+			}
+			response += "<br>"; response += ReportFilter::getSent(); response += " sent, ";
+			response += ReportFilter::getHeld(); response += " held";
+		}
 		if (strcmp(cmd, "GETTIME")==0) { response += "gettime tbd"; }	// Get the local time
 		if (strcmp(cmd, "SETTIME")==0) { response += "settime tbd"; }	// Set the local time
 		if (strcmp(cmd, "SYSTEM")==0) { 							// List system parameters that are useful
@@ -1230,22 +1625,24 @@ String printTime(unsigned long t) {
 // PRINT CONSOLE MESSAGES
 // The s is the string to be printed, 
 // d is the minimal debug level necessary to print this message
-int printConsole(String s, int d){
+// The uplink and Serial are only written from loop(): the receiver callbacks use ConsoleLine,
+// which keeps their lines for logFlush() when they interrupted loop().
+int printConsole(const char *s, int d){
 
 #if STATISTICS==1
 	myStat.lastDebugWrite=millis();			// Update statistics with this transmission
 #endif
-	if ((s.length()+40) >= A_MAXBUFSIZE) {
+	size_t len = strlen(s);
+	if ((len+40) >= A_MAXBUFSIZE) {
 		//Serial << F("printConsole too long: ") << s << endl;
 		return(-1);
 	}
 	if (client.connected()) {
 		if (debug>=d) {
-			char tbuf[A_MAXBUFSIZE];
-			sprintf (tbuf,
-				"{\"tcnt\":\"%d\",\"type\":\"json\",\"action\":\"debug\",\"cmd\":\"logs\",\"message\":\"%s\"}"
-				, msgCnt, s.c_str() );
-			client.write((const char *)tbuf, strlen(tbuf));
+			UplinkMessage msg(uplink, msgCnt, "debug");
+			msg.add("cmd", "logs");
+			msg.add("message", s);
+			msg.end();
 		}
 
 		if (debug>=1){
@@ -1255,14 +1652,35 @@ int printConsole(String s, int d){
 	}
 	else {
 		if (debug>=d)
-			Serial << F("# ") << " <" << s.length() << "> " << s.c_str() << endl;
+			Serial << F("# ") << " <" << len << "> " << s << endl;
 	}
-	delay(1);
-	s = "";
-	OutString = "";
 	return(0);
 }
 
+// The lines of loop() are still built in OutString
+int printConsole(String &s, int d){
+	int ret = printConsole(s.c_str(), d);
+	s = "";
+	return(ret);
+}
+
+// ------------------------------------------------------------------------------------
+// Print the lines that the receiver callbacks left in logLines, from loop()
+//
+void logFlush() {
+	while (logTail != logHead) {
+		printConsole(logLines[logTail], logLevel[logTail]);
+		logTail = (logTail + 1) % A_LOGLINES;
+	}
+	if (logDropped > 0) {
+		ConsoleLine line(1);
+		line.print(F("! Console lines dropped: "));
+		line.print(logDropped);
+		logDropped = 0;
+		line.end();
+	}
+}
+
 // ************************ 433 TRANSMITTER PART **********************************
 //
 //
@@ -1285,12 +1703,16 @@ void parseQuhwa(char *pch)
 	pch = strtok (NULL, " ,."); group = atol(pch);
 	pch = strtok (NULL, " ,."); unit = atoi(pch);  
 	pch = strtok (NULL, " ,."); level = atoi(pch);
-	quhwa.sendButton(group, unit);
+	PulseFrame *frame;
+	if (!getFrame(QUHWA, group, unit, 0, frame)) {
+		quhwa.frameButton(*frame, group, unit);
+	}
+	transmitFrame(QUHWA, group, unit, *frame);
 	OutString += F("! Quhwa:: G: "); 
 	OutString += group;
 	OutString += F(", U: "); 
 	OutString += unit;
-	Outstring += F(", L: ");
+	OutString += F(", L: ");
 	OutString += level;
 	printConsole(OutString, 1);
 }
@@ -1309,64 +1731,73 @@ void parseQuhwa(char *pch)
 // --------------------------------------------------------------------------------
 // WT440
 #if S_WT440==1
-void showWt440Code(wt440Code receivedCode) {
-	// 
+// Queues the messages of a WT440 frame, or of the mean of a window
+void queueWt440(byte address, byte channel, byte wconst, int temperature, int humidity) {
 	queueItem item;
-	item.address = receivedCode.address;
-	item.channel = receivedCode.channel;
-	item.value = (float)receivedCode.temperature/10;
-	sprintf(item.brand,"wt440");
-	sprintf(item.action,"sensor");
-	sprintf(item.type,"json");
-#if STATISTICS==1
-	myStat.lastSensorRead=millis();
-	myStat.lastSensorWT440=millis();
-#endif
-	float temperature = ((float)(receivedCode.temperature - 6400)) / 128;
-	switch (receivedCode.wconst) {
+	item.address = address;
+	item.channel = channel;
+	item.value = temperature;						// Value in tenths
+	item.brand = WT440;
+	item.action = Q_SENSOR;
+	switch (wconst) {
 		case 0x0:
-			item.value = (float)(receivedCode.temperature);
-			sprintf(item.label,"pir");
+			item.value = (long)temperature * 10;
+			item.label = Q_PIR;
 			QueueChain::addQueue(item, NULL);
 			break;
 		case 0x4:
-			// item.value = (float)(receivedCode.temperature/10;
-			sprintf(item.label,"battery");
+			item.label = Q_BATTERY;
 			QueueChain::addQueue(item, NULL);
 			break;
 		case 0x6:
-			item.value = ((float)(receivedCode.temperature - 6400)) / 128;
-			sprintf(item.label,"temperature");
+			item.value = ((long)temperature - 6400) * 10 / 128;
+			item.label = Q_TEMPERATURE;
 			QueueChain::addQueue(item, NULL);
 			
-			item.value = (float)(receivedCode.humidity);
-			sprintf(item.label,"humidity");
+			item.value = (long)humidity * 10;
+			item.label = Q_HUMIDITY;
 			QueueChain::addQueue(item, NULL);
 			break;
 		case 0x7:
-			item.value = ((float)(receivedCode.temperature - 6400)) / 128;
-			sprintf(item.label,"temperature");
+			item.value = ((long)temperature - 6400) * 10 / 128;
+			item.label = Q_TEMPERATURE;
 			QueueChain::addQueue(item, NULL);
 			
-			item.value = (float)(receivedCode.humidity);
-			sprintf(item.label,"airpressure");
+			item.value = (long)humidity * 10;
+			item.label = Q_AIRPRESSURE;
 			QueueChain::addQueue(item, NULL);
 			break;
-		default:
-			OutString += F("showWT440Code:: Unknown opcode: ");
-			OutString += receivedCode.wconst;
-			printConsole(OutString,1);
+		default: {
+			ConsoleLine line(1);
+			line.print(F("showWT440Code:: Unknown opcode: "));
+			line.print(wconst);
+			line.end();
+		}
 	}
+}
+
+void showWt440Code(wt440Code receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
+#if STATISTICS==1
+	myStat.lastSensorRead=millis();
+	myStat.lastSensorWT440=millis();
+#endif
+#if A_AGGREGATE==1
+	if (receivedCode.wconst != 0x0 && SensorAggregator::add(WT440, receivedCode.address,	// Not the PIR
+		receivedCode.channel, receivedCode.wconst, receivedCode.temperature, receivedCode.humidity)) return;
+#endif
+	queueWt440(receivedCode.address, receivedCode.channel, receivedCode.wconst,
+		receivedCode.temperature, receivedCode.humidity);
 #if STATISTICS==1
 	if (debug>=2) {
-		OutString += F(", W: "); OutString += receivedCode.wconst;
-		OutString += F(", P: "); OutString += receivedCode.par;
-		OutString += F(", P1: "); OutString += receivedCode.min1Period;
-		OutString += F("-"); OutString += receivedCode.max1Period;
-		OutString += F(", P2: "); OutString += receivedCode.min2Period;
-		OutString += F("-"); OutString += receivedCode.max2Period;
-		OutString += ("\n");
-		printConsole(OutString,2);
+		ConsoleLine line(2);
+		line.print(F(", W: ")); line.print(receivedCode.wconst);
+		line.print(F(", P: ")); line.print(receivedCode.par);
+		line.print(F(", P1: ")); line.print(receivedCode.min1Period);
+		line.print(F("-")); line.print(receivedCode.max1Period);
+		line.print(F(", P2: ")); line.print(receivedCode.min2Period);
+		line.print(F("-")); line.print(receivedCode.max2Period);
+		line.end();
 	}
 #endif
 	msgCnt++;
@@ -1381,32 +1812,42 @@ void showWt440Code(wt440Code receivedCode) {
 // Auriol starts at 8
 #if S_AURIOL==1
 //
-void showAuriolCode(auriolCode receivedCode) {
-
+// Queues the message of an Auriol frame, or of the mean of a window
+void queueAuriol(byte address, byte channel, int temperature) {
 	queueItem item;
-	item.address = receivedCode.address;
-	item.channel = receivedCode.channel;
-	item.value = (float)receivedCode.temperature/10;
-	sprintf(item.label,"temperature");
-	sprintf(item.brand,"auriol");
-	sprintf(item.action,"sensor");
-	sprintf(item.type,"json");
+	item.address = address;
+	item.channel = channel;
+	item.value = temperature;							// Value in tenths
+	item.label = Q_TEMPERATURE;
+	item.brand = AURIOL;
+	item.action = Q_SENSOR;
+	QueueChain::addQueue(item, NULL);
+}
+
+void showAuriolCode(auriolCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
 #if STATISTICS==1
 	myStat.lastSensorRead=millis();
 	myStat.lastSensorAURIOL=millis();
 #endif
-	QueueChain::addQueue(item, NULL);
+
+#if A_AGGREGATE==1
+	if (SensorAggregator::add(AURIOL, receivedCode.address, receivedCode.channel, 0,
+		receivedCode.temperature, receivedCode.humidity)) return;
+#endif
+	queueAuriol(receivedCode.address, receivedCode.channel, receivedCode.temperature);
 
 #if STATISTICS==1
 	if (debug >= 2) {
-		OutString += F(" ! Auriol Cs: "); OutString += receivedCode.csum;
-		OutString += F(", N1: "); OutString += receivedCode.n1,BIN;
-		OutString += F(", N2: "); OutString += receivedCode.n2,BIN;	
-		OutString += F(", 1P: "); OutString += receivedCode.min1Period;
-		OutString += F("-"); OutString += receivedCode.max1Period;
-		OutString += F(", 2P: "); OutString += receivedCode.min2Period;
-		OutString += F("-"); OutString += receivedCode.max2Period;
-		printConsole(OutString,2);
+		ConsoleLine line(2);
+		line.print(F(" ! Auriol Cs: ")); line.print(receivedCode.csum);
+		line.print(F(", N1: ")); line.print(receivedCode.n1, BIN);
+		line.print(F(", N2: ")); line.print(receivedCode.n2, BIN);	
+		line.print(F(", 1P: ")); line.print(receivedCode.min1Period);
+		line.print(F("-")); line.print(receivedCode.max1Period);
+		line.print(F(", 2P: ")); line.print(receivedCode.min2Period);
+		line.print(F("-")); line.print(receivedCode.max2Period);
+		line.end();
 	}
 #endif
 	msgCnt++;
@@ -1414,62 +1855,89 @@ void showAuriolCode(auriolCode receivedCode) {
 }
 #endif
 
+#if A_AGGREGATE==1
+// --------------------------------------------------------------------------------
+// One message per sensor per window, with the mean of its frames. See SensorAggregator.h
+//
+void showAggregate(const SensorAggregate &aggregate) {
+	switch (aggregate.codec) {
+#if S_WT440==1
+		case WT440:
+			queueWt440(aggregate.address, aggregate.channel, aggregate.type,
+				SensorAggregator::mean(aggregate, 0), SensorAggregator::mean(aggregate, 1));
+		break;
+#endif
+#if S_AURIOL==1
+		case AURIOL:
+			queueAuriol(aggregate.address, aggregate.channel, SensorAggregator::mean(aggregate, 0));
+		break;
+#endif
+	}
+}
+#endif
+
 // --------------------------------------------------------------------------------
 // KAKU
 // Regular handset for klikaanklikuit devices
 // Callback function is called only when a valid code is received.
 //
 void showKakuCode(KakuCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
 
   queueItem item;
   item.gaddr = receivedCode.address;
   item.uaddr = receivedCode.unit;
-  sprintf(item.cmd,"kaku");
-  sprintf(item.action,"handset");
+  item.cmd = KAKU;
+  item.action = Q_HANDSET;
 	
   switch (receivedCode.switchType) {
     case KakuCode::off:
-      sprintf(item.val, "off");
-	  sprintf(item.message,"!A%dD%dF0", receivedCode.address, receivedCode.unit);
+      item.value = 0;
+      item.label = Q_ONOFF;
       break;
     case KakuCode::on:
-      sprintf(item.val, "on");
-	  sprintf(item.message,"!A%dD%dF1", receivedCode.address, receivedCode.unit);
+      item.value = 1;
+      item.label = Q_ONOFF;
       break;
     case KakuCode::dim:										// The dimlevel worked with in Lampi is 2 * physical level.
 	  if (receivedCode.dimLevelPresent) {
-		sprintf(item.val, "%2d", receivedCode.dimLevel*2);
-		sprintf(item.message,"!A%dD%dFdP%d", receivedCode.address, receivedCode.unit, receivedCode.dimLevel*2);
+		item.value = receivedCode.dimLevel*2;
+		item.label = Q_DIM;
 	  }
 	  else {
-		OutString += F("showKakuCode:: no dim value");
-		printConsole(OutString,1);
+		ConsoleLine line(1);
+		line.print(F("showKakuCode:: no dim value"));
+		line.end();
+		return;
 	  }
     break;
   }
   msgCnt++;
   
   if (receivedCode.groupBit) {
-	OutString += F(" G ");
-    printConsole(OutString,1);							// No idea yet what to do with this. Not used in lamPI
+	ConsoleLine line(1);
+	line.print(F(" G "));
+    line.end();							// No idea yet what to do with this. Not used in lamPI
   } 
   else if (debug>=2) {
-    OutString += F(" ");
-    OutString += receivedCode.unit;
-	printConsole(OutString,2);
+	ConsoleLine line(2);
+    line.print(F(" "));
+    line.print(receivedCode.unit);
+	line.end();
   }
 #if STATISTICS==1
 	myStat.lastSensorRead=millis();
 	myStat.lastSensorKAKU=millis();
 #endif
   if (debug >=2) {
-	OutString += F("! KAKU:: ");
-	OutString += msgCnt;
-	OutString += F(" A: ");
-	OutString += receivedCode.address;
-	OutString += F(":");
-	OutString += receivedCode.unit;
-	printConsole(OutString,2);
+	ConsoleLine line(2);
+	line.print(F("! KAKU:: "));
+	line.print(msgCnt);
+	line.print(F(" A: "));
+	line.print(receivedCode.address);
+	line.print(F(":"));
+	line.print(receivedCode.unit);
+	line.end();
   }
   QueueChain::addQueue(item, NULL); 
 }
@@ -1480,28 +1948,29 @@ void showKakuCode(KakuCode receivedCode) {
 //
 #if R_LIVOLO==1
 void showLivoloCode(livoloCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
 	queueItem item;
 	item.gaddr = receivedCode.address;
 	item.uaddr = receivedCode.unit;
-	sprintf(item.cmd,"livolo");
-	sprintf(item.action,"handset");
-	sprintf(item.type,"json");
-	sprintf(item.val,"%d",receivedCode.level);
-	sprintf(item.message,"!A%dD%dF%d",item.gaddr,item.uaddr,receivedCode.level);
+	item.cmd = LIVOLO;
+	item.action = Q_HANDSET;
+	item.value = receivedCode.level;
+	item.label = Q_LEVEL;
 #if STATISTICS==1
 	myStat.lastSensorRead=millis();
 	myStat.lastSensorLIVOLO=millis();
 #endif
 	QueueChain::addQueue(item, NULL);
-	OutString += F(" ! Livolo ");
 	if (debug >=2) {
+		ConsoleLine line(2);
+		line.print(F(" ! Livolo "));
 #if STATISTICS==1
-		OutString += F(", P1: "); OutString += receivedCode.min1Period;
-		OutString += F("-"); OutString += receivedCode.max1Period;
-		OutString += F(", P3: "); OutString += receivedCode.min3Period;
-		OutString += F("-"); OutString += receivedCode.max3Period;
+		line.print(F(", P1: ")); line.print(receivedCode.min1Period);
+		line.print(F("-")); line.print(receivedCode.max1Period);
+		line.print(F(", P3: ")); line.print(receivedCode.min3Period);
+		line.print(F("-")); line.print(receivedCode.max3Period);
 #endif
-		printConsole(OutString,2);
+		line.end();
 	}
 }
 #endif
@@ -1511,22 +1980,23 @@ void showLivoloCode(livoloCode receivedCode) {
 //
 #if R_KOPOU==1
 void showKopouCode(kopouCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
 	queueItem item;
 	item.gaddr = receivedCode.address;
 	item.uaddr = receivedCode.unit;
-	sprintf(item.cmd,"kopou");
-	sprintf(item.action,"handset");
-	sprintf(item.type,"json");	
-	sprintf(item.val,"%d",receivedCode.level);
-	sprintf(item.message,"!A%dD%dF%d",item.gaddr,item.uaddr,receivedCode.level);
+	item.cmd = KOPOU;
+	item.action = Q_HANDSET;
+	item.value = receivedCode.level;
+	item.label = Q_LEVEL;
 	if (debug >= 2) {
-		Serial.print(F(" ! Kopou ")); 
+		ConsoleLine line(2);
+		line.print(F(" ! Kopou ")); 
 #if STATISTICS==1
-		Serial.print(F(", P: ")); Serial.print(receivedCode.period);
-		Serial.print(F(", P1: ")); Serial.print(receivedCode.minPeriod);
-		Serial.print(F("-")); Serial.print(receivedCode.maxPeriod);
+		line.print(F(", P: ")); line.print(receivedCode.period);
+		line.print(F(", P1: ")); line.print(receivedCode.minPeriod);
+		line.print(F("-")); line.print(receivedCode.maxPeriod);
 #endif
-		Serial.println("");
+		line.end();
 	}
 	msgCnt++;
 }
@@ -1537,29 +2007,57 @@ void showKopouCode(kopouCode receivedCode) {
 //
 #if R_QUHWA==1
 void showQuhwaCode(quhwaCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
 	queueItem item;
 	item.gaddr = receivedCode.address;
 	item.uaddr = receivedCode.unit;
-	sprintf(item.cmd,"quhwa");
-	sprintf(item.action,"handset");
-	sprintf(item.type,"json");	
-	sprintf(item.val,"%d",receivedCode.level);
-	sprintf(item.message,"!A%dD%dF%d",item.gaddr,item.uaddr,receivedCode.level);
+	item.cmd = QUHWA;
+	item.action = Q_HANDSET;
+	item.value = receivedCode.level;
+	item.label = Q_LEVEL;
 	if (debug >= 2) {
-		Serial.print(F(" ! Quhwa "));
+		ConsoleLine line(2);
+		line.print(F(" ! Quhwa "));
 #if STATISTICS==1
-		Serial.print(F(", 1P: ")); Serial.print(receivedCode.min1Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max1Period);
-		Serial.print(F(", 3P: ")); Serial.print(receivedCode.min3Period);
-		Serial.print(F("-")); Serial.print(receivedCode.max3Period);
+		line.print(F(", 1P: ")); line.print(receivedCode.min1Period);
+		line.print(F("-")); line.print(receivedCode.max1Period);
+		line.print(F(", 3P: ")); line.print(receivedCode.min3Period);
+		line.print(F("-")); line.print(receivedCode.max3Period);
 #endif
-		Serial.println("");
+		line.end();
 	}
 	msgCnt++;
 }
 #endif
 
 
+// --------------------------------------------------------------------------------
+// OOK
+// Generic receiver, the protocols are in OokTable.h or set with the OOK admin command. The raw
+// code is sent with the codec of the row, the daemon maps it to a device.
+//
+#if R_OOK==1
+void showOokCode(OokCode receivedCode) {
+	if (DupCache::suppress(receivedCode)) return;
+	queueItem item;
+	item.gaddr = receivedCode.code;
+	item.uaddr = receivedCode.protocol;
+	item.cmd = receivedCode.codec;
+	item.action = Q_HANDSET;
+	item.value = 1;
+	item.label = Q_LEVEL;
+	QueueChain::addQueue(item, NULL);
+	if (debug >= 2) {
+		ConsoleLine line(2);
+		line.print(F(" ! Ook "));
+		line.print(receivedCode.code, HEX);
+		line.print(F(", bits: ")); line.print(receivedCode.bits);
+		line.end();
+	}
+	msgCnt++;
+}
+#endif
+
 // --------------------------------------------------------------------------------
 // REMOTE
 // General receiver for old Kaku, Impulse/Action, etc.
@@ -1568,6 +2066,7 @@ void showQuhwaCode(quhwaCode receivedCode) {
 // Must be recognizing the correct remote later (based on period?)
 //
 void showRemoteCode(uint32_t receivedCode, unsigned int period) {
+	if (DupCache::suppressAction(receivedCode)) return;
 	int i;
 	byte level = 0;
 	byte unit = 0;
@@ -1581,25 +2080,24 @@ void showRemoteCode(uint32_t receivedCode, unsigned int period) {
 	myStat.lastSensorACTION=millis();
 #endif
 	queueItem item;
-	sprintf(item.action,"handset");
+	item.action = Q_HANDSET;
 
 	if ( (period > 120 ) && (period < 180 ) ) {			// Action codec
-		sprintf(item.cmd,"action");
+		item.cmd = ACTION;
 		for (i=0; i<2; i++) {
 			level = level * 10;
 			level += code % 3;
 			code = code / 3;
 		}
-		item.value = (float) level;
 		// two bits, either 02 or 20, the 0 determines the value
 		if (level == 20) { 
 			level = 0; 
-			sprintf(item.val, "on");
 		}
 		else { 
 			level = 1; 
-			sprintf(item.val, "on");
 		}
+		item.value = level;
+		item.label = Q_ONOFF;
 		
 		// 5 bits, 5 units. The position of the 0 determines the unit (0 to 5)	
 		for (i =4; i >= 0; i--) {
@@ -1614,21 +2112,21 @@ void showRemoteCode(uint32_t receivedCode, unsigned int period) {
 			code =  code / 3;
 		}
 		item.gaddr = address;
-		sprintf(item.message,"!A%dD%dF%d",address,unit,level);
 		QueueChain::addQueue(item, NULL);
 	}
 	else {
-		OutString += F("! showRemoteCode:: NOT handled, period: ");
-		OutString += period;
-		printConsole(OutString,1);
-		delay(5);
+		ConsoleLine line(1);
+		line.print(F("! showRemoteCode:: NOT handled, period: "));
+		line.print(period);
+		line.end();
 	}
 	
 	if (debug >= 2) {	
 		// Following code should be equal for ALL receivers of this type
-		OutString += F("REMOTE period: "); 
-		OutString += period; 
-		printConsole(OutString,1);
+		ConsoleLine line(1);
+		line.print(F("REMOTE period: ")); 
+		line.print(period); 
+		line.end();
 	}
 	msgCnt++;
 }
@@ -0,0 +1,75 @@
+// --------------------------------------------------------------------
+// FrameReader.h
+// Author: Maarten Westenberg
+// Version: 1.7.8
+//
+// Splits the byte stream of the daemon socket into JSON commands.
+//
+// The reader is fed one byte at a time with whatever client.available()
+// has, so loop() never waits for the rest of a command. It counts the
+// depth of the {} braces, skipping braces inside strings, so nested
+// objects are fine and several commands in one read are all found.
+// A complete command is a zero terminated string in frame(), which can be
+// parsed in place by ArduinoJson until the next call of feed().
+// --------------------------------------------------------------------
+
+#ifndef FrameReader_h
+#define FrameReader_h
+
+class FrameReader {
+  public:
+	FrameReader() : _len(0), _depth(0), _inString(false), _escape(false), _overflow(false), _overflows(0) {}
+
+	// Add a byte. Returns true when it completes a command.
+	boolean feed(char c) {
+		if (_depth == 0) {
+			if (c != '{') return(false);			// Whitespace etc. between commands
+			_len = 0;
+			_overflow = false;
+		}
+		if (_len < A_MAXBUFSIZE) {
+			_buf[_len++] = c;
+		}
+		else {
+			_overflow = true;						// Read the rest, but do not use it
+		}
+
+		if (_inString) {
+			if (_escape) _escape = false;
+			else if (c == '\\') _escape = true;
+			else if (c == '"') _inString = false;
+			return(false);
+		}
+		if (c == '"') _inString = true;
+		else if (c == '{') _depth++;
+		else if (c == '}') {
+			if (--_depth == 0) {
+				if (_overflow) {
+					_overflows++;
+					return(false);
+				}
+				_buf[_len] = 0;
+				return(true);
+			}
+		}
+		return(false);
+	}
+
+	char *frame() { return(_buf); }
+	int length() { return(_len); }
+	unsigned int getOverflows() { return(_overflows); }
+
+	// Forget a partial command, after the connection was lost
+	void reset() { _depth = 0; _inString = false; _escape = false; }
+
+  private:
+	char _buf[A_MAXBUFSIZE + 1];
+	int _len;
+	byte _depth;
+	boolean _inString;
+	boolean _escape;
+	boolean _overflow;
+	unsigned int _overflows;
+};
+
+#endif
@@ -0,0 +1,9 @@
+// Protocol table for OokReceiver, written by ookinfer from traces/quhwa.txt
+// Load it with OokReceiver::loadTable(ookTable, OOK_TABLE_SIZE)
+
+#define OOK_TABLE_SIZE 1
+
+const OokProtocol ookTable[OOK_TABLE_SIZE] PROGMEM = {
+//  codec, encoding, syncMin, syncMax, widths, tolerance, skip, pulses, zero, one, bits, minRepeats
+	{ 22, OOK_PULSES, 4200, 7800, { 350, 1050, 0 }, 30, 5, 1, 0x00, 0x01, 32, 2 },
+};
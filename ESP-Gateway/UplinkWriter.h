@@ -0,0 +1,130 @@
+// --------------------------------------------------------------------
+// UplinkWriter.h
+// Author: Maarten Westenberg
+// Version: 1.7.8
+//
+// Writing of the JSON messages for the LamPI daemon.
+//
+// The messages are written with the JsonWriter of ArduinoJson straight into
+// one send buffer, without sprintf() buffers or String objects in between.
+// All messages of one loop() are sent to the daemon with one client.write()
+// by UplinkBuffer::send(), so they mostly go out in a single TCP segment.
+//
+// Usage:
+//		UplinkMessage msg(uplink, msgCnt, "sensor");
+//		msg.add("brand", "wt440");
+//		msg.add("address", address);
+//		msg.end();
+//
+// All values are sent as strings, as the daemon expects.
+//
+// The buffer is written and sent from loop() only. The receiver callbacks can
+// interrupt loop() in the middle of a message, so they queue their events in
+// QueueChain and their console lines in a ConsoleLine, and loop() formats them.
+// --------------------------------------------------------------------
+
+#ifndef UplinkWriter_h
+#define UplinkWriter_h
+
+#include <ArduinoJson.h>
+
+// --------------------------------------------------------------------
+// Buffer that collects messages until send() is called. A message is never
+// split over two writes: if a message of A_MAXBUFSIZE might not fit, the
+// buffer is sent first.
+//
+class UplinkBuffer : public Print {
+  public:
+	UplinkBuffer(Client &client) : _client(client), _len(0), _messages(0), _segments(0) {}
+
+	virtual size_t write(uint8_t c) {
+		if (_len >= A_UPLINKSIZE) send();		// Only when a message is larger than A_MAXBUFSIZE
+		_buf[_len++] = c;
+		return(1);
+	}
+
+	void beginMessage() {
+		if (_len + A_MAXBUFSIZE > A_UPLINKSIZE) send();
+		_messages++;
+	}
+
+	// Send the buffer to the daemon. If not connected the messages are lost,
+	// just as they were before.
+	void send() {
+		if (_len == 0) return;
+		if (_client.connected()) {
+			_client.write((const uint8_t *)_buf, _len);
+			_segments++;
+		}
+		_len = 0;
+	}
+
+	size_t pending() { return(_len); }
+	unsigned long getMessages() { return(_messages); }
+	unsigned long getSegments() { return(_segments); }
+
+  private:
+	Client &_client;
+	char _buf[A_UPLINKSIZE];
+	size_t _len;
+	unsigned long _messages;
+	unsigned long _segments;
+};
+
+// --------------------------------------------------------------------
+// One JSON object {"tcnt":"..","type":"json","action":"..", ...} in the buffer.
+// Keys and string values are escaped by JsonWriter.
+//
+class UplinkMessage {
+  public:
+	UplinkMessage(UplinkBuffer &out, int tcnt, const char *action) : _out(out), _writer(out) {
+		_out.beginMessage();
+		_writer.beginObject();
+		_first = true;
+		add("tcnt", (long) tcnt);
+		add("type", "json");
+		add("action", action);
+	}
+
+	void add(const char *key, const char *value) {
+		writeKey(key);
+		_writer.writeString(value);
+	}
+
+	void add(const char *key, long value) {
+		writeKey(key);
+		_out.write('"'); _out.print(value); _out.write('"');
+	}
+
+	void add(const char *key, unsigned long value) {
+		writeKey(key);
+		_out.write('"'); _out.print(value); _out.write('"');
+	}
+
+	// Value in tenths, written as "-12.3"
+	void addTenths(const char *key, long tenths) {
+		writeKey(key);
+		_out.write('"');
+		if (tenths < 0) { _out.write('-'); tenths = -tenths; }
+		_out.print(tenths / 10); _out.write('.'); _out.print(tenths % 10);
+		_out.write('"');
+	}
+
+	void end() {
+		_writer.endObject();
+	}
+
+  private:
+	void writeKey(const char *key) {
+		if (!_first) _writer.writeComma();
+		_first = false;
+		_writer.writeString(key);
+		_writer.writeColon();
+	}
+
+	UplinkBuffer &_out;
+	ArduinoJson::Internals::JsonWriter _writer;
+	boolean _first;
+};
+
+#endif
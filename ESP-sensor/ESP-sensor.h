@@ -28,4 +28,12 @@
 #define S_BH1750 0      //Luminescense I2C sensor
 #define S_BATTERY 0     //Internal voltage reference pin A0
 #define S_DS3231 0      //RTC I2C sensor      
-#define S_PIR 0         //PIR sensor connected to pin 6
\ No newline at end of file
+#define S_PIR 0         //PIR sensor connected to pin 6
+
+// The sensors are read every S_INTERVAL (+5) seconds, but a value is only sent when it changed
+// at least S_DEADBAND_T degrees or S_DEADBAND_P hPa since it was sent last, or when it was not
+// sent for S_HEARTBEAT seconds, see ReportFilter.h
+#define S_INTERVAL 15
+#define S_DEADBAND_T 0.2
+#define S_DEADBAND_P 1
+#define S_HEARTBEAT 300
@@ -14,6 +14,12 @@
 #include <Wire.h>
 
 #include <InterruptChain.h>
+#include <ReportFilter.h>
+
+// Values of ReportFilter, the Dallas devices follow V_DALLAS
+#define V_BMP085_T 0
+#define V_BMP085_P 1
+#define V_DALLAS 2
 
 #if S_DALLAS==1
 #include "OneWireESP.h"
@@ -76,6 +82,7 @@ void setup() {
 	sensors.begin();
 	numberOfDevices = sensors.getDeviceCount();
 	Serial.print("! #Dallas: "); Serial.println(numberOfDevices);
+	for (byte i = V_DALLAS; i < REPORT_VALUES; i++) ReportFilter::setup(i, S_DEADBAND_T, S_HEARTBEAT);
 #endif
 #if S_HTU21D==1
 	myHumidity.begin(); 
@@ -91,6 +98,8 @@ void setup() {
 	Serial.println(SCL);
 	//onCodec(ONBOARD);
 	if (bmp085.Calibration() == 998) Serial.println(F("! No BMP085"));	// OnBoard
+	ReportFilter::setup(V_BMP085_T, S_DEADBAND_T, S_HEARTBEAT);
+	ReportFilter::setup(V_BMP085_P, S_DEADBAND_P, S_HEARTBEAT);
 #endif
 
 	// We start by connecting to a WiFi network 
@@ -156,6 +165,7 @@ void loop() {
 			Serial.print(tempC,1);
 			Serial.println();
 			
+			if (!ReportFilter::changed(V_DALLAS + i, tempC)) continue;	// Not changed enough
 			if (WifiTransmit(address, channel, "temperature", (String)tempC) < 0) {
 				Serial.println(F("ERROR WifiTransmit"));
 			}
@@ -207,12 +217,18 @@ void loop() {
 		}
 		Serial.println();
 		float value = (float)temperature/10;			// We need the first decimal as well
-		WifiTransmit(address, "2", "temperature", (String)(value) );
-		WifiTransmit(address, "2", "airpressure", (String)(pressure/100) );
+		boolean changed = ReportFilter::changed(V_BMP085_T, value);
+		if (ReportFilter::changed(V_BMP085_P, pressure/100)) changed = true;
+		if (changed) {
+			ReportFilter::sent(V_BMP085_T, value);		// Both are sent
+			ReportFilter::sent(V_BMP085_P, pressure/100);
+			WifiTransmit(address, "2", "temperature", (String)(value) );
+			WifiTransmit(address, "2", "airpressure", (String)(pressure/100) );
+		}
 	}
 #endif	
 	
-	delay(45000);				// XXX should be close to 2 minutes
+	delay(S_INTERVAL * 1000UL);	// Only values that changed are sent, see ESP-sensor.h
 }
 
 // ------------------------------------------------------------
@@ -19,6 +19,8 @@ DallasTemperature::DallasTemperature(OneWire* _oneWire)
   devices = 0;
   parasite = false;
   conversionDelay = TEMP_9_BIT;
+  waitForConversion = true;
+  conversionStart = 0;
 }
 
 // initialize the bus
@@ -42,6 +44,7 @@ void DallasTemperature::begin(void)
       if (deviceAddress[0] == DS18S20MODEL) conversionDelay = TEMP_12_BIT; // 750 ms
       else if (scratchPad[CONFIGURATION] > conversionDelay) conversionDelay = scratchPad[CONFIGURATION];
 
+      if (devices < MAXDEVICES) memcpy(addresses[devices], deviceAddress, sizeof(DeviceAddress));
       devices++;
     }
   }
@@ -61,10 +64,17 @@ bool DallasTemperature::validAddress(uint8_t* deviceAddress)
 
 // finds an address at a given index on the bus
 // returns true if the device was found
+// the first MAXDEVICES addresses come from begin(), call begin() again after changing the bus
 bool DallasTemperature::getAddress(uint8_t* deviceAddress, uint8_t index)
 {
   uint8_t depth = 0;
 
+  if (index < devices && index < MAXDEVICES)
+  {
+    memcpy(deviceAddress, addresses[index], sizeof(DeviceAddress));
+    return true;
+  }
+
   _wire->reset_search();
 
   while (depth <= index && _wire->search(deviceAddress))
@@ -222,54 +232,63 @@ void DallasTemperature::setResolution(uint8_t* deviceAddress, uint8_t newResolut
   }
 }
 
-// sends command for all devices on the bus to perform a temperature
-void DallasTemperature::requestTemperatures(void)
+// sets whether the request functions wait for the conversion
+void DallasTemperature::setWaitForConversion(bool flag)
 {
-  _wire->reset();
-  _wire->skip();
-  _wire->write(STARTCONVO, parasite);
+  waitForConversion = flag;
+}
 
+bool DallasTemperature::getWaitForConversion(void)
+{
+  return waitForConversion;
+}
+
+// returns the conversion time in ms for the highest resolution on the bus
+int16_t DallasTemperature::millisToWaitForConversion(void)
+{
   switch (conversionDelay)
   {
     case TEMP_9_BIT:
-      delay(94);
-      break;
+      return 94;
     case TEMP_10_BIT:
-      delay(188);
-      break;
+      return 188;
     case TEMP_11_BIT:
-      delay(375);
-      break;
+      return 375;
     case TEMP_12_BIT:
     default:
-      delay(750);
-      break;
+      return 750;
   }
 }
 
+// returns true when the last requested conversion is done
+// without parasite power the devices read as 0 until they are done, so mostly we can
+// stop waiting before the worst case conversion time
+bool DallasTemperature::isConversionComplete(void)
+{
+  if (millis() - conversionStart >= (unsigned long)millisToWaitForConversion()) return true;
+  return !parasite && _wire->read_bit() == 1;
+}
+
+// sends command for all devices on the bus to perform a temperature
+void DallasTemperature::requestTemperatures(void)
+{
+  _wire->reset();
+  _wire->skip();
+  _wire->write(STARTCONVO, parasite);
+  conversionStart = millis();
+
+  if (waitForConversion) delay(millisToWaitForConversion());
+}
+
 // sends command for one device to perform a temperature by address
 void DallasTemperature::requestTemperaturesByAddress(uint8_t* deviceAddress)
 {
   _wire->reset();
   _wire->select(deviceAddress);
   _wire->write(STARTCONVO, parasite);
+  conversionStart = millis();
 
-  switch (conversionDelay)
-  {
-    case TEMP_9_BIT:
-      delay(94);
-      break;
-    case TEMP_10_BIT:
-      delay(188);
-      break;
-    case TEMP_11_BIT:
-      delay(375);
-      break;
-    case TEMP_12_BIT:
-    default:
-      delay(750);
-      break;
-  }
+  if (waitForConversion) delay(millisToWaitForConversion());
 }
 
 // sends command for one device to perform a temp conversion by index
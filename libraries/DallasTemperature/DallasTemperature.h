@@ -16,6 +16,12 @@
 #define REQUIRESALARMS false
 #endif
 
+// number of device addresses kept by begin(), 8 bytes each. getAddress() searches
+// the bus only for devices beyond these.
+#ifndef MAXDEVICES
+#define MAXDEVICES 8
+#endif
+
 // XXX mw12554 hack to compile for ESP8266 based on architecture
 #include <inttypes.h>
 #if defined(ARDUINO_ARCH_ESP8266)
@@ -76,7 +82,7 @@ class DallasTemperature
   // returns true if address is valid
   bool validAddress(uint8_t*);
 
-  // finds an address at a given index on the bus 
+  // finds an address at a given index on the bus, from the addresses found by begin()
   bool getAddress(uint8_t*, const uint8_t);
   
   // attempt to determine if the device at the given address is connected to the bus
@@ -101,6 +107,16 @@ class DallasTemperature
   // set resolution of a device to 9, 10, 11, or 12 bits
   void setResolution(uint8_t*, uint8_t);
 
+  // sets whether the request functions wait for the conversion (default), or return at once
+  void setWaitForConversion(bool);
+  bool getWaitForConversion(void);
+
+  // returns the time in ms a conversion takes at the highest resolution on the bus
+  int16_t millisToWaitForConversion(void);
+
+  // returns true when the last requested conversion is done and the temperatures can be read
+  bool isConversionComplete(void);
+
   // sends command for all devices on the bus to perform a temperature conversion
   void requestTemperatures(void);
    
@@ -196,6 +212,15 @@ class DallasTemperature
 
   // count of devices on the bus
   uint8_t devices;
+
+  // addresses of the first MAXDEVICES devices, found by begin()
+  DeviceAddress addresses[MAXDEVICES];
+
+  // wait in the request functions, or poll isConversionComplete()
+  bool waitForConversion;
+
+  // millis() when the last conversion was requested
+  unsigned long conversionStart;
   
   // Take a pointer to one wire instance
   OneWire* _wire;
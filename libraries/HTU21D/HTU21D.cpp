@@ -45,15 +45,33 @@ void HTU21D::begin(void)
 //Returns 998 if I2C timed out 
 //Returns 999 if CRC is wrong
 float HTU21D::readHumidity(void)
+{
+	startHumidity();
+
+	//Hang out while measurement is taken. 50mS max, page 4 of datasheet.
+	delay(HTU21D_HUMD_DELAY);
+
+	return collectHumidity();
+}
+
+//Start a humidity measurement
+/*******************************************************************************************/
+//The sensor does not hold the bus, so other devices can be used while it measures
+void HTU21D::startHumidity(void)
 {
 	//Request a humidity reading
 	Wire.beginTransmission(HTDU21D_ADDRESS);
 	Wire.write(TRIGGER_HUMD_MEASURE_NOHOLD); //Measure humidity with no bus holding
 	Wire.endTransmission();
+}
 
-	//Hang out while measurement is taken. 50mS max, page 4 of datasheet.
-	delay(55);
-
+//Collect the humidity
+/*******************************************************************************************/
+//Call HTU21D_HUMD_DELAY ms or more after startHumidity()
+//Returns 998 if I2C timed out 
+//Returns 999 if CRC is wrong
+float HTU21D::collectHumidity(void)
+{
 	//Comes back in three bytes, data(MSB) / data(LSB) / Checksum
 	Wire.requestFrom(HTDU21D_ADDRESS, 3);
 
@@ -97,15 +115,33 @@ float HTU21D::readHumidity(void)
 //Returns 998 if I2C timed out 
 //Returns 999 if CRC is wrong
 float HTU21D::readTemperature(void)
+{
+	startTemperature();
+
+	//Hang out while measurement is taken. 50mS max, page 4 of datasheet.
+	delay(HTU21D_TEMP_DELAY);
+
+	return collectTemperature();
+}
+
+//Start a temperature measurement
+/*******************************************************************************************/
+//The sensor does not hold the bus, so other devices can be used while it measures
+void HTU21D::startTemperature(void)
 {
 	//Request the temperature
 	Wire.beginTransmission(HTDU21D_ADDRESS);
 	Wire.write(TRIGGER_TEMP_MEASURE_NOHOLD);
 	Wire.endTransmission();
+}
 
-	//Hang out while measurement is taken. 50mS max, page 4 of datasheet.
-	delay(100); //Was 55
-
+//Collect the temperature
+/*******************************************************************************************/
+//Call HTU21D_TEMP_DELAY ms or more after startTemperature()
+//Returns 998 if I2C timed out 
+//Returns 999 if CRC is wrong
+float HTU21D::collectTemperature(void)
+{
 	//Comes back in three bytes, data(MSB) / data(LSB) / Checksum
 	Wire.requestFrom(HTDU21D_ADDRESS, 3);
 
@@ -22,6 +22,9 @@
 #define READ_USER_REG  0xE7
 #define SOFT_RESET  0xFE
 
+#define HTU21D_HUMD_DELAY 55	//ms from startHumidity() to collectHumidity(), 50mS max on page 4 of datasheet
+#define HTU21D_TEMP_DELAY 100	//ms from startTemperature() to collectTemperature(), was 55
+
 
 class HTU21D {
 
@@ -32,6 +35,12 @@ public:
   void begin();
   float readHumidity(void);
   float readTemperature(void);
+
+  //Split versions of the read functions, for doing other work while the sensor measures
+  void startHumidity(void);
+  float collectHumidity(void);
+  void startTemperature(void);
+  float collectTemperature(void);
   void setResolution(byte resBits);
 
   //Public Variables
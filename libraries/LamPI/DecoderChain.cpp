@@ -0,0 +1,317 @@
+/*
+ * DecoderChain library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See DecoderChain.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <DecoderChain.h>
+
+int8_t DecoderChain::_interrupt = -1;
+byte DecoderChain::_count = 0;
+byte DecoderChain::_codec[MAX_DECODERS];
+PulseHandler DecoderChain::_handler[MAX_DECODERS];
+byte DecoderChain::_run[MAX_DECODERS];
+volatile byte DecoderChain::_running = 0;
+volatile unsigned long DecoderChain::_decoding = 0;
+PulseHandler DecoderChain::_dispatch = NULL;
+PulseHandler DecoderChain::_capture = NULL;
+unsigned long DecoderChain::_lastEdge = 0;
+boolean DecoderChain::_deferred = false;
+volatile boolean DecoderChain::_inInterrupt = false;
+unsigned int DecoderChain::_pulses[PULSE_BUFSIZE];
+volatile byte DecoderChain::_head = 0;
+volatile byte DecoderChain::_tail = 0;
+volatile unsigned int DecoderChain::_overflows = 0;
+volatile byte DecoderChain::_highWater = 0;
+DecoderStatistics DecoderChain::_stats[MAX_DECODERS];
+boolean DecoderChain::_enabled = false;
+unsigned long DecoderChain::_disabledAt = 0;
+unsigned long DecoderChain::_maxDisabled = 0;
+unsigned long DecoderChain::_since = 0;
+volatile unsigned long DecoderChain::_edges = 0;
+volatile unsigned long DecoderChain::_isrSum = 0;
+volatile unsigned int DecoderChain::_isrMin = 0xFFFF;
+volatile unsigned int DecoderChain::_isrMax = 0;
+byte DecoderChain::_noise = 0;
+boolean DecoderChain::_squelched = false;
+volatile unsigned long DecoderChain::_squelchedPulses = 0;
+
+void DecoderChain::init(int8_t interrupt, boolean deferred) {
+	_interrupt = interrupt;
+	_deferred = deferred;
+	_tail = _head;
+	enable();
+}
+
+boolean DecoderChain::addDecoder(byte codec, PulseHandler handler) {
+	if (_count >= MAX_DECODERS) {
+		return false;
+	}
+	_codec[_count] = codec;
+	_handler[_count] = handler;
+	_stats[_count].codec = codec;
+	_stats[_count].decoded = 0;
+	_stats[_count].rejected = 0;
+	_stats[_count].duplicates = 0;
+	_stats[_count].suppressed = 0;
+	_stats[_count].micros = 0;
+	_stats[_count].calls = 0;
+	_stats[_count].maxMicros = 0;
+	_count++;
+	setDecoder(codec, true);
+	return true;
+}
+
+boolean DecoderChain::setDecoder(byte codec, boolean on) {
+	byte i;
+	for (i = 0; i < _count; i++) {
+		if (_codec[i] == codec) break;
+	}
+	if (i == _count) {
+		return false;
+	}
+
+	// Build the new table, in the order of addDecoder(), before the interrupt may see it.
+	unsigned long decoding = _decoding;
+	if (codec < 32) {
+		if (on) decoding |= 1UL << codec;
+		else decoding &= ~(1UL << codec);
+	}
+	byte run[MAX_DECODERS];
+	byte running = 0;
+	for (byte j = 0; j < _count; j++) {
+		if (j == i ? on : isDecoding(_codec[j])) {
+			run[running++] = j;
+		}
+	}
+	noInterrupts();
+	for (byte j = 0; j < running; j++) {
+		_run[j] = run[j];
+	}
+	_running = running;
+	_decoding = decoding;
+	interrupts();
+
+	if (_enabled) {
+		attach();
+	}
+	return true;
+}
+
+void DecoderChain::setDispatch(PulseHandler dispatch) {
+	noInterrupts();
+	_dispatch = dispatch;
+	interrupts();
+}
+
+void DecoderChain::setCapture(PulseHandler capture) {
+	noInterrupts();
+	_capture = capture;
+	interrupts();
+	if (_enabled) {
+		attach();
+	}
+}
+
+// Attach the interrupt only when there is something to decode or capture
+void DecoderChain::attach() {
+	if (_interrupt < 0) {
+		return;
+	}
+	if (_running > 0 || _capture != NULL) {
+		attachInterrupt(_interrupt, interruptHandler, CHANGE);
+	}
+	else {
+		detachInterrupt(_interrupt);
+	}
+}
+
+void DecoderChain::enable() {
+	if (_enabled) {
+		return;								// loop() calls enable() all the time
+	}
+	_enabled = true;
+	attach();
+#if DECODER_PROFILE > 0
+	unsigned long disabled = millis() - _disabledAt;
+	if (_disabledAt != 0 && disabled > _maxDisabled) {
+		_maxDisabled = disabled;
+	}
+#endif
+}
+
+void DecoderChain::disable() {
+	if (!_enabled) {
+		return;
+	}
+	_enabled = false;
+	if (_interrupt >= 0) {
+		detachInterrupt(_interrupt);
+	}
+#if DECODER_PROFILE > 0
+	_disabledAt = millis() | 1;				// 0 means never disabled
+#endif
+}
+
+void DecoderChain::interruptHandler() {
+	// One timestamp per edge, shared by all decoders.
+	unsigned long now = micros();
+	unsigned long duration = now - _lastEdge;
+	_lastEdge = now;
+
+	if (duration > 0xFFFF) {
+		duration = 0xFFFF;
+	}
+
+	if (_capture != NULL) {
+		_capture(duration);
+	}
+	else if (squelch(duration)) {
+		_squelchedPulses++;
+	}
+	else if (!_deferred) {
+		_inInterrupt = true;
+		handlePulse(duration);
+		_inInterrupt = false;
+	}
+	else {
+		bufferPulse(duration);
+	}
+
+#if DECODER_PROFILE > 0
+	unsigned int spent = micros() - now;
+	_edges++;
+	_isrSum += spent;
+	if (spent < _isrMin) _isrMin = spent;
+	if (spent > _isrMax) _isrMax = spent;
+#endif
+}
+
+// Returns true if the pulse must not be decoded
+boolean DecoderChain::squelch(unsigned int duration) {
+#if SQUELCH_ON > 0
+	if (duration < SQUELCH_SHORT) {
+		_noise = _noise > 255 - SQUELCH_UP ? 255 : _noise + SQUELCH_UP;
+		if (_noise > SQUELCH_ON) {
+			_squelched = true;
+		}
+	}
+	else if (_noise > 0) {
+		_noise--;
+	}
+
+	if (_squelched) {
+		if (duration >= SQUELCH_SYNC || _noise == 0) {
+			_squelched = false;				// Let the decoders see this pulse, it may be a sync
+			_noise = 0;
+			return false;
+		}
+		return true;
+	}
+#endif
+	return false;
+}
+
+void DecoderChain::bufferPulse(unsigned int duration) {
+	// Only the interrupt writes _head, so it is safe to use without locking.
+	byte head = _head;
+	byte next = (head + 1) & (PULSE_BUFSIZE - 1);
+	if (next == _tail) {
+		_overflows++;
+		return;
+	}
+	_pulses[head] = duration;
+	_head = next;
+
+	byte fill = (next - _tail) & (PULSE_BUFSIZE - 1);
+	if (fill > _highWater) {
+		_highWater = fill;
+	}
+}
+
+void DecoderChain::handlePulse(unsigned int duration) {
+	if (_dispatch != NULL) {
+		_dispatch(duration);
+		return;
+	}
+	for (byte j = 0; j < _running; j++) {
+		byte i = _run[j];
+#if DECODER_PROFILE > 1
+		unsigned long start = micros();
+		(_handler[i])(duration);
+		addMicros(_codec[i], micros() - start);
+#else
+		(_handler[i])(duration);
+#endif
+	}
+}
+
+void DecoderChain::process() {
+	byte tail = _tail;
+	while (tail != _head) {
+		handlePulse(_pulses[tail]);
+		tail = (tail + 1) & (PULSE_BUFSIZE - 1);
+		_tail = tail;
+	}
+}
+
+unsigned int DecoderChain::getOverflows() {
+	noInterrupts();
+	unsigned int overflows = _overflows;
+	interrupts();
+	return overflows;
+}
+
+byte DecoderChain::getHighWater() {
+	return _highWater;
+}
+
+boolean DecoderChain::getStatistics(byte index, DecoderStatistics &stats) {
+	if (index >= _count) {
+		return false;
+	}
+	noInterrupts();
+	stats = _stats[index];
+	interrupts();
+	return true;
+}
+
+void DecoderChain::getProfile(DecoderProfile &profile) {
+	noInterrupts();
+	profile.edges = _edges;
+	profile.isrMin = _edges > 0 ? _isrMin : 0;
+	profile.isrMax = _isrMax;
+	profile.isrAvg = _edges > 0 ? _isrSum / _edges : 0;
+	interrupts();
+	profile.elapsed = millis() - _since;
+	profile.maxDisabled = _maxDisabled;
+	noInterrupts();
+	profile.squelched = _squelchedPulses;
+	interrupts();
+}
+
+void DecoderChain::resetStatistics() {
+	noInterrupts();
+	_overflows = 0;
+	_highWater = 0;
+	_edges = 0;
+	_isrSum = 0;
+	_isrMin = 0xFFFF;
+	_isrMax = 0;
+	_squelchedPulses = 0;
+	for (byte i = 0; i < _count; i++) {
+		_stats[i].decoded = 0;
+		_stats[i].rejected = 0;
+		_stats[i].duplicates = 0;
+		_stats[i].suppressed = 0;
+		_stats[i].micros = 0;
+		_stats[i].calls = 0;
+		_stats[i].maxMicros = 0;
+	}
+	interrupts();
+	_maxDisabled = 0;
+	_since = millis();
+}
@@ -0,0 +1,291 @@
+/*
+ * DecoderChain library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * Based on the InterruptChain library made by Randy Simons http://randysimons.nl/
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef DecoderChain_h
+#define DecoderChain_h
+
+#include <Arduino.h>
+
+// Maximum number of decoders that can be attached to the chain. There are 7 receivers in the
+// library, so 8 leaves room for one more without wasting memory.
+#define MAX_DECODERS 8
+
+// Size of the pulse buffer used in deferred mode, must be a power of 2 and at most 256. Every entry
+// takes 2 bytes. A Kaku frame is 132 edges, but process() is normally called long before the
+// buffer is full.
+#ifndef PULSE_BUFSIZE
+#define PULSE_BUFSIZE 64
+#endif
+
+// Profiling of the decoders, see getProfile() and getStatistics().
+//  0: off
+//  1: time spent in interruptHandler() and number of edges, costs one micros() per edge
+//  2: also the time spent in every decoder, costs one micros() per decoder per edge
+#ifndef DECODER_PROFILE
+#define DECODER_PROFILE 1
+#endif
+
+// Squelch for the noise of the receiver when there is no carrier. Pulses shorter than
+// SQUELCH_SHORT microseconds are shorter than any symbol of the decoders. Every such pulse adds
+// SQUELCH_UP to a noise level, every other pulse takes 1 off. Above SQUELCH_ON the pulses are not
+// passed to the decoders, until a pulse of at least SQUELCH_SYNC microseconds (a plausible sync
+// gap) comes in or the noise level is back at 0. SQUELCH_ON 0 disables the squelch.
+#ifndef SQUELCH_ON
+#define SQUELCH_ON 64
+#endif
+#define SQUELCH_SHORT 60
+#define SQUELCH_UP 8
+#define SQUELCH_SYNC 2000
+
+// What happened to a frame, for countFrame()
+#define FRAME_DECODED 0					// Passed to the callback
+#define FRAME_REJECTED 1				// Given up after a valid start
+#define FRAME_DUPLICATE 2				// Complete, but a repeat of a frame that was passed already
+										// or not yet repeated often enough
+#define FRAME_SUPPRESSED 3				// Passed to the callback, but dropped by DupCache
+
+typedef void (*PulseHandler)(unsigned int);
+
+struct DecoderStatistics {
+	byte codec;
+	unsigned int decoded;
+	unsigned int rejected;
+	unsigned int duplicates;
+	unsigned int suppressed;			// Callbacks dropped by DupCache
+	unsigned long micros;				// Time spent in the decoder, DECODER_PROFILE 2 only
+	unsigned long calls;				// Pulses passed to the decoder, DECODER_PROFILE 2 only
+	unsigned int maxMicros;				// Longest call of the decoder, DECODER_PROFILE 2 only
+};
+
+struct DecoderProfile {
+	unsigned long edges;				// Edges seen by interruptHandler()
+	unsigned long elapsed;				// Milliseconds since the last resetStatistics()
+	unsigned int isrMin;				// Microseconds in interruptHandler()
+	unsigned int isrMax;
+	unsigned int isrAvg;
+	unsigned long maxDisabled;			// Longest time in milliseconds between disable() and enable()
+	unsigned long squelched;			// Pulses not decoded because of the squelch
+};
+
+/**
+* DecoderChain replaces the InterruptChain fan-out for the 433MHz receiver pin.
+*
+* With InterruptChain every edge walks a linked list and calls the interruptHandler() of every
+* receiver, and each of these reads micros() and keeps its own history of edge timestamps.
+* DecoderChain has one interrupt handler that timestamps the edge once, computes the pulse
+* duration once and passes it on to the handlePulse() function of every attached decoder, by
+* walking a flat table.
+*
+* Decoders are called in the order in which they were added. Put easy protocols first. A decoder
+* that is switched off with setDecoder() is taken out of the table that the interrupt walks, so a
+* protocol that is not used costs nothing, and it can be switched on again without reflashing.
+*
+* A cheap receiver outputs random edges when there is no carrier, and decoding these costs most
+* of the time of the interrupt. The squelch (see SQUELCH_ON) stops passing pulses to the decoders
+* while the receiver outputs this noise, with only a counter per edge.
+*
+* In deferred mode the interrupt handler does not decode at all, it only stores the pulse duration
+* in a ring buffer. The decoders, and with them the callbacks of the receivers, then run from loop()
+* when calling process(). This keeps the time spent in the interrupt short and constant, and a slow
+* callback (Serial, WiFi) can no longer make us miss edges. The buffer has one producer (the
+* interrupt) and one consumer (loop), so no locking is needed.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class DecoderChain {
+	public:
+		/**
+		* Attaches the chain to an interrupt. Interrupt mode is always CHANGE.
+		*
+		* @param interrupt The interrupt as is used by Arduino's attachInterrupt function.
+		*					If < 0, no interrupt is attached and you must call interruptHandler()
+		*					or handlePulse() yourself.
+		* @param deferred	If true, pulses are buffered by the interrupt handler and decoded by
+		*					process(). If false, pulses are decoded in the interrupt handler.
+		*/
+		static void init(int8_t interrupt, boolean deferred = false);
+
+		/**
+		* Adds a decoder to the chain.
+		*
+		* @param codec		Codec number of the decoder (KAKU, WT440 etc. See LamPI.h).
+		* @param handler	The handlePulse() function of the receiver, e.g. KakuReceiver::handlePulse
+		* @return false if the chain is full, true otherwise.
+		*/
+		static boolean addDecoder(byte codec, PulseHandler handler);
+
+		/**
+		* Switches a decoder on or off. The interrupt handler only calls the decoders that are on.
+		* Decoders are on after addDecoder(). When no decoder is on, the interrupt is detached.
+		*
+		* @param codec	Codec number as given to addDecoder().
+		* @param on		true to decode this codec, false to skip it.
+		* @return false if the codec is not in the chain.
+		*/
+		static boolean setDecoder(byte codec, boolean on);
+
+		/**
+		* @return true if the decoder of codec is in the chain and switched on.
+		*/
+		static boolean isDecoding(byte codec) {
+			return codec < 32 && ((_decoding >> codec) & 1);
+		}
+
+		/**
+		* Lets one function decode all pulses instead of walking the table of decoders. Used by
+		* DecoderSet, which calls its decoders directly. The decoders must still be added with
+		* addDecoder(), for setDecoder() and the statistics. NULL goes back to the table.
+		*/
+		static void setDispatch(PulseHandler dispatch);
+
+		/**
+		* Passes every pulse to capture instead of to the squelch and the decoders, also when no
+		* decoder is on. Used by PulseCapture. NULL decodes the pulses again.
+		*/
+		static void setCapture(PulseHandler capture);
+
+		/**
+		* Enables interrupt handling by DecoderChain. No need to call enable() after init().
+		*/
+		static void enable();
+
+		/**
+		* Disables interrupt handling by DecoderChain. Note that this is different from Arduino's
+		* noInterrupts(), which will disable _all_ interrupts on the CPU.
+		*/
+		static void disable();
+
+		/**
+		* Called every time the signal level changes (high to low or vice versa).
+		*/
+		static void interruptHandler();
+
+		/**
+		* Passes one pulse to all decoders in the chain.
+		*
+		* @param duration Duration of the pulse in microseconds.
+		*/
+		static void handlePulse(unsigned int duration);
+
+		/**
+		* Deferred mode only: decodes all pulses in the buffer. Call this from loop(), as often as
+		* possible. The receiver callbacks are called from here.
+		*/
+		static void process();
+
+		/**
+		* True while the interrupt handler decodes a pulse, so the receiver callbacks know they
+		* interrupted loop(). Always false in deferred mode.
+		*/
+		static boolean inInterrupt() {
+			return(_inInterrupt);
+		}
+
+		/**
+		* Number of pulses lost because the buffer was full, since the last resetStatistics().
+		*/
+		static unsigned int getOverflows();
+
+		/**
+		* Highest number of pulses in the buffer, since the last resetStatistics(). If this gets
+		* near PULSE_BUFSIZE, call process() more often or make the buffer larger.
+		*/
+		static byte getHighWater();
+
+		/**
+		* Called by the receivers when a frame is complete or given up.
+		*
+		* @param codec	Codec number of the receiver, as given to addDecoder().
+		* @param result	FRAME_DECODED, FRAME_REJECTED, FRAME_DUPLICATE or FRAME_SUPPRESSED
+		*/
+		static void countFrame(byte codec, byte result) {
+			for (byte i = 0; i < _count; i++) {
+				if (_codec[i] == codec) {
+					switch (result) {
+						case FRAME_DECODED: _stats[i].decoded++; break;
+						case FRAME_REJECTED: _stats[i].rejected++; break;
+						case FRAME_SUPPRESSED: _stats[i].suppressed++; break;
+						default: _stats[i].duplicates++;
+					}
+					return;
+				}
+			}
+		}
+
+		/**
+		* Adds the time of one call of a decoder to its statistics, DECODER_PROFILE 2 only. Called
+		* by the table walk of handlePulse() and by the decoders of a DecoderSet.
+		*
+		* @param codec	Codec number of the receiver, as given to addDecoder().
+		* @param us		Microseconds spent in its handlePulse().
+		*/
+		static void addMicros(byte codec, unsigned int us) {
+			for (byte i = 0; i < _count; i++) {
+				if (_codec[i] == codec) {
+					_stats[i].micros += us;
+					_stats[i].calls++;
+					if (us > _stats[i].maxMicros) _stats[i].maxMicros = us;
+					return;
+				}
+			}
+		}
+
+		/**
+		* Frame counters of decoder index (0 is the first decoder added).
+		*
+		* @return false if there is no decoder index.
+		*/
+		static boolean getStatistics(byte index, DecoderStatistics &stats);
+
+		/**
+		* Cost of the interrupt handler, edge count and longest disable() since the last
+		* resetStatistics(). All zero if DECODER_PROFILE is 0.
+		*/
+		static void getProfile(DecoderProfile &profile);
+
+		static void resetStatistics();
+
+	private:
+		static int8_t _interrupt;					// Radio input interrupt
+		static byte _count;							// Number of decoders in the chain
+		static byte _codec[MAX_DECODERS];			// Codec number for every decoder
+		static PulseHandler _handler[MAX_DECODERS];	// handlePulse() for every decoder
+		static byte _run[MAX_DECODERS];				// Index of the decoders that are on, in order
+		static volatile byte _running;				// Number of entries in _run
+		static volatile unsigned long _decoding;	// Bit per codec number of the decoders that are on
+		static PulseHandler _dispatch;				// Replaces the table walk if not NULL
+		static PulseHandler _capture;				// Gets the raw pulses if not NULL
+		static unsigned long _lastEdge;				// Timestamp of the previous edge
+		static boolean _deferred;
+		static volatile boolean _inInterrupt;		// Set around handlePulse() in interruptHandler()
+		static unsigned int _pulses[PULSE_BUFSIZE];	// Ring buffer with pulse durations
+		static volatile byte _head;					// Next free entry, written by interrupt only
+		static volatile byte _tail;					// Oldest entry, written by process() only
+		static volatile unsigned int _overflows;
+		static volatile byte _highWater;
+		static DecoderStatistics _stats[MAX_DECODERS];
+		static boolean _enabled;
+		static unsigned long _disabledAt;			// millis() of disable()
+		static unsigned long _maxDisabled;
+		static unsigned long _since;				// millis() of resetStatistics()
+		static volatile unsigned long _edges;
+		static volatile unsigned long _isrSum;		// Microseconds in interruptHandler()
+		static volatile unsigned int _isrMin;
+		static volatile unsigned int _isrMax;
+
+		static byte _noise;							// Noise level of the squelch
+		static boolean _squelched;
+		static volatile unsigned long _squelchedPulses;
+
+		static void attach();
+		static boolean squelch(unsigned int duration);
+		static void bufferPulse(unsigned int duration);
+};
+
+#endif
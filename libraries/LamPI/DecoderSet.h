@@ -0,0 +1,104 @@
+/*
+ * DecoderSet library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef DecoderSet_h
+#define DecoderSet_h
+
+#include <Arduino.h>
+#include <DecoderChain.h>
+
+/**
+* One decoder of a DecoderSet: the codec number and the handlePulse() function of a receiver.
+* With selected false the decoder is left out: it generates no code and does not reference the
+* receiver, so a sketch can use its 0/1 compile flags here instead of #if blocks.
+*
+* Example: Decoder<KAKU, KakuReceiver::handlePulse, R_KAKU>
+*/
+template <byte Codec, PulseHandler Handler, bool Selected = true>
+struct Decoder {
+	static inline void handlePulse(unsigned int duration) {
+		if (DecoderChain::isDecoding(Codec)) {
+#if DECODER_PROFILE > 1
+			unsigned long start = micros();
+			Handler(duration);
+			DecoderChain::addMicros(Codec, micros() - start);
+#else
+			Handler(duration);
+#endif
+		}
+	}
+	static inline void add() {
+		DecoderChain::addDecoder(Codec, Handler);
+	}
+};
+
+template <byte Codec, PulseHandler Handler>
+struct Decoder<Codec, Handler, false> {
+	static inline void handlePulse(unsigned int duration) {}
+	static inline void add() {}
+};
+
+/**
+* DecoderSet is the compile time version of the table of DecoderChain.
+*
+* The decoders are given as template arguments, in the order in which they are called:
+*
+*	typedef DecoderSet<
+*		Decoder<WT440, wt440Receiver::handlePulse, S_WT440>,
+*		Decoder<KAKU, KakuReceiver::handlePulse, R_KAKU>
+*	> Receivers;
+*	Receivers::attach();
+*
+* The compiler generates one handlePulse() that calls the receivers one after the other with
+* direct calls, instead of the indirect call per decoder of the table walk. attach() adds the
+* selected decoders to DecoderChain, so switching them on and off with setDecoder() and the
+* statistics work as before, and makes DecoderChain call this handlePulse() for every pulse.
+* The squelch, deferred mode and the profile of DecoderChain are not changed; with
+* DECODER_PROFILE 2 every decoder adds its time with DecoderChain::addMicros(), as the table
+* walk does.
+*
+* Requires C++11 (the Arduino IDE uses it since 1.6.6).
+*/
+template <class... Decoders>
+struct DecoderSet;
+
+template <>
+struct DecoderSet<> {
+	static inline void decode(unsigned int duration) {}
+	static inline void add() {}
+};
+
+template <class First, class... Rest>
+struct DecoderSet<First, Rest...> {
+	/**
+	* Passes one pulse to all decoders of the set that are switched on.
+	*/
+	static void handlePulse(unsigned int duration) {
+		decode(duration);
+	}
+
+	/**
+	* Adds the decoders to DecoderChain and lets it use handlePulse(). Call after DecoderChain::init().
+	*/
+	static void attach() {
+		add();
+		DecoderChain::setDispatch(handlePulse);
+	}
+
+	static inline void decode(unsigned int duration) {
+		First::handlePulse(duration);
+		DecoderSet<Rest...>::decode(duration);
+	}
+
+	static inline void add() {
+		First::add();
+		DecoderSet<Rest...>::add();
+	}
+};
+
+#endif
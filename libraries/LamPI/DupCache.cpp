@@ -0,0 +1,106 @@
+/*
+ * DupCache library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See DupCache.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <DupCache.h>
+#include <DecoderChain.h>
+#include <LamPI.h>
+
+DupCache::Entry DupCache::_entries[DUP_ENTRIES];
+byte DupCache::_window[DUP_CODECS];
+unsigned int DupCache::_suppressed = 0;
+
+void DupCache::init() {
+	for (byte i = 0; i < DUP_ENTRIES; i++) {
+		_entries[i].codec = 0xFF;			// No codec has this number
+	}
+	for (byte i = 0; i < DUP_CODECS; i++) {
+		_window[i] = DUP_WINDOW;
+	}
+	_suppressed = 0;
+}
+
+void DupCache::setWindow(byte codec, byte tenths) {
+	if (codec < DUP_CODECS) {
+		_window[codec] = tenths;
+	}
+}
+
+boolean DupCache::suppress(byte codec, unsigned long address, byte unit, long value) {
+	if (codec >= DUP_CODECS || _window[codec] == 0) {
+		return false;
+	}
+	unsigned long now = millis();
+	unsigned long window = _window[codec] * 100UL;
+
+	byte hash = codec ^ unit ^ (byte)address ^ (byte)(address >> 8) ^ (byte)(address >> 16)
+		^ (byte)(address >> 24);
+	Entry *oldest = NULL;
+	for (byte i = 0; i < DUP_PROBE; i++) {
+		Entry *e = &_entries[(hash + i) & (DUP_ENTRIES - 1)];
+		if (e->codec == codec && e->address == address && e->unit == unit) {
+			boolean repeat = e->value == value && now - e->seen < window;
+			e->value = value;
+			e->seen = now;
+			if (repeat) {
+				_suppressed++;
+				DecoderChain::countFrame(codec, FRAME_SUPPRESSED);
+			}
+			return repeat;
+		}
+		// Replace a free entry, or else the one seen longest ago
+		if (oldest == NULL || (oldest->codec != 0xFF && (e->codec == 0xFF || (long)(e->seen - oldest->seen) < 0))) {
+			oldest = e;
+		}
+	}
+
+	oldest->codec = codec;
+	oldest->address = address;
+	oldest->unit = unit;
+	oldest->value = value;
+	oldest->seen = now;
+	return false;
+}
+
+boolean DupCache::suppress(const KakuCode &code) {
+	return suppress(KAKU, code.address, code.groupBit ? 0xFF : code.unit,
+		((long)code.switchType << 8) | code.dimLevel);
+}
+
+boolean DupCache::suppress(const livoloCode &code) {
+	return suppress(LIVOLO, code.address, code.unit, code.level);
+}
+
+boolean DupCache::suppress(const kopouCode &code) {
+	return suppress(KOPOU, code.address, code.unit, code.level);
+}
+
+boolean DupCache::suppress(const quhwaCode &code) {
+	return suppress(QUHWA, code.address, code.unit, code.level);
+}
+
+boolean DupCache::suppress(const wt440Code &code) {
+	return suppress(WT440, code.address, code.channel | code.wconst << 2,
+		((long)code.temperature << 8) | code.humidity);
+}
+
+boolean DupCache::suppress(const auriolCode &code) {
+	return suppress(AURIOL, code.address, code.n1, code.temperature);
+}
+
+boolean DupCache::suppress(const OokCode &code) {
+	return suppress(code.codec, code.code, code.protocol, 0);
+}
+
+boolean DupCache::suppressAction(unsigned long code) {
+	return suppress(ACTION, code, 0, 0);
+}
+
+unsigned int DupCache::getSuppressed() {
+	return _suppressed;
+}
@@ -0,0 +1,107 @@
+/*
+ * DupCache library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef DupCache_h
+#define DupCache_h
+
+#include <Arduino.h>
+#include <kakuReceiver.h>
+#include <livoloReceiver.h>
+#include <kopouReceiver.h>
+#include <quhwaReceiver.h>
+#include <wt440Receiver.h>
+#include <auriolReceiver.h>
+#include <OokReceiver.h>
+
+// Number of units remembered, a power of 2. Every entry takes 14 bytes.
+#ifndef DUP_ENTRIES
+#define DUP_ENTRIES 8
+#endif
+
+#define DUP_PROBE 4					// Entries looked at, from the hashed position on
+#define DUP_WINDOW 10				// Default suppression window, in 0.1 s
+#define DUP_CODECS 32				// Codec numbers 0-31 (see LamPI.h) can have their own window
+
+/**
+* DupCache drops messages that were already reported a moment ago, across all codecs.
+*
+* A handset button that is held down sends its code over and over, and every receiver passes
+* each repeat to its callback once it has seen minRepeats of them. The callbacks of the gateway
+* ask suppress() first, so the button gives one Serial line or one message to the daemon.
+*
+* An entry is kept per (codec, address, unit) with the last value of that unit. A message is
+* suppressed when its value equals the last value and the unit was seen less than the window of
+* its codec ago. Every suppressed repeat restarts the window, so a button is reported again only
+* after it was released for a whole window. A new value is always reported: on, off and on
+* again within the window gives three messages.
+*
+* The cache is a small table; the key is hashed to the first of DUP_PROBE entries that are
+* searched. When the key is not found, the oldest of these entries is replaced.
+*
+* The callbacks of the receivers use the suppress() for their code, so the gateways and the
+* host tools build the key of a codec in the same way.
+*
+* Suppressed messages are counted per codec in the statistics of DecoderChain.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class DupCache {
+	public:
+		/**
+		* Clears the cache and sets the window of all codecs to DUP_WINDOW.
+		*/
+		static void init();
+
+		/**
+		* Sets the suppression window of one codec.
+		*
+		* @param codec	Codec number (KAKU, WT440 etc. See LamPI.h).
+		* @param tenths	Window in 0.1 s, at most 25.5 s. 0 never suppresses this codec.
+		*/
+		static void setWindow(byte codec, byte tenths);
+
+		/**
+		* Remembers the value of a unit and tells whether the message must be dropped.
+		*
+		* @return true if the unit was seen with the same value within the window of its codec.
+		*/
+		static boolean suppress(byte codec, unsigned long address, byte unit, long value);
+
+		/**
+		* suppress() with the key and value of the code of a receiver. A group command of KAKU is
+		* unit 0xFF, a WT440 is one unit per channel and message type.
+		*/
+		static boolean suppress(const KakuCode &code);
+		static boolean suppress(const livoloCode &code);
+		static boolean suppress(const kopouCode &code);
+		static boolean suppress(const quhwaCode &code);
+		static boolean suppress(const wt440Code &code);
+		static boolean suppress(const auriolCode &code);
+		static boolean suppress(const OokCode &code);
+		static boolean suppressAction(unsigned long code);
+
+		/**
+		* Number of messages dropped since init().
+		*/
+		static unsigned int getSuppressed();
+
+	private:
+		struct Entry {
+			unsigned long address;
+			long value;
+			unsigned long seen;				// millis() of the last time the message came in
+			byte codec;
+			byte unit;
+		};
+
+		static Entry _entries[DUP_ENTRIES];
+		static byte _window[DUP_CODECS];
+		static unsigned int _suppressed;
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * FrameCache library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See FrameCache.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <FrameCache.h>
+
+FrameCache::Entry FrameCache::_entries[TX_CACHE];
+unsigned int FrameCache::_clock = 0;
+unsigned int FrameCache::_hits = 0;
+unsigned int FrameCache::_misses = 0;
+
+boolean FrameCache::get(byte codec, unsigned long gaddr, byte uaddr, int value, PulseFrame *&frame) {
+	if (++_clock == 0) {
+		clear();								// The times of use would no longer compare
+		_clock = 1;
+	}
+
+	Entry *oldest = &_entries[0];
+	for (byte i = 0; i < TX_CACHE; i++) {
+		Entry *e = &_entries[i];
+		if (e->used > 0 && e->codec == codec && e->gaddr == gaddr && e->uaddr == uaddr && e->value == value) {
+			e->used = _clock;
+			frame = &e->frame;
+			_hits++;
+			return true;
+		}
+		if (e->used < oldest->used) {
+			oldest = e;
+		}
+	}
+
+	oldest->codec = codec;
+	oldest->gaddr = gaddr;
+	oldest->uaddr = uaddr;
+	oldest->value = value;
+	oldest->used = _clock;
+	frame = &oldest->frame;
+	_misses++;
+	return false;
+}
+
+void FrameCache::clear() {
+	for (byte i = 0; i < TX_CACHE; i++) {
+		_entries[i].used = 0;
+	}
+}
+
+unsigned int FrameCache::getHits() {
+	return _hits;
+}
+
+unsigned int FrameCache::getMisses() {
+	return _misses;
+}
+
+void FrameCache::resetStatistics() {
+	_hits = 0;
+	_misses = 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * FrameCache library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef FrameCache_h
+#define FrameCache_h
+
+#include <Arduino.h>
+#include <PulseTransmitter.h>
+
+// Number of compiled frames kept. Every entry takes about 60 bytes.
+#ifndef TX_CACHE
+#define TX_CACHE 8
+#endif
+
+/**
+* FrameCache keeps the compiled frames of the last TX_CACHE commands, so a command that is sent
+* again (a scene, a light that is switched on and off every evening) is not compiled again.
+* A command is identified by (codec, gaddr, uaddr, value), value is whatever tells the commands
+* of a device apart, e.g. off, on and the dim level. When the cache is full the least recently
+* used frame is replaced.
+*
+* The frame of a command must not depend on anything else: use one transmitter setup (pin,
+* period, repeats) per codec, or call clear() after changing it.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class FrameCache {
+	public:
+		/**
+		* Looks up the frame of a command.
+		*
+		* @param frame	On a hit, set to the cached frame. On a miss, set to the least recently
+		*				used entry, which now belongs to this command: the caller must compile
+		*				the frame into it before the next call.
+		* @return true on a hit.
+		*/
+		static boolean get(byte codec, unsigned long gaddr, byte uaddr, int value, PulseFrame *&frame);
+
+		/**
+		* Forgets all frames.
+		*/
+		static void clear();
+
+		/**
+		* Number of lookups that found, and did not find the frame, since the last
+		* resetStatistics().
+		*/
+		static unsigned int getHits();
+		static unsigned int getMisses();
+		static void resetStatistics();
+
+	private:
+		struct Entry {
+			byte codec;
+			byte uaddr;
+			int value;
+			unsigned long gaddr;
+			unsigned int used;					// Time of last use, 0 if the entry is free
+			PulseFrame frame;
+		};
+
+		static Entry _entries[TX_CACHE];
+		static unsigned int _clock;				// Counts the lookups
+		static unsigned int _hits;
+		static unsigned int _misses;
+};
+
+#endif
@@ -0,0 +1,491 @@
+/*
+ * HostLink library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See HostLink.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <HostLink.h>
+
+// Short critical sections that also work inside an interrupt: the interrupt state is
+// restored instead of interrupts being enabled.
+#if defined(__AVR__)
+#define LINK_LOCK() uint8_t savedState = SREG; cli()
+#define LINK_UNLOCK() SREG = savedState
+#elif defined(ESP8266)
+#define LINK_LOCK() uint32_t savedState = xt_rsil(15)
+#define LINK_UNLOCK() xt_wsr_ps(savedState)
+#else
+#define LINK_LOCK()
+#define LINK_UNLOCK()
+#endif
+
+#define LINK_NONE 0xFF
+
+HostLink::HostLink(Stream &stream) : _stream(stream) {
+	_binary = false;
+	_sequence = 0;
+	_rxLen = 0;
+	_rxOverflow = false;
+	_errors = 0;
+	for (byte i = 0; i < LINK_LINES; i++) {
+		_next[i] = i + 1 < LINK_LINES ? i + 1 : LINK_NONE;
+	}
+	_free = 0;
+	_head = LINK_NONE;
+	_tail = LINK_NONE;
+	_sent = 0;
+	_outLen = 0;
+	_outSent = 0;
+	_depth = 0;
+	_queued = false;
+	_used = 0;
+	_dropped = 0;
+	_high = 0;
+}
+
+void HostLink::setBinary(boolean binary) {
+	if (_depth == 1 && _message[0].implicit) {
+		close();									// The text of an unfinished line
+	}
+	flush();
+	_binary = binary;
+	_rxLen = 0;
+	_rxOverflow = false;
+}
+
+boolean HostLink::isBinary() {
+	return _binary;
+}
+
+void HostLink::setQueue(boolean queue) {
+	if (!queue) {
+		flush();
+	}
+	_queued = queue;
+}
+
+void HostLink::open() {
+	LINK_LOCK();
+	if (_depth < LINK_DEPTH) {
+		Message &m = _message[_depth];
+		m.first = LINK_NONE;
+		m.last = LINK_NONE;
+		m.frame = LINK_NONE;
+		m.implicit = false;
+		m.dropping = false;
+	}
+	_depth++;
+	LINK_UNLOCK();
+}
+
+void HostLink::close() {
+	if (_depth == 0) {
+		return;
+	}
+	if (_depth <= LINK_DEPTH) {
+		Message &m = _message[_depth - 1];
+		end(m);										// The text of an unfinished line
+		commit(m);
+	}
+	LINK_LOCK();
+	if (_depth > LINK_DEPTH) _dropped++;			// Nested too deep, nothing was kept
+	_depth--;
+	LINK_UNLOCK();
+	if (!_queued) {
+		drain();
+	}
+}
+
+void HostLink::process(int room) {
+	while (room > 0) {
+		if (_outSent < _outLen) {
+			int n = _outLen - _outSent;
+			if (n > room) n = room;
+			_stream.write(_out + _outSent, n);
+			_outSent += n;
+			room -= n;
+			continue;
+		}
+		byte line = _head;
+		if (line == LINK_NONE) {
+			return;
+		}
+		if (_sent < _len[line]) {
+			if (_binary) {
+				encodeFrame(line);
+			}
+			else {
+				int n = _len[line] - _sent;
+				if (n > room) n = room;
+				_stream.write(_data[line] + _sent, n);
+				_sent += n;
+				room -= n;
+			}
+			continue;
+		}
+		LINK_LOCK();									// A callback may be queueing after it
+		_head = _next[line];
+		_next[line] = _free;
+		_free = line;
+		_used--;
+		LINK_UNLOCK();
+		_sent = 0;
+	}
+}
+
+void HostLink::flush() {
+	drain();
+	_stream.flush();
+}
+
+unsigned int HostLink::getDropped() {
+	LINK_LOCK();
+	unsigned int dropped = _dropped;
+	LINK_UNLOCK();
+	return dropped;
+}
+
+byte HostLink::getHighWater() {
+	return _high;
+}
+
+void HostLink::resetStatistics() {
+	LINK_LOCK();
+	_dropped = 0;
+	_high = _used;
+	LINK_UNLOCK();
+}
+
+size_t HostLink::write(uint8_t c) {
+	if (!_binary && !_queued) {
+		return _stream.write(c);
+	}
+	Message *m = message();
+	if (m == NULL) {
+		return 1;										// Nested too deep, dropped at close()
+	}
+	if (!_binary) {
+		put(*m, c);
+	}
+	else if (c == '\n') {
+		end(*m);
+	}
+	else if (c != '\r') {
+		if (m->frame == LINK_NONE) begin(*m, LINK_TEXT, LINK_FRAME);
+		put(*m, c);
+		if (m->frame != LINK_NONE && _len[m->last] - m->frame - 2 == LINK_FRAME) end(*m);
+	}
+	if (c == '\n' && m->implicit) {
+		close();
+	}
+	return 1;
+}
+
+size_t HostLink::write(const uint8_t *buffer, size_t size) {
+	if (!_binary && !_queued) {
+		return _stream.write(buffer, size);
+	}
+	for (size_t i = 0; i < size; i++) {
+		write(buffer[i]);
+	}
+	return size;
+}
+
+size_t HostLink::printFixed(long value, byte decimals) {
+	size_t n = 0;
+	if (value < 0) {
+		n += print('-');
+		value = -value;
+	}
+	long scale = 1;
+	for (byte i = 0; i < decimals; i++) {
+		scale *= 10;
+	}
+	n += print(value / scale);
+	if (decimals > 0) {
+		long fraction = value % scale;
+		n += print('.');
+		for (long s = scale / 10; s > 1 && fraction < s; s /= 10) {
+			n += print('0');							// Leading zeros of the fraction
+		}
+		n += print(fraction);
+	}
+	return n;
+}
+
+void HostLink::sendDevice(byte codec, unsigned long address, byte unit, int value) {
+	Message *m = message();
+	if (m == NULL) {
+		return;
+	}
+	begin(*m, LINK_DEVICE, 8);
+	put(*m, codec);
+	put32(*m, address);
+	put(*m, unit);
+	put16(*m, value);
+	end(*m);
+	if (m->implicit) {
+		close();
+	}
+}
+
+void HostLink::sendSensor(byte codec, byte type, unsigned int address, byte channel,
+						long value0, long value1, byte decimals) {
+	Message *m = message();
+	if (m == NULL) {
+		return;
+	}
+	begin(*m, LINK_SENSOR, 14);
+	put(*m, codec);
+	put(*m, type);
+	put16(*m, address);
+	put(*m, channel);
+	put(*m, decimals);
+	put32(*m, value0);
+	put32(*m, value1);
+	end(*m);
+	if (m->implicit) {
+		close();
+	}
+}
+
+void HostLink::sendDallas(const byte *rom, int temperature) {
+	Message *m = message();
+	if (m == NULL) {
+		return;
+	}
+	begin(*m, LINK_DALLAS, 9);
+	for (byte i = 0; i < 7; i++) {
+		put(*m, rom[i]);
+	}
+	put16(*m, temperature);
+	end(*m);
+	if (m->implicit) {
+		close();
+	}
+}
+
+void HostLink::sendAdmin(byte command, unsigned long value) {
+	Message *m = message();
+	if (m == NULL) {
+		return;
+	}
+	begin(*m, LINK_ADMIN, 5);
+	put(*m, command);
+	put32(*m, value);
+	end(*m);
+	if (m->implicit) {
+		close();
+	}
+}
+
+boolean HostLink::receive(byte b, char *line, byte size) {
+	if (b != 0) {
+		if (_rxLen < sizeof(_rx)) _rx[_rxLen++] = b;
+		else _rxOverflow = true;
+		return false;
+	}
+	byte len = _rxLen;
+	boolean overflow = _rxOverflow;
+	_rxLen = 0;
+	_rxOverflow = false;
+	if (len == 0) {
+		return false;								// A 0 byte only, sent by the daemon to start clean
+	}
+
+	int n = overflow ? -1 : decode(_rx, len, _rx);
+	if (n < 4 || crc16(_rx, n - 2) != (_rx[n - 2] | (unsigned int)_rx[n - 1] << 8) || _rx[0] != LINK_COMMAND) {
+		_errors++;
+		return false;
+	}
+	n -= 4;											// Type, sequence and CRC
+	if (n >= size) n = size - 1;
+	memcpy(line, _rx + 2, n);
+	line[n] = '\0';
+	return true;
+}
+
+unsigned int HostLink::getErrors() {
+	return _errors;
+}
+
+byte HostLink::encode(const byte *in, byte len, byte *out) {
+	byte n = 0;
+	byte start = 0;
+	for (byte i = 0; i <= len; i++) {
+		if (i == len || in[i] == 0) {
+			out[n++] = i - start + 1;
+			for (byte j = start; j < i; j++) {
+				out[n++] = in[j];
+			}
+			start = i + 1;
+		}
+	}
+	return n;
+}
+
+int HostLink::decode(const byte *in, byte len, byte *out) {
+	byte n = 0;
+	byte i = 0;
+	while (i < len) {
+		byte code = in[i++];
+		if (code == 0 || i + code - 1 > len) {
+			return -1;
+		}
+		for (byte j = 1; j < code; j++) {
+			out[n++] = in[i++];
+		}
+		if (code < 0xFF && i < len) {
+			out[n++] = 0;
+		}
+	}
+	return n;
+}
+
+unsigned int HostLink::crc16(const byte *buf, byte len) {
+	unsigned int crc = 0xFFFF;
+	while (len--) {
+		crc ^= (unsigned int)*buf++ << 8;
+		for (byte i = 0; i < 8; i++) {
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc & 0xFFFF;
+}
+
+// The message of the innermost caller, a new one if there is none. NULL if nested too deep.
+HostLink::Message *HostLink::message() {
+	if (_depth == 0) {
+		open();
+		_message[0].implicit = true;
+	}
+	return _depth <= LINK_DEPTH ? &_message[_depth - 1] : NULL;
+}
+
+// Adds a free line to the message, or drops the message if there is none
+boolean HostLink::take(Message &m) {
+	LINK_LOCK();
+	byte line = _free;
+	if (line != LINK_NONE) {
+		_free = _next[line];
+		_used++;
+		if (_used > _high) _high = _used;
+	}
+	LINK_UNLOCK();
+	if (line == LINK_NONE) {
+		drop(m);
+		return false;
+	}
+	_len[line] = 0;
+	_next[line] = LINK_NONE;
+	if (m.first == LINK_NONE) m.first = line;
+	else _next[m.last] = line;
+	m.last = line;
+	return true;
+}
+
+// Frees the lines of the message, the rest of it is ignored until it is queued
+void HostLink::drop(Message &m) {
+	while (m.first != LINK_NONE) {
+		byte line = m.first;
+		m.first = _next[line];
+		LINK_LOCK();
+		_next[line] = _free;
+		_free = line;
+		_used--;
+		LINK_UNLOCK();
+	}
+	m.last = LINK_NONE;
+	m.frame = LINK_NONE;
+	m.dropping = true;
+}
+
+// Queues the lines of the message, after the messages that were queued before
+void HostLink::commit(Message &m) {
+	LINK_LOCK();
+	if (m.dropping) {
+		_dropped++;
+	}
+	else if (m.first != LINK_NONE) {
+		if (_head == LINK_NONE) _head = m.first;
+		else _next[_tail] = m.first;
+		_tail = m.last;
+	}
+	LINK_UNLOCK();
+	m.first = LINK_NONE;
+	m.last = LINK_NONE;
+	m.frame = LINK_NONE;
+	m.dropping = false;
+}
+
+void HostLink::drain() {
+	while (_head != LINK_NONE || _outSent < _outLen) {
+		process(sizeof(_out));
+	}
+}
+
+// Starts a frame of at most size bytes of payload, in the line being written if it has room
+void HostLink::begin(Message &m, byte type, byte size) {
+	end(m);											// The text of an unfinished line goes first
+	if (m.dropping) {
+		return;
+	}
+	if (m.last == LINK_NONE || LINK_LINE - _len[m.last] < size + 2) {
+		if (!take(m)) return;
+	}
+	m.frame = _len[m.last];
+	put(m, 0);										// Length of type and payload, set by end()
+	put(m, type);
+}
+
+void HostLink::put(Message &m, byte b) {
+	if (m.dropping) {
+		return;
+	}
+	if (m.last == LINK_NONE || _len[m.last] == LINK_LINE) {
+		if (!take(m)) return;
+	}
+	_data[m.last][_len[m.last]++] = b;
+}
+
+void HostLink::put16(Message &m, unsigned int v) {
+	put(m, v & 0xFF);
+	put(m, v >> 8);
+}
+
+void HostLink::put32(Message &m, unsigned long v) {
+	put16(m, v & 0xFFFF);
+	put16(m, v >> 16);
+}
+
+void HostLink::end(Message &m) {
+	if (m.frame == LINK_NONE) {
+		return;
+	}
+	_data[m.last][m.frame] = _len[m.last] - m.frame - 1;
+	m.frame = LINK_NONE;
+	if (!_queued) {
+		commit(m);									// Direct output: every frame at once
+		drain();
+	}
+}
+
+// Encodes the next frame of the line into _out, with the sequence number and the CRC
+void HostLink::encodeFrame(byte line) {
+	const byte *f = _data[line] + _sent;
+	byte len = f[0];
+	byte frame[LINK_FRAME + 4];
+	frame[0] = f[1];
+	frame[1] = _sequence++;
+	memcpy(frame + 2, f + 2, len - 1);
+	unsigned int crc = crc16(frame, len + 1);
+	frame[len + 1] = crc & 0xFF;
+	frame[len + 2] = crc >> 8;
+	_outLen = encode(frame, len + 3, _out);
+	_out[_outLen++] = 0;
+	_outSent = 0;
+	_sent += len + 1;
+}
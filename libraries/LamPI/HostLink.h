@@ -0,0 +1,247 @@
+/*
+ * HostLink library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef HostLink_h
+#define HostLink_h
+
+#include <Arduino.h>
+
+// Largest payload of a frame. A longer line of text is sent in more frames, a longer command is
+// dropped. Every byte takes 2 bytes of RAM.
+#ifndef LINK_FRAME
+#define LINK_FRAME 32
+#endif
+
+// Lines of the output queue and their size, every line takes LINK_LINE + 2 bytes of RAM. Every
+// message is built in lines of its own, a line holds a text line or a few records. See open().
+#ifndef LINK_LINES
+#define LINK_LINES 4
+#endif
+#ifndef LINK_LINE
+#define LINK_LINE 40
+#endif
+
+// Messages that can be built at the same time: one of loop() and one of the decoder callback that
+// interrupts it. Every level takes 5 bytes of RAM.
+#ifndef LINK_DEPTH
+#define LINK_DEPTH 2
+#endif
+
+#if LINK_LINE < LINK_FRAME + 2
+#error "LINK_LINE must hold a frame of LINK_FRAME bytes"
+#endif
+
+// Frame types
+#define LINK_TEXT 0					// A line of text (reply, debug), without end of line
+#define LINK_COMMAND 1				// Host to gateway: a command line as in text mode, "> 1 0 4"
+#define LINK_DEVICE 2				// codec, address (4), unit, value (2)
+#define LINK_SENSOR 3				// codec, type, address (2), channel, decimals, value0 (4), value1 (4)
+#define LINK_DALLAS 4				// rom (7, without the CRC), temperature in tenths (2)
+#define LINK_ADMIN 5				// admin command, value (4)
+
+// LINK_DEVICE unit and value
+#define LINK_GROUP 0xFF				// Unit of a group command
+#define LINK_ON -1					// Value of on without a dim level
+#define LINK_DIM -2					// Value of dim without a dim level
+
+/**
+* HostLink carries the messages of the gateway to the daemon, and its commands back, in text
+* lines (the protocol of LamPI) or in binary frames.
+*
+* In text mode everything printed to HostLink goes to the stream unchanged. In binary mode every
+* message is a frame: a type, a sequence number, the payload and a CRC16 (CCITT, 0x1021, start
+* 0xFFFF, low byte first), encoded with COBS so the frame holds no 0 byte, and a 0 byte after it.
+* The records have a fixed layout, numbers are little endian. Text that is printed, such as the
+* replies of admin commands and debug output, is sent as LINK_TEXT frames, one per line.
+* The frames are built in the lines of their message (see open()), so a callback that sends a
+* record while loop() is in the middle of a frame does not end that frame. The sequence number
+* and CRC are added by process(), in the order the frames are sent.
+*
+* A corrupted frame fails the CRC and is dropped, the receiver finds the next frame at the next
+* 0 byte. A lost frame shows as a gap in the sequence numbers. A frame is 4 to 6 bytes longer
+* than its payload, a sensor message takes 20 bytes instead of 25 to 36 as text.
+*
+* The gateway starts in text mode, the daemon asks for binary mode with command "> 1 0 10 1",
+* the reply is the last text line. See extras/host/linkdump for a decoder.
+*
+* With setQueue(true) nothing is written to the stream directly: every message is built in lines
+* of the queue of its own, and queued whole when it is complete. process() writes as much of the
+* queue as the stream takes without waiting, so a decoder callback that runs in the interrupt
+* never waits for Serial. A message for which no line is free is dropped whole, see getDropped().
+*
+* A message is what is printed or sent between open() and close(). Output without open() is a
+* message of its own that ends at the end of the line, or of the record. A decoder callback that
+* interrupts loop() while it prints must use open() and close(), so its message is built apart
+* and queued before the one of loop(), instead of in the middle of it. The lines are taken and
+* queued with interrupts disabled, so open(), close() and the output may be used from both.
+*/
+class HostLink : public Print {
+	public:
+		HostLink(Stream &stream);
+
+		/**
+		* Switches to binary frames (true) or text lines (false).
+		*/
+		void setBinary(boolean binary);
+		boolean isBinary();
+
+		/**
+		* Queues the output (true), or writes it to the stream directly (false). Switching to
+		* direct output first writes what is queued.
+		*/
+		void setQueue(boolean queue);
+
+		/**
+		* Start and end of a message, e.g. all output of one decoder callback. The message is
+		* queued at close(). Messages nest up to LINK_DEPTH deep, a deeper one is dropped.
+		*/
+		void open();
+		void close();
+
+		/**
+		* Writes queued messages, at most room bytes, e.g. Serial.availableForWrite(). In binary
+		* mode the frames get their sequence number here, in the order they are sent. Call from
+		* loop().
+		*/
+		void process(int room);
+
+		/**
+		* Writes everything that is queued, waiting for the stream.
+		*/
+		void flush();
+
+		/**
+		* Number of messages dropped because the queue was full or the messages nested too deep,
+		* and the highest number of lines in use, since the last resetStatistics().
+		*/
+		unsigned int getDropped();
+		byte getHighWater();
+		void resetStatistics();
+
+		/**
+		* Print. In binary mode the text of a line is collected in a LINK_TEXT frame that is sent at
+		* the end of the line or when it is full. '\r' is left out.
+		*/
+		virtual size_t write(uint8_t c);
+		virtual size_t write(const uint8_t *buffer, size_t size);
+		using Print::write;
+
+		/**
+		* Prints value / 10^decimals with the given decimals, e.g. 215 and 1 as 21.5, without
+		* the float arithmetic of print(double).
+		*/
+		size_t printFixed(long value, byte decimals);
+
+		/**
+		* Sends a record. Binary mode only.
+		*/
+		void sendDevice(byte codec, unsigned long address, byte unit, int value);
+		void sendSensor(byte codec, byte type, unsigned int address, byte channel,
+						long value0, long value1, byte decimals);
+		void sendDallas(const byte *rom, int temperature);
+		void sendAdmin(byte command, unsigned long value);
+
+		/**
+		* Takes a byte received in binary mode.
+		*
+		* @param line	Set to the command of a LINK_COMMAND frame, 0 terminated
+		* @return true when line holds a command.
+		*/
+		boolean receive(byte b, char *line, byte size);
+
+		/**
+		* Number of frames received that were corrupted, too long or of an unknown type.
+		*/
+		unsigned int getErrors();
+
+		/**
+		* COBS encoding of a frame of at most 253 bytes, without the 0 byte after it. out must
+		* have room for len + 1 bytes.
+		*
+		* @return the length of the encoded frame.
+		*/
+		static byte encode(const byte *in, byte len, byte *out);
+
+		/**
+		* COBS decoding of a frame without the 0 byte after it. in and out may be the same.
+		*
+		* @return the length of the decoded frame, -1 if it is not valid COBS.
+		*/
+		static int decode(const byte *in, byte len, byte *out);
+
+		static unsigned int crc16(const byte *buf, byte len);
+
+	private:
+		struct Message {
+			byte first;					// First line, LINK_NONE if none yet
+			byte last;					// Line being written
+			byte frame;					// Offset in last of the open frame, LINK_NONE if none
+			boolean implicit;			// Opened by the output, ends with the line or the record
+			boolean dropping;			// No line was free, the message is dropped
+		};
+
+		Stream &_stream;
+		boolean _binary;
+		byte _sequence;
+		byte _rx[LINK_FRAME + 5];		// Encoded frame being received
+		byte _rxLen;
+		boolean _rxOverflow;
+		unsigned int _errors;
+		byte _data[LINK_LINES][LINK_LINE];	// Text, or frames as length, type and payload
+		byte _len[LINK_LINES];
+		byte _next[LINK_LINES];			// Next line of the message, of the queue or of the free lines
+		byte _free;						// First free line
+		volatile byte _head;			// First queued line, LINK_NONE if none
+		byte _tail;						// Last queued line
+		byte _sent;						// Bytes of _head written, or encoded into _out
+		byte _out[LINK_FRAME + 6];		// Encoded frame being written
+		byte _outLen;
+		byte _outSent;
+		Message _message[LINK_DEPTH];	// Messages being built, the last one by the innermost caller
+		volatile byte _depth;
+		boolean _queued;
+		byte _used;
+		unsigned int _dropped;
+		byte _high;
+
+		Message *message();
+		boolean take(Message &m);
+		void drop(Message &m);
+		void commit(Message &m);
+		void drain();
+		void begin(Message &m, byte type, byte size);
+		void put(Message &m, byte b);
+		void put16(Message &m, unsigned int v);
+		void put32(Message &m, unsigned long v);
+		void end(Message &m);
+		void encodeFrame(byte line);
+};
+
+/**
+* Keeps all output of a scope in one message: open() in the constructor, close() in the
+* destructor. For the decoder callbacks, e.g.
+*
+*	void showKakuCode(KakuCode receivedCode) {
+*		HostMessage message(Host);
+*		...
+*	}
+*/
+class HostMessage {
+	public:
+		HostMessage(HostLink &link) : _link(link) {
+			_link.open();
+		}
+		~HostMessage() {
+			_link.close();
+		}
+
+	private:
+		HostLink &_link;
+};
+
+#endif
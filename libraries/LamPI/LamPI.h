@@ -31,6 +31,7 @@
 #define AURIOL 19
 #define LAMPI 20
 #define CRESTA 21
+#define OOK 22				// Generic decoder, the protocols are in the table of OokReceiver
 
 // Analog Pin:
 //		 0: The ADC analog(!) pin for measuring battery 
@@ -50,6 +50,7 @@
 #define AURIOL 19
 #define LAMPI 20
 #define CRESTA 21
+#define OOK 22				// Generic decoder, the protocols are in the table of OokReceiver
 // Until 24
 
 // Codecs
@@ -0,0 +1,194 @@
+/*
+ * OokReceiver library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See OokReceiver.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <OokReceiver.h>
+#include <DecoderChain.h>
+#include <LamPI.h>
+
+#define OOK_IDLE 0xFF					// Waiting for a sync
+#define OOK_NONE OOK_CLASSES			// Pulse fits no width
+#define OOK_NOHALF 2					// OOK_MANCHESTER: no half bit pending
+
+OokProtocol OokReceiver::_protocol[OOK_PROTOCOLS];
+OokReceiver::State OokReceiver::_state[OOK_PROTOCOLS];
+byte OokReceiver::_count = 0;
+OokReceiverCallBack OokReceiver::_callback = NULL;
+boolean OokReceiver::_inCallback = false;
+
+void OokReceiver::init(OokReceiverCallBack callback) {
+	_callback = callback;
+}
+
+boolean OokReceiver::setProtocol(byte index, const OokProtocol &protocol) {
+	if (index >= OOK_PROTOCOLS) {
+		return false;
+	}
+	State state;
+	for (byte c = 0; c < OOK_CLASSES; c++) {
+		unsigned long margin = (unsigned long)protocol.width[c] * protocol.tolerance / 100;
+		state.min[c] = protocol.width[c] > 0 ? protocol.width[c] - margin : 1;
+		state.max[c] = protocol.width[c] > 0 ? protocol.width[c] + margin : 0;
+	}
+	state.bits = OOK_IDLE;
+	state.repeats = 0;
+
+	noInterrupts();
+	_protocol[index] = protocol;
+	if (protocol.bits == 0 || protocol.bits > 32) {
+		_protocol[index].syncMin = 1;		// Never starts a frame
+		_protocol[index].syncMax = 0;
+	}
+	_state[index] = state;
+	if (index >= _count) {
+		_count = index + 1;
+	}
+	interrupts();
+	return true;
+}
+
+byte OokReceiver::loadTable(const OokProtocol *table, byte count) {
+	OokProtocol protocol;
+	byte i;
+	for (i = 0; i < count && i < OOK_PROTOCOLS; i++) {
+		memcpy_P(&protocol, &table[i], sizeof(protocol));
+		setProtocol(i, protocol);
+	}
+	return i;
+}
+
+void OokReceiver::handlePulse(unsigned int duration) {
+	for (byte i = 0; i < _count; i++) {
+		const OokProtocol &p = _protocol[i];
+		State &s = _state[i];
+
+		if (duration >= p.syncMin && duration <= p.syncMax) {
+			if (s.bits != OOK_IDLE && s.bits > 0) {
+				reject(i);
+			}
+			s.bits = 0;
+			s.code = 0;
+			s.skip = p.skip;
+			s.pulses = p.encoding == OOK_MANCHESTER ? HIGH : 0;	// The pulse after the gap is high
+			s.pattern = p.encoding == OOK_MANCHESTER ? OOK_NOHALF : 0;
+			continue;
+		}
+		if (s.bits == OOK_IDLE) {
+			continue;
+		}
+
+		byte c;
+		for (c = 0; c < OOK_CLASSES; c++) {
+			if (duration >= s.min[c] && duration <= s.max[c]) break;
+		}
+
+		if (p.encoding == OOK_PULSES) {
+			if (s.skip > 0) {
+				s.skip--;
+				continue;
+			}
+			if (c == OOK_NONE) {
+				reject(i);
+				continue;
+			}
+			s.pattern = (s.pattern << 2) | c;
+			if (++s.pulses < p.pulses) {
+				continue;
+			}
+			byte pattern = s.pattern;
+			s.pattern = 0;
+			s.pulses = 0;
+			if (pattern == p.zero) addBit(i, 0);
+			else if (pattern == p.one) addBit(i, 1);
+			else reject(i);
+		}
+		else if (p.encoding == OOK_BIPHASE) {
+			if (s.skip > 0) {
+				s.skip--;
+			}
+			else if (c == 0 && s.pulses == 0) {
+				s.pulses = 1;					// First half of a 1
+			}
+			else if (c == 0) {
+				s.pulses = 0;
+				addBit(i, 1);
+			}
+			else if (c == 1 && s.pulses == 0) {
+				addBit(i, 0);
+			}
+			else {
+				reject(i);
+			}
+		}
+		else {
+			if (c > 1) {
+				reject(i);
+				continue;
+			}
+			byte level = s.pulses;
+			s.pulses ^= 1;
+			for (byte half = 0; half <= c && s.bits != OOK_IDLE; half++) {
+				if (s.skip > 0) {
+					s.skip--;
+				}
+				else if (s.pattern == OOK_NOHALF) {
+					s.pattern = level;
+				}
+				else if (s.pattern == level) {
+					reject(i);					// No transition in the middle of the bit
+				}
+				else {
+					s.pattern = OOK_NOHALF;
+					addBit(i, level == LOW);	// High-low is a 1
+				}
+			}
+		}
+	}
+}
+
+// Adds a bit, and calls the callback when the frame is complete
+boolean OokReceiver::addBit(byte index, byte bit) {
+	const OokProtocol &p = _protocol[index];
+	State &s = _state[index];
+	s.code = (s.code << 1) | bit;
+	if (++s.bits < p.bits) {
+		return false;
+	}
+
+	s.bits = OOK_IDLE;
+	unsigned long now = millis();
+	if (s.code != s.previous || s.repeats == 0 || now - s.last > OOK_GAP) {
+		s.previous = s.code;
+		s.repeats = 0;
+	}
+	s.last = now;
+	if (s.repeats < 255) {
+		s.repeats++;
+	}
+	DecoderChain::countFrame(OOK, s.repeats >= p.minRepeats ? FRAME_DECODED : FRAME_DUPLICATE);
+	if (s.repeats >= p.minRepeats && !_inCallback) {
+		OokCode code;
+		code.codec = p.codec;
+		code.protocol = index;
+		code.code = s.code;
+		code.bits = p.bits;
+		_inCallback = true;
+		(_callback)(code);
+		_inCallback = false;
+	}
+	return true;
+}
+
+// Gives up the frame; counted when at least half of the bits were in
+void OokReceiver::reject(byte index) {
+	State &s = _state[index];
+	if (s.bits != OOK_IDLE && 2 * s.bits >= _protocol[index].bits) {
+		DecoderChain::countFrame(OOK, FRAME_REJECTED);
+	}
+	s.bits = OOK_IDLE;
+}
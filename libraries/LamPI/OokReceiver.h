@@ -0,0 +1,130 @@
+/*
+ * OokReceiver library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef OokReceiver_h
+#define OokReceiver_h
+
+#include <Arduino.h>
+
+// Number of protocols that can be decoded at the same time. Every protocol takes 44 bytes.
+#ifndef OOK_PROTOCOLS
+#define OOK_PROTOCOLS 4
+#endif
+
+#ifndef OOK_GAP
+#define OOK_GAP 500					// Time in ms without a complete frame that ends a burst
+#endif
+
+// Encodings
+#define OOK_PULSES 0				// Every bit is a fixed number of pulses, see OokProtocol.zero/one
+#define OOK_BIPHASE 1				// A 1 is two short pulses, a 0 one long pulse (WT440)
+#define OOK_MANCHESTER 2			// Half bits of a short pulse, a 1 is high-low, a 0 low-high
+
+#define OOK_CLASSES 3				// Pulse widths per protocol
+
+/**
+* One row of the protocol table. The rows are made by the tool extras/host/ookinfer from a
+* captured trace, see PulseCapture.
+*/
+struct OokProtocol {
+	byte codec;						// Given to the callback, e.g. OREGON, or OOK for a new remote
+	byte encoding;					// OOK_PULSES, OOK_BIPHASE or OOK_MANCHESTER
+	unsigned int syncMin;			// A pulse in this range (microseconds) starts a frame
+	unsigned int syncMax;
+	unsigned int width[OOK_CLASSES];// Pulse widths in microseconds, 0 if not used. OOK_BIPHASE and
+									// OOK_MANCHESTER: [0] is the short and [1] the long pulse
+	byte tolerance;					// Percentage that a pulse may differ from its width
+	byte skip;						// Pulses after the sync that are not part of the bits.
+									// OOK_MANCHESTER: half bits
+	byte pulses;					// OOK_PULSES: pulses per bit, 1 to 4
+	byte zero;						// OOK_PULSES: the widths of the pulses of a 0 bit, 2 bits per
+	byte one;						// pulse (index in width), first pulse in the highest bits
+	byte bits;						// Bits per frame, at most 32
+	byte minRepeats;				// Identical frames needed before the callback is called
+};
+
+struct OokCode {
+	byte codec;						// OokProtocol.codec
+	byte protocol;					// Row in the table
+	unsigned long code;				// The bits, the first received in the highest bit
+	byte bits;
+};
+
+typedef void (*OokReceiverCallBack)(OokCode);
+
+/**
+* OokReceiver is a generic decoder for on-off keyed remotes and sensors that is driven by a
+* table of protocols instead of a hand-written state machine per protocol.
+*
+* Every protocol of the table is decoded by the same loop: a pulse in the sync range starts a
+* frame, every next pulse is classified by its width and the classes are turned into bits
+* according to the encoding of the protocol. A pulse that fits no width gives up the frame.
+* When all bits are in and the frame was received minRepeats times in a row, the callback is
+* called. The count starts again after OOK_GAP ms without a complete frame, so minRepeats
+* applies to every burst and not only to the first one of a code. The widths are turned into ranges by setProtocol(), so the interrupt only compares.
+*
+* Use it for protocols that have no receiver in the library (S_OREGON, S_CRESTA), after learning
+* them with PulseCapture and ookinfer. Add it to DecoderChain with codec OOK.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class OokReceiver {
+	public:
+		/**
+		* Initializes the decoder. No protocols are decoded until setProtocol() or loadTable().
+		*
+		* @param callback Pointer to a callback function, with signature void (*func)(OokCode)
+		*/
+		static void init(OokReceiverCallBack callback);
+
+		/**
+		* Sets row index of the table. A row with bits 0 is not decoded.
+		*
+		* @return false if index >= OOK_PROTOCOLS.
+		*/
+		static boolean setProtocol(byte index, const OokProtocol &protocol);
+
+		/**
+		* Sets the rows of the table from a table in PROGMEM, as written by ookinfer -o.
+		*
+		* @return the number of rows set.
+		*/
+		static byte loadTable(const OokProtocol *table, byte count);
+
+		/**
+		* Decodes one pulse. Called by DecoderChain.
+		*
+		* @param duration Duration of the pulse in microseconds, clipped to 65535.
+		*/
+		static void handlePulse(unsigned int duration);
+
+	private:
+		struct State {
+			unsigned int min[OOK_CLASSES];		// Range of every width
+			unsigned int max[OOK_CLASSES];
+			unsigned long code;
+			unsigned long previous;				// Last complete frame
+			byte bits;							// Bits received, OOK_IDLE when waiting for a sync
+			byte skip;							// Pulses still to skip
+			byte pulses;						// Pulses of the bit so far (OOK_MANCHESTER: level)
+			byte pattern;						// Widths of these pulses (OOK_MANCHESTER: half bit)
+			byte repeats;
+			unsigned long last;					// millis() of the last complete frame
+		};
+
+		static OokProtocol _protocol[OOK_PROTOCOLS];
+		static State _state[OOK_PROTOCOLS];
+		static byte _count;							// Rows in use, 1 + highest row set
+		static OokReceiverCallBack _callback;
+		static boolean _inCallback;
+
+		static boolean addBit(byte index, byte bit);
+		static void reject(byte index);
+};
+
+#endif
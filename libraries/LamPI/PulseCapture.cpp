@@ -0,0 +1,113 @@
+/*
+ * PulseCapture library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See PulseCapture.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <PulseCapture.h>
+#include <DecoderChain.h>
+
+#define CAPTURE_MAXBYTES 6					// Lost marker, frame marker and a 3 byte varint
+
+boolean PulseCapture::_capturing = false;
+byte PulseCapture::_buffer[CAPTURE_BUFSIZE];
+volatile byte PulseCapture::_head = 0;
+volatile byte PulseCapture::_tail = 0;
+unsigned int PulseCapture::_previous[2];
+boolean PulseCapture::_frame = true;
+boolean PulseCapture::_lost = false;
+volatile unsigned int PulseCapture::_lostPulses = 0;
+
+void PulseCapture::start() {
+	if (_capturing) {
+		return;
+	}
+	noInterrupts();
+	_tail = _head;
+	_frame = true;							// The first pulse starts a frame
+	_lost = false;
+	_lostPulses = 0;
+	_capturing = true;
+	interrupts();
+	DecoderChain::setCapture(handlePulse);
+}
+
+void PulseCapture::stop() {
+	if (!_capturing) {
+		return;
+	}
+	DecoderChain::setCapture(NULL);
+	_capturing = false;
+	// The interrupt no longer writes, so there is always room for these if read() keeps up.
+	if (((_tail - _head - 1) & (CAPTURE_BUFSIZE - 1)) >= 2) {
+		put(CAPTURE_MARK);
+		put(CAPTURE_END);
+	}
+}
+
+void PulseCapture::handlePulse(unsigned int duration) {
+	// Only the interrupt writes _head, so it is safe to use without locking.
+	byte free = (_tail - _head - 1) & (CAPTURE_BUFSIZE - 1);
+	if (free < CAPTURE_MAXBYTES) {
+		_lost = true;
+		_frame = true;
+		_lostPulses++;
+		return;
+	}
+
+	if (_lost) {
+		put(CAPTURE_MARK);
+		put(CAPTURE_LOST);
+		_lost = false;
+	}
+	if (duration >= CAPTURE_SYNC || _frame) {
+		// New frame. The duration is never CAPTURE_END or CAPTURE_LOST.
+		put(CAPTURE_MARK);
+		putVarint(duration > CAPTURE_LOST ? duration : CAPTURE_LOST + 1);
+		_previous[0] = 0;
+		_previous[1] = 0;
+		_frame = false;
+		return;
+	}
+
+	long delta = (long)duration - _previous[0];
+	unsigned long zigzag = delta < 0 ? ((unsigned long)-delta << 1) - 1 : (unsigned long)delta << 1;
+	putVarint(zigzag + 1);					// Never a 0 byte
+	_previous[0] = _previous[1];
+	_previous[1] = duration;
+}
+
+void PulseCapture::put(byte b) {
+	byte head = _head;
+	_buffer[head] = b;
+	_head = (head + 1) & (CAPTURE_BUFSIZE - 1);
+}
+
+void PulseCapture::putVarint(unsigned long value) {
+	while (value >= 0x80) {
+		put((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	put(value);
+}
+
+byte PulseCapture::read(byte *buf, byte len) {
+	byte n = 0;
+	byte tail = _tail;
+	while (n < len && tail != _head) {
+		buf[n++] = _buffer[tail];
+		tail = (tail + 1) & (CAPTURE_BUFSIZE - 1);
+	}
+	_tail = tail;
+	return n;
+}
+
+unsigned int PulseCapture::getLost() {
+	noInterrupts();
+	unsigned int lost = _lostPulses;
+	interrupts();
+	return lost;
+}
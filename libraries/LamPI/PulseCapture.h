@@ -0,0 +1,101 @@
+/*
+ * PulseCapture library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef PulseCapture_h
+#define PulseCapture_h
+
+#include <Arduino.h>
+
+// Size of the buffer with encoded pulses, must be a power of 2 and at most 256. A pulse takes 1
+// to 3 bytes, most pulses inside a frame take 1.
+#ifndef CAPTURE_BUFSIZE
+#define CAPTURE_BUFSIZE 128
+#endif
+
+#define CAPTURE_SYNC 2000			// Pulses of at least this many microseconds start a new frame
+#define CAPTURE_MARK 0x00			// Frame marker, never part of an encoded pulse
+#define CAPTURE_END 0				// After CAPTURE_MARK: the capture was stopped
+#define CAPTURE_LOST 1				// After CAPTURE_MARK: pulses were lost, buffer was full
+
+/**
+* PulseCapture streams the raw pulses of the receiver, to learn the protocol of a remote or a
+* sensor that has no decoder yet, or to record the noise of a receiver in the field. The tool
+* extras/host/rawtrace turns the stream into a trace file that replay and bench can use.
+*
+* While capturing, DecoderChain passes every pulse to handlePulse() instead of to the squelch and
+* the decoders. handlePulse() encodes the pulse into a ring buffer, read() takes the encoded
+* bytes out, for the sketch to write them to Serial or a TCP client from loop().
+*
+* Encoding: a pulse is stored as the difference with the pulse before the previous one (the
+* pulse of the same level, so in a frame the difference is only the jitter), zigzag coded so
+* small negative differences are small numbers too, plus 1. The number is written as a varint:
+* 7 bits per byte, low bits first, bit 7 set if more bytes follow. A difference of at most 63
+* microseconds takes 1 byte. With the jitter of a receiver a frame takes about 1.5 bytes per
+* pulse, so at 115200 baud the stream keeps up with about 7500 edges/s.
+*
+* An encoded pulse never contains a 0 byte, so CAPTURE_MARK can be used to frame the stream.
+* A pulse of CAPTURE_SYNC or more (the sync gap of a protocol), the first pulse and the first
+* pulse after lost pulses are written as CAPTURE_MARK followed by the duration as a varint, and
+* the next two pulses are written as if the pulses before them were 0. A reader can start at
+* any CAPTURE_MARK. Because a duration is never CAPTURE_END or CAPTURE_LOST, these follow a
+* CAPTURE_MARK to tell that the capture was stopped or that pulses were lost.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class PulseCapture {
+	public:
+		/**
+		* Starts capturing: DecoderChain passes all pulses to PulseCapture, none to the decoders.
+		*/
+		static void start();
+
+		/**
+		* Stops capturing and puts CAPTURE_END in the buffer. The decoders get the pulses again.
+		*/
+		static void stop();
+
+		static boolean capturing() {
+			return _capturing;
+		}
+
+		/**
+		* Encodes one pulse into the buffer. Called by DecoderChain from the interrupt handler.
+		*
+		* @param duration Duration of the pulse in microseconds.
+		*/
+		static void handlePulse(unsigned int duration);
+
+		/**
+		* Takes encoded bytes out of the buffer. Call this from loop(), as often as possible.
+		*
+		* @param buf	Buffer for the bytes.
+		* @param len	Number of bytes that fit in buf, or that can be written without blocking.
+		* @return the number of bytes put in buf.
+		*/
+		static byte read(byte *buf, byte len);
+
+		/**
+		* Number of pulses lost because the buffer was full, since start().
+		*/
+		static unsigned int getLost();
+
+	private:
+		static boolean _capturing;
+		static byte _buffer[CAPTURE_BUFSIZE];
+		static volatile byte _head;					// Next free byte, written by handlePulse() only
+		static volatile byte _tail;					// Oldest byte, written by read() only
+		static unsigned int _previous[2];			// The last two pulses, [1] is the last one
+		static boolean _frame;						// The next pulse starts a frame
+		static boolean _lost;						// Pulses were lost since the last pulse
+		static volatile unsigned int _lostPulses;
+
+		static void put(byte b);
+		static void putVarint(unsigned long value);
+};
+
+#endif
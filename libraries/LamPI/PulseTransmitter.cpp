@@ -0,0 +1,229 @@
+/*
+ * PulseTransmitter library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See PulseTransmitter.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <PulseTransmitter.h>
+
+#if defined(__AVR__)
+// Timer1 in CTC mode, prescaler 8: 2 ticks per microsecond at 16MHz
+#define TX_TIMER 1
+#define TX_TICKS(us) ((unsigned long)(us) * (F_CPU / 8000000UL))
+#define TX_MAXTIMER (0xFFFFUL / (F_CPU / 8000000UL))
+#define TX_ISR_ATTR
+#elif defined(ESP8266)
+// timer1 with divider 16: 5 ticks per microsecond, 23 bits
+#define TX_TIMER 1
+#define TX_TICKS(us) ((unsigned long)(us) * 5)
+#define TX_ISR_ATTR ICACHE_RAM_ATTR
+#else
+#define TX_TIMER 0
+#define TX_ISR_ATTR
+#endif
+
+// --------------------------------------------------------------------------------
+// PulseFrame
+//
+void PulseFrame::begin(byte pin, byte repeats, unsigned int s0, unsigned int s1, unsigned int s2, unsigned int s3) {
+	this->pin = pin;
+	this->repeats = repeats;
+	symbol[0] = s0;
+	symbol[1] = s1;
+	symbol[2] = s2;
+	symbol[3] = s3;
+	count = 0;
+	gap = 0;
+}
+
+boolean PulseFrame::add(byte s) {
+	if (count >= TX_MAXPULSES) {
+		return false;
+	}
+	byte shift = (count & 3) << 1;
+	if (shift == 0) {
+		pulses[count >> 2] = 0;
+	}
+	pulses[count >> 2] |= (s & 3) << shift;
+	count++;
+	return true;
+}
+
+// --------------------------------------------------------------------------------
+// PulseTransmitter
+//
+boolean PulseTransmitter::_background = false;
+PulseFrame PulseTransmitter::_queue[TX_QUEUE];
+volatile byte PulseTransmitter::_head = 0;
+volatile byte PulseTransmitter::_tail = 0;
+byte PulseTransmitter::_index = 0;
+byte PulseTransmitter::_repeat = 0;
+unsigned int PulseTransmitter::_remaining = 0;
+
+void PulseTransmitter::init(boolean background) {
+	_background = background;
+}
+
+void PulseTransmitter::transmit(const PulseFrame &frame) {
+	if (!_background) {
+		send(frame);
+		return;
+	}
+	while (!queue(frame)) {
+		delay(1);								// Wait for the oldest frame to finish
+	}
+}
+
+boolean PulseTransmitter::queue(const PulseFrame &frame) {
+#if TX_TIMER==1
+	if ((byte)(_head - _tail) >= TX_QUEUE) {
+		return false;
+	}
+	_queue[_head & (TX_QUEUE - 1)] = frame;
+
+	noInterrupts();
+	boolean idle = (_head == _tail);
+	_head++;
+	interrupts();
+
+	if (idle) {
+		// The interrupt stopped the timer after the last frame, start it for this one
+		_index = 0;
+		_repeat = 0;
+		_remaining = 0;
+		startTimer();
+	}
+	return true;
+#else
+	send(frame);
+	return true;
+#endif
+}
+
+boolean PulseTransmitter::busy() {
+	return _head != _tail;
+}
+
+void PulseTransmitter::send(const PulseFrame &frame) {
+	while (busy()) {
+		delay(1);
+	}
+	for (byte r = 0; r < frame.repeats; r++) {
+		for (byte i = 0; i < frame.count; i++) {
+			digitalWrite(frame.pin, i & 1 ? LOW : HIGH);
+			delayMicroseconds(frame.duration(i));
+		}
+		if (frame.gap > 0) {
+			digitalWrite(frame.pin, LOW);
+			delay(frame.gap / 1000);
+			delayMicroseconds(frame.gap % 1000);
+		}
+	}
+	digitalWrite(frame.pin, LOW);
+}
+
+void TX_ISR_ATTR PulseTransmitter::timerHandler() {
+#if TX_TIMER==1
+	if (_remaining > 0) {
+		setTimer(_remaining);
+		return;
+	}
+
+	PulseFrame *f = &_queue[_tail & (TX_QUEUE - 1)];
+	for (;;) {
+		if (_index < f->count) {
+			digitalWrite(f->pin, _index & 1 ? LOW : HIGH);
+			setTimer(f->duration(_index));
+			_index++;
+			return;
+		}
+		if (_index++ == f->count && f->gap > 0) {
+			digitalWrite(f->pin, LOW);
+			setTimer(f->gap);
+			return;
+		}
+
+		// End of a repeat
+		_index = 0;
+		if (++_repeat < f->repeats) {
+			continue;
+		}
+
+		// End of the frame, start the next one if there is one
+		digitalWrite(f->pin, LOW);
+		_repeat = 0;
+		_tail++;
+		if (_tail == _head) {
+			stopTimer();
+			return;
+		}
+		f = &_queue[_tail & (TX_QUEUE - 1)];
+	}
+#endif
+}
+
+// --------------------------------------------------------------------------------
+// Timer, one interrupt at the end of every pulse
+//
+#if defined(__AVR__)
+
+ISR(TIMER1_COMPA_vect) {
+	PulseTransmitter::timerHandler();
+}
+
+void PulseTransmitter::startTimer() {
+	noInterrupts();
+	TCCR1A = 0;
+	TCCR1B = _BV(WGM12) | _BV(CS11);		// CTC, prescaler 8
+	TCNT1 = 0;
+	OCR1A = TX_TICKS(20);					// First pulse starts almost immediately
+	TIFR1 = _BV(OCF1A);
+	TIMSK1 |= _BV(OCIE1A);
+	interrupts();
+}
+
+void PulseTransmitter::stopTimer() {
+	TIMSK1 &= ~_BV(OCIE1A);
+	TCCR1B = 0;
+}
+
+void PulseTransmitter::setTimer(unsigned int duration) {
+	// Counter was reset by the compare match, the new top counts from there
+	if (duration > TX_MAXTIMER) {
+		_remaining = duration - TX_MAXTIMER;
+		duration = TX_MAXTIMER;
+	} else {
+		_remaining = 0;
+	}
+	OCR1A = TX_TICKS(duration) - 1;
+}
+
+#elif defined(ESP8266)
+
+void PulseTransmitter::startTimer() {
+	timer1_isr_init();
+	timer1_attachInterrupt(timerHandler);
+	timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+	timer1_write(TX_TICKS(20));				// First pulse starts almost immediately
+}
+
+void TX_ISR_ATTR PulseTransmitter::stopTimer() {
+	timer1_disable();
+	timer1_detachInterrupt();
+}
+
+void TX_ISR_ATTR PulseTransmitter::setTimer(unsigned int duration) {
+	_remaining = 0;
+	timer1_write(TX_TICKS(duration));
+}
+
+#else
+
+void PulseTransmitter::startTimer() { }
+void PulseTransmitter::stopTimer() { }
+void PulseTransmitter::setTimer(unsigned int duration) { (void)duration; }
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * PulseTransmitter library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef PulseTransmitter_h
+#define PulseTransmitter_h
+
+#include <Arduino.h>
+
+// Maximum number of pulses in one frame. A Kaku dim frame is 148 pulses, the other codecs
+// need less than 80. Every 4 pulses take one byte.
+#ifndef TX_MAXPULSES
+#define TX_MAXPULSES 152
+#endif
+
+// Number of frames that can be queued, including the one being sent. Must be a power of 2.
+// Every frame takes about 50 bytes.
+#ifndef TX_QUEUE
+#define TX_QUEUE 2
+#endif
+
+/**
+* A frame compiled for the transmitter: every pulse is a 2 bit index in a table of 4 durations.
+* All codecs in the library use at most 4 different pulse durations in a frame.
+*
+* The first pulse is high, after that pulses alternate between low and high. If a frame has an
+* odd number of pulses, the last pulse (high) runs into the first pulse of the next repeat, so
+* transmitters that need an edge there end the frame with a low pulse. After the last repeat
+* the pin is low.
+*/
+struct PulseFrame {
+	unsigned int symbol[4];				// Pulse durations in microseconds
+	byte pulses[TX_MAXPULSES / 4];		// 2 bits per pulse, first pulse in the LSBs of pulses[0]
+	byte count;							// Number of pulses in the frame
+	byte repeats;						// Number of times the frame is sent
+	unsigned int gap;					// Low time in microseconds after every repeat, 0 for none
+	byte pin;							// Transmitter output pin
+
+	/**
+	* Starts a new frame.
+	*
+	* @param pin		Output pin of the transmitter
+	* @param repeats	Number of times the frame is sent [1..255]
+	* @param s0 .. s3	Durations in microseconds of the pulses add() can use
+	*/
+	void begin(byte pin, byte repeats, unsigned int s0, unsigned int s1 = 0, unsigned int s2 = 0, unsigned int s3 = 0);
+
+	/**
+	* Adds one pulse to the frame.
+	*
+	* @param s	Index of the duration of the pulse, as given to begin() [0..3]
+	* @return false if the frame is full.
+	*/
+	boolean add(byte s);
+
+	/**
+	* Duration of pulse i in microseconds.
+	*/
+	unsigned int duration(byte i) const {
+		return symbol[(pulses[i >> 2] >> ((i & 3) << 1)) & 3];
+	}
+};
+
+/**
+* PulseTransmitter sends compiled frames from a hardware timer interrupt, so loop() does not have
+* to wait for the transmission. A 3-repeat Kaku frame alone already takes more than 100 ms when
+* sent with delayMicroseconds().
+*
+* The frames are built by the transmitters of the library (KakuTransmitter::frameUnit() etc.) and
+* then queued. The interrupt writes the level of the next pulse and sets the timer to its
+* duration, so the time spent in the interrupt is a few microseconds per pulse.
+*
+* The send functions of the transmitters (KakuTransmitter::sendUnit() etc.) call transmit(). By
+* default this waits until the frame is sent, as before. After init(true) transmit() only waits
+* until there is room in the queue.
+*
+* On AVR Timer1 is used (as by the Servo and VirtualWire/RH_ASK libraries), on ESP8266 timer1.
+* On other platforms queue() sends the frame immediately, just as send().
+*
+* Do not change the level of the transmitter pin as long as busy() returns true.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class PulseTransmitter {
+	public:
+		/**
+		* Sets the mode of transmit(). No need to call init() for queue() and send().
+		*
+		* @param background	If true, transmit() queues the frame. If false, transmit() sends the
+		*					frame and returns when it is done.
+		*/
+		static void init(boolean background);
+
+		/**
+		* Sends a frame in the mode set by init(). In background mode waits while the queue is full.
+		*/
+		static void transmit(const PulseFrame &frame);
+
+		/**
+		* Queues a frame for transmission. The frame is copied, so it can be reused immediately.
+		*
+		* @return false if the queue is full.
+		*/
+		static boolean queue(const PulseFrame &frame);
+
+		/**
+		* Tells whether a frame is being sent or waiting in the queue.
+		*/
+		static boolean busy();
+
+		/**
+		* Sends a frame with delayMicroseconds(), and returns when it is done. Waits for the
+		* queue to be empty first.
+		*/
+		static void send(const PulseFrame &frame);
+
+		/**
+		* Called by the timer interrupt at the end of every pulse.
+		*/
+		static void timerHandler();
+
+	private:
+		static boolean _background;
+		static PulseFrame _queue[TX_QUEUE];
+		static volatile byte _head;			// Next free entry, written by queue() only
+		static volatile byte _tail;			// Frame being sent, written by the interrupt only
+		static byte _index;					// Next pulse of the frame, count is the gap
+		static byte _repeat;				// Repeats of the frame done
+		static unsigned int _remaining;		// Rest of a pulse longer than the timer can count
+
+		static void startTimer();
+		static void stopTimer();
+		static void setTimer(unsigned int duration);
+};
+
+#endif
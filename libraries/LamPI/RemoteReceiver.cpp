@@ -6,6 +6,10 @@
  */
 
 #include "RemoteReceiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
+
+#define REJECT_STATE { if (_state >= 24) DecoderChain::countFrame(ACTION, FRAME_REJECTED); _state = -1; } // Gives up the frame
 
 /************
 * RemoteReceiver
@@ -46,6 +50,14 @@ void RemoteReceiver::deinit() {
 }
 
 void RemoteReceiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void RemoteReceiver::handlePulse(unsigned int pulse) {
 	if (!_enabled) {
 		return;
 	}
@@ -55,28 +67,28 @@ void RemoteReceiver::interruptHandler() {
 	static uint32_t receivedCode;			// Contains received code
 	static uint32_t previousCode;			// Contains previous received code
 	static byte repeats = 0;				// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
+	static unsigned int span;				// Time between the last decoded edge and the start of this pulse
 	static unsigned int min1Period, max1Period, min3Period, max3Period;
 	static bool skip;
 
-	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
+	// Filter out too short pulses. This method works as a low pass filter: a pulse that is too
+	// short is merged, together with the pulse following it, into the pulse before.
 	if (skip) {
 		skip = false;
+		span += pulse;
 		return;
 	}
 
-	if (_state >= 0 && edgeTimeStamp[2]-edgeTimeStamp[1] < min1Period) {
+	if (_state >= 0 && pulse < min1Period) {
 		// Last edge was too short.
 		// Skip this edge, and the next too.
 		skip = true;
+		span += pulse;
 		return;
 	}
 
-	unsigned int duration = edgeTimeStamp[1] - edgeTimeStamp[0];
-	edgeTimeStamp[0] = edgeTimeStamp[1];
+	unsigned int duration = span;
+	span = pulse;
 
 	// Note that if state>=0, duration is always >= 1 period.
 
@@ -106,7 +118,7 @@ void RemoteReceiver::interruptHandler() {
 			receivedBit |= B1; // Set LSB of receivedBit
 		}
 		else { // Otherwise the entire sequence is invalid
-			_state=-1;
+			REJECT_STATE;
 			return;
 		}
 
@@ -130,20 +142,20 @@ void RemoteReceiver::interruptHandler() {
 					break;
 				default:
 					// Bit was rubbish. Abort.
-					_state=-1;
+					REJECT_STATE;
 					return;
 			}
 		}
 	} else if (_state==48) { // Waiting for sync bit part 1
 		// Must be 1 period.
 		if (duration>max1Period) {
-			_state=-1;
+			REJECT_STATE;
 			return;
 		}
 	} else { // Waiting for sync bit part 2
 		// Must be 31 periods.
 		if (duration<period*25 || duration>period*36) {
-		  _state=-1;
+		  REJECT_STATE;
 		  return;
 		}
 
@@ -156,6 +168,7 @@ void RemoteReceiver::interruptHandler() {
 
 		repeats++;
 
+		DecoderChain::countFrame(ACTION, repeats >= _minRepeats ? FRAME_DECODED : FRAME_DUPLICATE);
 		if (repeats>=_minRepeats) {
 			if (!_inCallback) {
 				_inCallback = true;
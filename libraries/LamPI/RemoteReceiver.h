@@ -74,6 +74,15 @@ class RemoteReceiver {
 
 		static void interruptHandler();
 
+		/**
+		 * Decodes one pulse, i.e. the time between the previous and the current edge. Called by
+		 * interruptHandler(), or directly by DecoderChain which timestamps every edge only once
+		 * for all decoders.
+		 *
+		 * @param duration Duration of the pulse in microseconds, clipped to 65535.
+		 */
+		static void handlePulse(unsigned int duration);
+
 	private:
 
 		static int8_t _interrupt;					// Radio input interrupt
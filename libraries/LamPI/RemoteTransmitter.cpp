@@ -49,75 +49,53 @@ void RemoteTransmitter::sendTelegram(byte trits[]) {
 * d = data
 */
 void RemoteTransmitter::sendTelegram(unsigned long data, byte pin) {
+	PulseFrame frame;
+	frameTelegram(frame, data, pin);
+	PulseTransmitter::transmit(frame);
+}
+
+void RemoteTransmitter::sendCode(byte pin, unsigned long code, unsigned int periodusec, byte repeats) {
+	PulseFrame frame;
+	frameCode(frame, pin, code, periodusec, repeats);
+	PulseTransmitter::transmit(frame);
+}
+
+void RemoteTransmitter::frameTelegram(PulseFrame &frame, unsigned long data, byte pin) {
 	unsigned int periodusec = (unsigned long)data >> 23;
 	byte repeats = ((unsigned long)data >> 20) & B111;
 
-	sendCode(pin, data, periodusec, repeats);
+	frameCode(frame, pin, data, periodusec, repeats);
 }
 
-void RemoteTransmitter::sendCode(byte pin, unsigned long code, unsigned int periodusec, byte repeats) {
+void RemoteTransmitter::frameCode(PulseFrame &frame, byte pin, unsigned long code, unsigned int periodusec, byte repeats) {
 	code &= 0xfffff; // Truncate to 20 bit ;
-	// Convert the base3-code to base4, to avoid lengthy calculations when transmitting.. Messes op timings.
-	// Also note this swaps endianess in the process. The MSB must be transmitted first, but is converted to
-	// LSB here. This is easier when actually transmitting later on.
-	unsigned long dataBase4 = 0;
-	
-	for (byte i=0; i<12; i++) {
-		dataBase4<<=2;
-		dataBase4|=(code%3);
+
+	// Pulse durations: 0 = T, 1 = 3T, 2 = 31T (low part of the synchronization-signal)
+	frame.begin(pin, 1 << (repeats & B111), periodusec, periodusec*3, periodusec*31);
+
+	// Trits are sent MSB first. Every trit is 4 pulses, high-low-high-low.
+	byte trits[12];
+	for (int8_t i=11; i>=0; i--) {
+		trits[i]=code%3;
 		code/=3;
 	}
-
-	repeats = 1 << (repeats & B111); // repeats := 2^repeats;
-
-	for (byte j=0;j<repeats;j++) {
-		// Sent one telegram
-
-		// Recycle code as working var to save memory
-		code=dataBase4;
-		for (byte i=0; i<12; i++) {
-			switch (code & B11) {
-				case 0:
-					digitalWrite(pin, HIGH);
-					delayMicroseconds(periodusec);
-					digitalWrite(pin, LOW);
-					delayMicroseconds(periodusec*3);
-					digitalWrite(pin, HIGH);
-					delayMicroseconds(periodusec);
-					digitalWrite(pin, LOW);
-					delayMicroseconds(periodusec*3);
-					break;
-				case 1:
-					digitalWrite(pin, HIGH);
-					delayMicroseconds(periodusec*3);
-					digitalWrite(pin, LOW);
-					delayMicroseconds(periodusec);
-					digitalWrite(pin, HIGH);
-					delayMicroseconds(periodusec*3);
-					digitalWrite(pin, LOW);
-					delayMicroseconds(periodusec);
-					break;
-				case 2: // KA: X or float
-					digitalWrite(pin, HIGH);
-					delayMicroseconds(periodusec);
-					digitalWrite(pin, LOW);
-					delayMicroseconds(periodusec*3);
-					digitalWrite(pin, HIGH);
-					delayMicroseconds(periodusec*3);
-					digitalWrite(pin, LOW);
-					delayMicroseconds(periodusec);
-					break;
-			}
-			// Next trit
-			code>>=2;
+	for (byte i=0; i<12; i++) {
+		switch (trits[i]) {
+			case 0:
+				frame.add(0); frame.add(1); frame.add(0); frame.add(1);
+				break;
+			case 1:
+				frame.add(1); frame.add(0); frame.add(1); frame.add(0);
+				break;
+			case 2: // KA: X or float
+				frame.add(0); frame.add(1); frame.add(1); frame.add(0);
+				break;
 		}
-
-		// Send termination/synchronization-signal. Total length: 32 periods
-		digitalWrite(pin, HIGH);
-		delayMicroseconds(periodusec);
-		digitalWrite(pin, LOW);
-		delayMicroseconds(periodusec*31);
 	}
+
+	// Termination/synchronization-signal. Total length: 32 periods
+	frame.add(0);
+	frame.add(2);
 }
 
 boolean RemoteTransmitter::isSameCode(unsigned long encodedTelegram, unsigned long receivedData) {
@@ -139,6 +117,10 @@ void ActionTransmitter::sendSignal(byte systemCode, char device, boolean on) {
 	sendTelegram(getTelegram(systemCode,device,on), _pin);
 }
 
+void ActionTransmitter::frameSignal(PulseFrame &frame, byte systemCode, char device, boolean on) {
+	frameTelegram(frame, getTelegram(systemCode,device,on), _pin);
+}
+
 unsigned long ActionTransmitter::getTelegram(byte systemCode, char device, boolean on) {
 	byte trits[12];
 
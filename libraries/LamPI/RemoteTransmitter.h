@@ -8,6 +8,7 @@
 #define RemoteTransmitter_h
 
 #include <Arduino.h>
+#include <PulseTransmitter.h>
 
 /**
 * RemoteTransmitter provides a generic class for simulation of common RF remote controls, like the 'Klik aan Klik uit'-system
@@ -83,6 +84,13 @@ class RemoteTransmitter {
 		*/
 		static void sendCode(byte pin, unsigned long code, unsigned int periodusec, byte repeats);
 
+		/**
+		* Compiles the telegram of sendTelegram() or sendCode() into a frame, including the repeats,
+		* without sending it. Queue the frame with PulseTransmitter::queue() to send it in the background.
+		*/
+		static void frameTelegram(PulseFrame &frame, unsigned long data, byte pin);
+		static void frameCode(PulseFrame &frame, byte pin, unsigned long code, unsigned int periodusec, byte repeats);
+
 		/**
 		* Compares the data received with RemoteReceive with the data obtained by one of the getTelegram-functions.
 		* Period duration and repetitions are ignored by this function; only the data-payload is compared.
@@ -130,6 +138,13 @@ class ActionTransmitter: RemoteTransmitter {
 		* @return Encoded data, including repeats and period duration.
 		*/
 		unsigned long getTelegram(byte systemCode, char device, boolean on);
+
+		/**
+		* Compiles the signal of sendSignal() into a frame without sending it.
+		*
+		* @see RemoteTransmitter::frameTelegram
+		*/
+		void frameSignal(PulseFrame &frame, byte systemCode, char device, boolean on);
 };
 
 /**
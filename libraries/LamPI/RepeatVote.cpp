@@ -0,0 +1,160 @@
+/*
+ * RepeatVote library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See RepeatVote.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <RepeatVote.h>
+#include <DecoderChain.h>
+
+RepeatVote::RepeatVote() {
+	for (byte i = 0; i < VOTE_BURSTS; i++) {
+		_bursts[i].count = 0;
+	}
+}
+
+byte RepeatVote::add(uint32_t &bits, uint32_t mask, byte minRepeats) {
+	unsigned long now = millis();
+	boolean correct = parity(bits) == 0;
+	uint32_t key = bits & mask;
+	Burst *b = find(key, correct, now);
+	if (b == NULL) {
+		return FRAME_REJECTED;
+	}
+
+	if (correct && !b->keyed) {
+		// This frame decides the sensor of the burst, frames with errors in the key are left out
+		byte n = 0;
+		for (byte i = 0; i < b->count; i++) {
+			if ((b->frames[i] & mask) == key) b->frames[n++] = b->frames[i];
+		}
+		b->count = n;
+		b->key = key;
+		b->keyed = true;
+	}
+	b->last = now;
+	if (b->count < VOTE_FRAMES) {
+		b->frames[b->count++] = bits;
+	}
+	if (b->delivered) {
+		return FRAME_DUPLICATE;
+	}
+
+	if (correct) {
+		byte same = 0;
+		for (byte i = 0; i < b->count; i++) {
+			if (b->frames[i] == bits) same++;
+		}
+		if (same >= minRepeats) {
+			b->delivered = true;
+			return FRAME_DECODED;
+		}
+	}
+
+	if (b->count >= 3) {
+		// Without a correct frame the first vote points at the sensor, the second is over its frames
+		uint32_t voted;
+		if (vote(*b, 0, 0, voted) && (b->keyed || vote(*b, mask, voted & mask, voted))
+				&& parity(voted) == 0) {
+			if (!b->keyed) {
+				Burst *k = keyed(voted & mask);
+				if (k != NULL) {
+					// The sensor has a burst already, these were repeats of it with errors
+					merge(*b, *k, mask);
+					b = k;
+				}
+			}
+			if (b->delivered) {
+				return correct ? FRAME_DUPLICATE : FRAME_REJECTED;
+			}
+			bits = voted;
+			b->key = voted & mask;
+			b->keyed = true;
+			b->delivered = true;
+			return FRAME_DECODED;
+		}
+	}
+	return correct ? FRAME_DUPLICATE : FRAME_REJECTED;
+}
+
+RepeatVote::Burst *RepeatVote::find(uint32_t key, boolean correct, unsigned long now) {
+	Burst *unkeyed = NULL, *unused = NULL, *done = NULL;
+	for (byte i = 0; i < VOTE_BURSTS; i++) {
+		Burst &b = _bursts[i];
+		if (b.count > 0 && now - b.last > VOTE_GAP) {
+			b.count = 0;								// The burst has ended
+		}
+		if (b.count == 0) {
+			if (unused == NULL) unused = &b;
+		}
+		else if (!b.keyed) {
+			if (unkeyed == NULL) unkeyed = &b;
+		}
+		else if (b.key == key) {
+			return &b;
+		}
+		else if (b.delivered && (done == NULL || (long)(b.last - done->last) < 0)) {
+			done = &b;
+		}
+	}
+
+	// A correct frame of a new sensor takes the burst of frames with errors, which are mostly
+	// its own repeats received before it (add() leaves out those of another key), else a free
+	// burst, else the delivered burst heard of longest ago. A frame with an error does not push
+	// out the burst of another sensor.
+	Burst *b = correct ? (unkeyed ? unkeyed : unused ? unused : done) : (unkeyed ? unkeyed : unused);
+	if (b != NULL && b != unkeyed) {
+		b->count = 0;
+		b->keyed = false;
+		b->delivered = false;
+	}
+	return b;
+}
+
+RepeatVote::Burst *RepeatVote::keyed(uint32_t key) {
+	for (byte i = 0; i < VOTE_BURSTS; i++) {
+		if (_bursts[i].count > 0 && _bursts[i].keyed && _bursts[i].key == key) return &_bursts[i];
+	}
+	return NULL;
+}
+
+// Moves the frames of from that have the key of to into to, and frees from
+void RepeatVote::merge(Burst &from, Burst &to, uint32_t mask) {
+	for (byte i = 0; i < from.count && to.count < VOTE_FRAMES; i++) {
+		if ((from.frames[i] & mask) == to.key) to.frames[to.count++] = from.frames[i];
+	}
+	if ((long)(from.last - to.last) > 0) to.last = from.last;
+	from.count = 0;
+}
+
+boolean RepeatVote::vote(const Burst &burst, uint32_t mask, uint32_t key, uint32_t &voted) {
+	// A bit is 1 if it is 1 in more than half of the frames of the key
+	byte n = 0;
+	for (byte i = 0; i < burst.count; i++) {
+		if ((burst.frames[i] & mask) == key) n++;
+	}
+	if (n < 3) {
+		return false;
+	}
+	voted = 0;
+	for (uint32_t bit = 1; bit != 0; bit <<= 1) {
+		byte ones = 0;
+		for (byte i = 0; i < burst.count; i++) {
+			if ((burst.frames[i] & mask) == key && (burst.frames[i] & bit)) ones++;
+		}
+		if (2 * ones > n) voted |= bit;
+	}
+	return true;
+}
+
+byte RepeatVote::parity(uint32_t bits) {
+	bits ^= bits >> 16;
+	bits ^= bits >> 8;
+	bits ^= bits >> 4;
+	bits ^= bits >> 2;
+	bits ^= bits >> 1;
+	return bits & 1;
+}
@@ -0,0 +1,87 @@
+/*
+ * RepeatVote library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef RepeatVote_h
+#define RepeatVote_h
+
+#include <Arduino.h>
+
+// Number of repeats of one burst that are kept for the vote. The Auriol sends 6 repeats, the
+// WT440 2 or more. Every repeat takes 4 bytes per burst.
+#ifndef VOTE_FRAMES
+#define VOTE_FRAMES 5
+#endif
+
+// Number of sensors of one codec whose bursts can overlap. Every burst takes 4 * VOTE_FRAMES + 11
+// bytes per receiver.
+#ifndef VOTE_BURSTS
+#define VOTE_BURSTS 2
+#endif
+
+#define VOTE_GAP 500				// Time in ms without a frame that ends a burst
+
+/**
+* RepeatVote collects the repeats of the bursts of sensors that send frames of at most 32 bits
+* with an even parity bit, like the WT440 and the Auriol.
+*
+* A burst belongs to one sensor: the bits of the frame under the key mask (address, channel)
+* are the same for all its frames. Frames with a correct parity go to the burst of their key,
+* so two sensors that transmit at the same time, even with their frames interleaved, each get
+* their own burst and their own reading. A frame with a parity error goes to the burst of its
+* key, or else to a burst that has only frames with errors so far. The first correct frame of a
+* sensor takes over that burst, and keeps the frames of its key.
+*
+* A frame with a correct parity is delivered as soon as minRepeats identical frames are in.
+* When a bit error makes the frames disagree, every bit of the frame is decided by majority vote
+* over the repeats of the burst received so far, from the third repeat on, and the result is
+* delivered if its parity is correct. Frames of another key are left out of the vote. Only one
+* reading per burst is delivered; the other repeats are duplicates. A vote over frames with
+* errors only that points at a sensor that has a burst already adds them to that burst.
+*
+* The receivers call add() from their interrupt handler, once per complete frame.
+*/
+class RepeatVote {
+	public:
+		RepeatVote();
+
+		/**
+		* Adds a received frame to the burst of its sensor.
+		*
+		* @param bits		The frame. On FRAME_DECODED this is set to the frame to deliver.
+		* @param mask		The bits of the frame that tell the sensors apart.
+		* @param minRepeats	Number of identical, correct frames needed without a vote.
+		* @return FRAME_DECODED if bits must be delivered now, FRAME_DUPLICATE if the frame is correct
+		*			but not delivered (yet), FRAME_REJECTED if it is not correct and the vote did not
+		*			help, or if all VOTE_BURSTS are taken by other sensors. See DecoderChain.h.
+		*/
+		byte add(uint32_t &bits, uint32_t mask, byte minRepeats);
+
+		/**
+		* @return the xor of all bits: 0 if the even parity is correct.
+		*/
+		static byte parity(uint32_t bits);
+
+	private:
+		struct Burst {
+			uint32_t frames[VOTE_FRAMES];
+			uint32_t key;					// Bits under the mask, when keyed
+			unsigned long last;				// millis() of the last frame
+			byte count;						// Frames, 0 for a free burst
+			boolean keyed;					// A correct frame (or the vote) decided the sensor
+			boolean delivered;				// The reading of this burst has been delivered
+		};
+
+		Burst _bursts[VOTE_BURSTS];
+
+		Burst *find(uint32_t key, boolean correct, unsigned long now);
+		Burst *keyed(uint32_t key);
+		void merge(Burst &from, Burst &to, uint32_t mask);
+		static boolean vote(const Burst &burst, uint32_t mask, uint32_t key, uint32_t &voted);
+};
+
+#endif
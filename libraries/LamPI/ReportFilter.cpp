@@ -0,0 +1,95 @@
+/*
+ * ReportFilter library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See ReportFilter.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <ReportFilter.h>
+
+ReportFilter::Value ReportFilter::_values[REPORT_VALUES];
+boolean ReportFilter::_initialized = false;
+unsigned int ReportFilter::_sent = 0;
+unsigned int ReportFilter::_held = 0;
+
+void ReportFilter::init() {
+	for (byte i = 0; i < REPORT_VALUES; i++) {
+		_values[i].deadband = 0;
+		_values[i].heartbeat = REPORT_HEARTBEAT;
+		_values[i].valid = false;
+	}
+	_initialized = true;
+}
+
+boolean ReportFilter::setup(byte value, float deadband, unsigned int heartbeat) {
+	if (value >= REPORT_VALUES) {
+		return false;
+	}
+	if (!_initialized) {
+		init();
+	}
+	_values[value].deadband = deadband;
+	_values[value].heartbeat = heartbeat;
+	return true;
+}
+
+boolean ReportFilter::getSetup(byte value, float &deadband, unsigned int &heartbeat) {
+	if (value >= REPORT_VALUES) {
+		return false;
+	}
+	if (!_initialized) {
+		init();
+	}
+	deadband = _values[value].deadband;
+	heartbeat = _values[value].heartbeat;
+	return true;
+}
+
+boolean ReportFilter::changed(byte value, float sample) {
+	if (value >= REPORT_VALUES) {
+		return true;
+	}
+	if (!_initialized) {
+		init();
+	}
+	Value &v = _values[value];
+	float delta = sample > v.last ? sample - v.last : v.last - sample;
+	if (v.valid && delta < v.deadband
+			&& (v.heartbeat == 0 || millis() - v.time < v.heartbeat * 1000UL)) {
+		_held++;
+		return false;
+	}
+	sent(value, sample);
+	_sent++;
+	return true;
+}
+
+void ReportFilter::sent(byte value, float sample) {
+	if (value >= REPORT_VALUES) {
+		return;
+	}
+	_values[value].last = sample;
+	_values[value].time = millis();
+	_values[value].valid = true;
+}
+
+void ReportFilter::force() {
+	for (byte i = 0; i < REPORT_VALUES; i++) {
+		_values[i].valid = false;
+	}
+}
+
+unsigned int ReportFilter::getSent() {
+	return _sent;
+}
+
+unsigned int ReportFilter::getHeld() {
+	return _held;
+}
+
+void ReportFilter::resetStatistics() {
+	_sent = 0;
+	_held = 0;
+}
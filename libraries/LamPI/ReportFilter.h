@@ -0,0 +1,102 @@
+/*
+ * ReportFilter library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef ReportFilter_h
+#define ReportFilter_h
+
+#include <Arduino.h>
+
+// Number of values that can be filtered, e.g. the temperature and the humidity of a HTU21D are
+// two values. Every value takes 16 bytes.
+#ifndef REPORT_VALUES
+#define REPORT_VALUES 16
+#endif
+
+// Default seconds after which a value is sent again, also when it did not change
+#ifndef REPORT_HEARTBEAT
+#define REPORT_HEARTBEAT 300
+#endif
+
+/**
+* ReportFilter decides whether a new sample of a sensor is worth sending.
+*
+* A value is sent when it differs at least its deadband from the value sent last, or when it
+* was not sent for heartbeat seconds, so the daemon knows the sensor is still there. The
+* deadband is taken from the value sent last, not from the previous sample, so a value that
+* creeps up in small steps is sent when it has moved a deadband, and a value that wobbles
+* around a boundary is not sent at every wobble (hysteresis).
+*
+* The sensors can then be sampled often, see SensorSweep, and a change is seen within one
+* interval, while a steady value costs one message per heartbeat.
+*
+* The values are numbered by the sketch, 0 to REPORT_VALUES-1. A value that was never set up
+* has deadband 0 and heartbeat REPORT_HEARTBEAT.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class ReportFilter {
+	public:
+		/**
+		* Sets the deadband and heartbeat of a value.
+		*
+		* @param deadband	Smallest change that is sent, in the unit of the value
+		* @param heartbeat	Seconds after which an unchanged value is sent, 0 for never
+		* @return false if value >= REPORT_VALUES.
+		*/
+		static boolean setup(byte value, float deadband, unsigned int heartbeat = REPORT_HEARTBEAT);
+
+		/**
+		* Gets the deadband and heartbeat of a value.
+		*
+		* @return false if value >= REPORT_VALUES.
+		*/
+		static boolean getSetup(byte value, float &deadband, unsigned int &heartbeat);
+
+		/**
+		* Tells whether a sample must be sent. If so, it is remembered as sent.
+		*
+		* @return true for the first sample, a sample that moved at least the deadband, and when
+		*		the heartbeat expired.
+		*/
+		static boolean changed(byte value, float sample);
+
+		/**
+		* Remembers a sample as sent, for a value that is sent together with one that changed.
+		*/
+		static void sent(byte value, float sample);
+
+		/**
+		* Makes the next sample of every value be sent, e.g. after the daemon connected again.
+		*/
+		static void force();
+
+		/**
+		* Number of samples sent and held back since the last resetStatistics().
+		*/
+		static unsigned int getSent();
+		static unsigned int getHeld();
+		static void resetStatistics();
+
+	private:
+		struct Value {
+			float last;						// Sample sent last
+			float deadband;
+			unsigned int heartbeat;			// Seconds, 0 for never
+			unsigned long time;				// millis() of sending last
+			boolean valid;					// last has been sent
+		};
+
+		static Value _values[REPORT_VALUES];
+		static boolean _initialized;
+		static unsigned int _sent;
+		static unsigned int _held;
+
+		static void init();
+};
+
+#endif
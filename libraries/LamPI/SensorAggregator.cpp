@@ -0,0 +1,150 @@
+/*
+ * SensorAggregator library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See SensorAggregator.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <SensorAggregator.h>
+
+SensorAggregate SensorAggregator::_table[AGGREGATE_SENSORS];
+SensorAggregatorCallBack SensorAggregator::_callback = NULL;
+unsigned int SensorAggregator::_window = 0;
+unsigned int SensorAggregator::_frames = 0;
+unsigned int SensorAggregator::_reports = 0;
+
+void SensorAggregator::init(SensorAggregatorCallBack callback, unsigned int window) {
+	_callback = callback;
+	_window = window;
+	for (byte i = 0; i < AGGREGATE_SENSORS; i++) {
+		_table[i].count = 0;
+		_table[i].open = false;
+	}
+}
+
+void SensorAggregator::setWindow(unsigned int window) {
+	noInterrupts();
+	_window = window;
+	interrupts();
+}
+
+unsigned int SensorAggregator::getWindow() {
+	return _window;
+}
+
+boolean SensorAggregator::add(byte codec, byte address, byte channel, byte type, int value0, int value1) {
+	if (_window == 0 || _callback == NULL) {
+		return false;
+	}
+
+	// The entry of this sensor, else the free or reported entry heard of longest ago
+	SensorAggregate *a = NULL;
+	for (byte i = 0; i < AGGREGATE_SENSORS; i++) {
+		SensorAggregate &e = _table[i];
+		if (e.count > 0 && e.codec == codec && e.address == address && e.channel == channel && e.type == type) {
+			a = &e;
+			break;
+		}
+		if (!e.open && (a == NULL || (a->count > 0 && (e.count == 0 || millis() - e.time > millis() - a->time)))) {
+			a = &e;
+		}
+	}
+	if (a == NULL) {
+		return false;										// Table full of open windows
+	}
+
+	int value[AGGREGATE_VALUES] = { value0, value1 };
+	if (!a->open || a->codec != codec || a->address != address || a->channel != channel || a->type != type) {
+		a->codec = codec;
+		a->address = address;
+		a->channel = channel;
+		a->type = type;
+		a->count = 0;
+		a->open = true;
+		a->start = millis();
+		for (byte i = 0; i < AGGREGATE_VALUES; i++) {
+			a->min[i] = value[i];
+			a->max[i] = value[i];
+			a->sum[i] = 0;
+		}
+	}
+	for (byte i = 0; i < AGGREGATE_VALUES; i++) {
+		a->last[i] = value[i];
+		if (value[i] < a->min[i]) a->min[i] = value[i];
+		if (value[i] > a->max[i]) a->max[i] = value[i];
+		a->sum[i] += value[i];
+	}
+	a->count++;
+	a->time = millis();
+	_frames++;
+	if (a->count == 255) {
+		report(*a);											// The sum must not overflow
+	}
+	return true;
+}
+
+void SensorAggregator::process() {
+	for (byte i = 0; i < AGGREGATE_SENSORS; i++) {
+		SensorAggregate aggregate;
+		noInterrupts();										// add() may run in the interrupt
+		boolean passed = _table[i].open && millis() - _table[i].start >= _window * 1000UL;
+		if (passed) {
+			_table[i].open = false;
+			_reports++;
+			aggregate = _table[i];
+		}
+		interrupts();
+		if (passed) {
+			_callback(aggregate);							// With a copy, add() may change the entry
+		}
+	}
+}
+
+boolean SensorAggregator::get(byte index, SensorAggregate &aggregate) {
+	if (index >= AGGREGATE_SENSORS) {
+		return false;
+	}
+	noInterrupts();
+	boolean used = _table[index].count > 0;
+	if (used) aggregate = _table[index];
+	interrupts();
+	return used;
+}
+
+int SensorAggregator::mean(const SensorAggregate &aggregate, byte i) {
+	long n = aggregate.count;
+	if (n == 0 || i >= AGGREGATE_VALUES) {
+		return 0;
+	}
+	long sum = aggregate.sum[i];
+	return sum >= 0 ? (sum + n / 2) / n : (sum - n / 2) / n;
+}
+
+unsigned int SensorAggregator::getFrames() {
+	noInterrupts();
+	unsigned int frames = _frames;
+	interrupts();
+	return frames;
+}
+
+unsigned int SensorAggregator::getReports() {
+	noInterrupts();
+	unsigned int reports = _reports;
+	interrupts();
+	return reports;
+}
+
+void SensorAggregator::resetStatistics() {
+	noInterrupts();
+	_frames = 0;
+	_reports = 0;
+	interrupts();
+}
+
+void SensorAggregator::report(SensorAggregate &aggregate) {
+	aggregate.open = false;
+	_reports++;
+	_callback(aggregate);
+}
@@ -0,0 +1,125 @@
+/*
+ * SensorAggregator library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef SensorAggregator_h
+#define SensorAggregator_h
+
+#include <Arduino.h>
+
+// Number of sensors that can be aggregated at the same time. Every sensor takes 34 bytes.
+#ifndef AGGREGATE_SENSORS
+#define AGGREGATE_SENSORS 8
+#endif
+
+// Default length of a window in seconds
+#ifndef AGGREGATE_WINDOW
+#define AGGREGATE_WINDOW 300
+#endif
+
+#define AGGREGATE_VALUES 2			// Values per frame, e.g. temperature and humidity
+
+/**
+* The frames of one sensor in one window. A sensor is identified by (codec, address, channel,
+* type), type is whatever tells the messages of one sensor apart, e.g. the wconst of a WT440.
+*/
+struct SensorAggregate {
+	byte codec;
+	byte address;
+	byte channel;
+	byte type;
+	byte count;						// Frames in the window, 0 for an unused entry
+	boolean open;					// The window has not been reported yet
+	int last[AGGREGATE_VALUES];
+	int min[AGGREGATE_VALUES];
+	int max[AGGREGATE_VALUES];
+	long sum[AGGREGATE_VALUES];
+	unsigned long start;			// millis() of the first frame of the window
+	unsigned long time;				// millis() of the last frame
+};
+
+typedef void (*SensorAggregatorCallBack)(const SensorAggregate &);
+
+/**
+* SensorAggregator collects the frames of the wireless sensors (WT440, Auriol) that transmit
+* every 40 to 60 seconds, and reports one record per sensor per window instead of every frame.
+*
+* The first frame of a sensor opens its window, the next frames only update last, min, max and
+* the sum of every value. When the window has passed, process() calls the callback with the
+* entry, see mean(). The entry keeps the values of that window until the next frame of the
+* sensor opens a new one, so get() always shows the whole table.
+*
+* A sensor that does not fit in the table is not aggregated: add() returns false and the caller
+* sends the frame as before. An entry whose window has been reported is given to a new sensor
+* when the table is full, the one that was heard of longest ago first.
+*
+* process() must be called from loop(). add() may be called from a decoder callback in the
+* interrupt: the functions that are called from loop() take the table with the interrupts off,
+* and process() gives the callback a copy of the entry.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class SensorAggregator {
+	public:
+		/**
+		* Initializes the table.
+		*
+		* @param callback	Called by process() with every window that has passed
+		* @param window		Seconds per window, 0 to not aggregate
+		*/
+		static void init(SensorAggregatorCallBack callback, unsigned int window = AGGREGATE_WINDOW);
+
+		/**
+		* Sets the seconds per window. With 0, add() no longer aggregates and the open windows
+		* are reported by the next process().
+		*/
+		static void setWindow(unsigned int window);
+		static unsigned int getWindow();
+
+		/**
+		* Adds a frame of a sensor.
+		*
+		* @return false if the frame is not aggregated and must be sent by the caller.
+		*/
+		static boolean add(byte codec, byte address, byte channel, byte type, int value0, int value1 = 0);
+
+		/**
+		* Reports the windows that have passed. Call from loop().
+		*/
+		static void process();
+
+		/**
+		* Gets entry index of the table.
+		*
+		* @return false if index >= AGGREGATE_SENSORS or the entry is not used. The entries are
+		*		used in order, so a loop over the table can stop at the first false.
+		*/
+		static boolean get(byte index, SensorAggregate &aggregate);
+
+		/**
+		* Mean of value i over the frames of the window, rounded.
+		*/
+		static int mean(const SensorAggregate &aggregate, byte i);
+
+		/**
+		* Number of frames taken, and windows reported, since the last resetStatistics().
+		*/
+		static unsigned int getFrames();
+		static unsigned int getReports();
+		static void resetStatistics();
+
+	private:
+		static SensorAggregate _table[AGGREGATE_SENSORS];
+		static SensorAggregatorCallBack _callback;
+		static unsigned int _window;
+		static unsigned int _frames;
+		static unsigned int _reports;
+
+		static void report(SensorAggregate &aggregate);
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * SensorSweep library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See SensorSweep.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <SensorSweep.h>
+
+#define SWEEP_IDLE 0xFF
+
+SensorTask SensorSweep::_tasks[SWEEP_TASKS];
+byte SensorSweep::_step[SWEEP_TASKS];
+unsigned long SensorSweep::_due[SWEEP_TASKS];
+unsigned long SensorSweep::_started[SWEEP_TASKS];
+unsigned int SensorSweep::_interval[SWEEP_TASKS];
+byte SensorSweep::_count = 0;
+byte SensorSweep::_running = 0;
+unsigned long SensorSweep::_start = 0;
+unsigned int SensorSweep::_duration = 0;
+
+boolean SensorSweep::add(SensorTask task, unsigned int interval) {
+	if (_count >= SWEEP_TASKS) {
+		return false;
+	}
+	_tasks[_count] = task;
+	_step[_count] = SWEEP_IDLE;
+	_interval[_count] = interval;
+	_started[_count] = millis();
+	_count++;
+	return true;
+}
+
+boolean SensorSweep::setInterval(byte index, unsigned int interval) {
+	if (index >= _count) {
+		return false;
+	}
+	_interval[index] = interval;
+	return true;
+}
+
+unsigned int SensorSweep::getInterval(byte index) {
+	return index < _count ? _interval[index] : 0;
+}
+
+byte SensorSweep::count() {
+	return _count;
+}
+
+void SensorSweep::start() {
+	_start = millis();
+	for (byte i = 0; i < _count; i++) {
+		if (_step[i] == SWEEP_IDLE) {
+			_running++;
+		}
+		_step[i] = 0;
+	}
+	for (byte i = 0; i < _count; i++) {
+		begin(i);
+	}
+	if (_running == 0) {
+		_duration = millis() - _start;
+	}
+}
+
+boolean SensorSweep::process() {
+	for (byte i = 0; i < _count; i++) {
+		if (_step[i] == SWEEP_IDLE && _interval[i] > 0 && millis() - _started[i] >= _interval[i] * 1000UL) {
+			if (_running == 0) {
+				_start = millis();
+			}
+			_step[i] = 0;
+			_running++;
+			begin(i);
+		}
+	}
+	if (_running == 0) {
+		return false;
+	}
+	for (byte i = 0; i < _count; i++) {
+		if (_step[i] != SWEEP_IDLE && (long)(millis() - _due[i]) >= 0) {
+			run(i);
+		}
+	}
+	if (_running == 0) {
+		_duration = millis() - _start;
+		return false;
+	}
+	return true;
+}
+
+boolean SensorSweep::busy() {
+	return _running > 0;
+}
+
+unsigned int SensorSweep::getDuration() {
+	return _duration;
+}
+
+void SensorSweep::begin(byte i) {
+	_started[i] = millis();
+	run(i);
+}
+
+void SensorSweep::run(byte i) {
+	unsigned int wait = _tasks[i](_step[i]);
+	if (wait == SWEEP_DONE || _step[i] == SWEEP_IDLE - 1) {
+		_step[i] = SWEEP_IDLE;
+		_running--;
+		return;
+	}
+	_step[i]++;
+	_due[i] = millis() + wait;
+}
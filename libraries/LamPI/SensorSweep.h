@@ -0,0 +1,116 @@
+/*
+ * SensorSweep library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef SensorSweep_h
+#define SensorSweep_h
+
+#include <Arduino.h>
+
+// Number of sensor tasks that can be added
+#ifndef SWEEP_TASKS
+#define SWEEP_TASKS 4
+#endif
+
+#define SWEEP_DONE 0xFFFF				// Returned by a task after its last step
+
+// Default seconds between two runs of a task
+#ifndef SWEEP_INTERVAL
+#define SWEEP_INTERVAL 15
+#endif
+
+/**
+* A task reads one sensor, in steps. Step 0 starts the first conversion, every next step collects
+* the result of the previous conversion and may start another one.
+*
+* @param step	Number of the step [0..254]
+* @return the time in ms the sensor needs before the next step, or SWEEP_DONE.
+*/
+typedef unsigned int (*SensorTask)(byte step);
+
+/**
+* SensorSweep reads the onboard sensors without waiting for their conversions.
+*
+* The sensors on the I2C bus (HTU21D, BMP085) only need the bus to start a conversion and to
+* read the result, in between they work on their own. The sketch gives a task per sensor that
+* starts a conversion and returns how long it takes. start() runs the first step of every task,
+* so all sensors convert at the same time, and process() runs the next step of a task when its
+* time has come. A sweep then takes as long as the slowest sensor instead of the sum of all of
+* them, and loop() never waits.
+*
+* Every task also has an interval: process() starts it again when the interval has passed
+* since its last start. A task that is still running is not started again. Whether a new value
+* is worth sending is up to the task, see ReportFilter.
+*
+* process() must be called from loop().
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class SensorSweep {
+	public:
+		/**
+		* Adds a task, to be run by every sweep in the order of adding.
+		*
+		* @return false if there are already SWEEP_TASKS tasks.
+		*/
+		static boolean add(SensorTask task, unsigned int interval = SWEEP_INTERVAL);
+
+		/**
+		* Sets the seconds between two runs of task index (in the order of adding), 0 to only
+		* run it by start().
+		*
+		* @return false if there is no such task.
+		*/
+		static boolean setInterval(byte index, unsigned int interval);
+		static unsigned int getInterval(byte index);
+
+		/**
+		* Number of tasks added.
+		*/
+		static byte count();
+
+		/**
+		* Starts a sweep: runs the first step of every task. A sweep that is still running is
+		* restarted.
+		*/
+		static void start();
+
+		/**
+		* Runs the steps that are due, and starts the tasks whose interval has passed. Call
+		* from loop().
+		*
+		* @return true while the sweep is running.
+		*/
+		static boolean process();
+
+		/**
+		* Tells whether a sweep is running.
+		*/
+		static boolean busy();
+
+		/**
+		* Time in ms from start() to the end of the last step of the last sweep, or for a sweep of
+		* tasks started by process(), of the task that ran last.
+		*/
+		static unsigned int getDuration();
+
+	private:
+		static SensorTask _tasks[SWEEP_TASKS];
+		static byte _step[SWEEP_TASKS];		// Next step of every task, 0xFF when done
+		static unsigned long _due[SWEEP_TASKS];	// millis() at which the next step may run
+		static unsigned long _started[SWEEP_TASKS];	// millis() of the last step 0
+		static unsigned int _interval[SWEEP_TASKS];	// Seconds
+		static byte _count;
+		static byte _running;					// Tasks not done yet
+		static unsigned long _start;
+		static unsigned int _duration;
+
+		static void begin(byte i);
+		static void run(byte i);
+};
+
+#endif
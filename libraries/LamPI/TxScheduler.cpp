@@ -0,0 +1,140 @@
+/*
+ * TxScheduler library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ * See TxScheduler.h for details.
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <TxScheduler.h>
+
+TxScheduler::Slot TxScheduler::_slots[TX_SLOTS];
+byte TxScheduler::_next = 0;
+TxChannelBusy TxScheduler::_channelBusy = NULL;
+boolean TxScheduler::_sent = false;
+unsigned long TxScheduler::_holdStart = 0;
+unsigned long TxScheduler::_holdUntil = 0;
+unsigned int TxScheduler::_backoff = TX_BACKOFF_MIN;
+unsigned int TxScheduler::_coalesced = 0;
+unsigned int TxScheduler::_deferrals = 0;
+
+void TxScheduler::init(TxChannelBusy channelBusy) {
+	_channelBusy = channelBusy;
+	for (byte i = 0; i < TX_SLOTS; i++) {
+		_slots[i].remaining = 0;
+	}
+}
+
+boolean TxScheduler::add(byte codec, unsigned long gaddr, byte uaddr, const PulseFrame &frame) {
+	// Same device: replace its command. Otherwise take a free slot.
+	Slot *slot = NULL;
+	for (byte i = 0; i < TX_SLOTS; i++) {
+		Slot *s = &_slots[i];
+		if (s->remaining > 0 && s->codec == codec && s->gaddr == gaddr && s->uaddr == uaddr) {
+			slot = s;
+			_coalesced++;
+			break;
+		}
+		if (s->remaining == 0 && slot == NULL) {
+			slot = s;
+		}
+	}
+	if (slot == NULL) {
+		return false;
+	}
+
+	// Air time of one repeat decides how many repeats fit in a turn
+	unsigned long air = frame.gap;
+	for (byte i = 0; i < frame.count; i++) {
+		air += frame.duration(i);
+	}
+	unsigned long burst = air > 0 ? TX_SLICE / air : frame.repeats;
+	if (burst < 1) burst = 1;
+	if (burst > 255) burst = 255;
+
+	slot->codec = codec;
+	slot->gaddr = gaddr;
+	slot->uaddr = uaddr;
+	slot->frame = frame;
+	slot->burst = burst;
+	slot->remaining = frame.repeats;
+	return true;
+}
+
+void TxScheduler::process() {
+	if (PulseTransmitter::busy()) {
+		return;
+	}
+
+	unsigned long now = millis();
+	if (_sent) {
+		// A turn just ended. The decoders were disabled while we were sending, give them some
+		// time to hear whether someone else is sending now.
+		_sent = false;
+		_holdUntil = now + TX_LISTEN;
+	}
+	if ((long)(now - _holdUntil) < 0) {
+		return;
+	}
+
+	// Find the next device with repeats left, round robin
+	byte i;
+	for (i = 0; i < TX_SLOTS; i++) {
+		if (_slots[(_next + i) % TX_SLOTS].remaining > 0) {
+			break;
+		}
+	}
+	if (i == TX_SLOTS) {
+		_holdStart = 0;
+		return;
+	}
+
+	// Listen before talk
+	if (_channelBusy != NULL && _channelBusy()) {
+		if (_holdStart == 0) {
+			_holdStart = now | 1;				// 0 means not waiting
+			_backoff = TX_BACKOFF_MIN;
+		}
+		if ((long)(now - _holdStart) < TX_MAXDEFER) {	// Signed: _holdStart may be now + 1
+			_deferrals++;
+			_holdUntil = now + _backoff + (micros() & 15);	// A little randomness against lockstep
+			if (_backoff < TX_BACKOFF_MAX) {
+				_backoff <<= 1;
+			}
+			return;
+		}
+	}
+	_holdStart = 0;
+
+	Slot *s = &_slots[(_next + i) % TX_SLOTS];
+	byte burst = s->burst < s->remaining ? s->burst : s->remaining;
+	s->frame.repeats = burst;
+	PulseTransmitter::queue(s->frame);
+	s->remaining -= burst;
+	_next = (_next + i + 1) % TX_SLOTS;
+	_sent = true;
+}
+
+byte TxScheduler::pending() {
+	byte n = 0;
+	for (byte i = 0; i < TX_SLOTS; i++) {
+		if (_slots[i].remaining > 0) {
+			n++;
+		}
+	}
+	return n;
+}
+
+unsigned int TxScheduler::getCoalesced() {
+	return _coalesced;
+}
+
+unsigned int TxScheduler::getDeferrals() {
+	return _deferrals;
+}
+
+void TxScheduler::resetStatistics() {
+	_coalesced = 0;
+	_deferrals = 0;
+}
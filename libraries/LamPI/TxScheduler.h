@@ -0,0 +1,109 @@
+/*
+ * TxScheduler library v1.7.8
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef TxScheduler_h
+#define TxScheduler_h
+
+#include <Arduino.h>
+#include <PulseTransmitter.h>
+
+// Number of devices that can have a command waiting. Every slot holds a compiled frame of about
+// 60 bytes, so this is meant for the ESP8266 and the Mega.
+#ifndef TX_SLOTS
+#define TX_SLOTS 16
+#endif
+
+// Air time in microseconds of one turn of a device. A device gets as many repeats per turn as fit
+// in this time, but at least one. A Kaku frame (about 80 ms) is one repeat per turn, a Livolo
+// frame (about 8 ms) gets a few.
+#ifndef TX_SLICE
+#define TX_SLICE 30000UL
+#endif
+
+#define TX_LISTEN 20				// Time in ms between two turns in which the receivers can listen
+#define TX_BACKOFF_MIN 20			// First wait in ms when the channel is busy, doubles every time
+#define TX_BACKOFF_MAX 320
+#define TX_MAXDEFER 2000			// Send anyway after waiting this many ms for the channel
+
+typedef boolean (*TxChannelBusy)();
+
+/**
+* TxScheduler sits between the commands of the daemon and PulseTransmitter.
+*
+* Every device, identified by (codec, gaddr, uaddr), has at most one command waiting. A new command
+* for the same device replaces the old one, also when the old one is halfway its repeats: when a
+* dimmer is moved, only the last level matters. The repeats of the devices are interleaved round
+* robin, a turn at a time, so all lights of a scene react after their first repeat instead of one
+* after the other.
+*
+* After every turn the scheduler listens for TX_LISTEN ms, and then checks the channel with the
+* function given to init(), normally one that asks the receivers whether a message is coming in.
+* If the channel is busy, the turn is postponed with a doubling backoff, but for at most
+* TX_MAXDEFER ms.
+*
+* process() must be called from loop(). It only queues the next turn when PulseTransmitter is done
+* with the previous one, so it never waits.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
+class TxScheduler {
+	public:
+		/**
+		* @param channelBusy	Function that returns true while another transmitter is active,
+		*						or NULL to never wait for the channel.
+		*/
+		static void init(TxChannelBusy channelBusy);
+
+		/**
+		* Schedules a frame for a device. The frame is copied, including its number of repeats.
+		*
+		* @param codec	Codec number of the device (KAKU, ACTION etc. See LamPI.h)
+		* @return false if all slots are in use by other devices.
+		*/
+		static boolean add(byte codec, unsigned long gaddr, byte uaddr, const PulseFrame &frame);
+
+		/**
+		* Queues the next turn when the transmitter and the channel are free. Call from loop().
+		*/
+		static void process();
+
+		/**
+		* Number of devices with repeats left to send.
+		*/
+		static byte pending();
+
+		/**
+		* Number of commands replaced by a newer command for the same device, and number of
+		* turns postponed because the channel was busy, since the last resetStatistics().
+		*/
+		static unsigned int getCoalesced();
+		static unsigned int getDeferrals();
+		static void resetStatistics();
+
+	private:
+		struct Slot {
+			byte codec;
+			byte uaddr;
+			unsigned long gaddr;
+			byte remaining;						// Repeats left to send, 0 if the slot is free
+			byte burst;							// Repeats per turn
+			PulseFrame frame;
+		};
+
+		static Slot _slots[TX_SLOTS];
+		static byte _next;						// Slot that gets the next turn
+		static TxChannelBusy _channelBusy;
+		static boolean _sent;					// A turn was queued, the transmitter may still be busy
+		static unsigned long _holdStart;		// Start of waiting for the channel, 0 if not waiting
+		static unsigned long _holdUntil;
+		static unsigned int _backoff;
+		static unsigned int _coalesced;
+		static unsigned int _deferrals;
+};
+
+#endif
@@ -8,8 +8,12 @@
  */
 
 #define RESET_STATE _state = -1 // Resets state to initial position.
+#define REJECT_STATE { if (_state >= 30) DecoderChain::countFrame(AURIOL, FRAME_REJECTED); RESET_STATE; } // Gives up the frame
+#define AURIOL_KEY 0xFF000000UL // Address: the frames of one sensor
 
 #include "auriolReceiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
 
 /************
 * auriolReceiver
@@ -35,7 +39,8 @@
  *
  *
  * As far as I can see, every message is sent 6 times, interval is 1 minute between (or less)
- * sending new values from the sensor.
+ * sending new values from the sensor. The repeats of a message are checked on parity and
+ * voted on by RepeatVote, and one reading per message is passed to the callback.
  *
  * PULSE defines 
  #define AURIOL_MIN_SHORT 1600
@@ -51,6 +56,7 @@ byte auriolReceiver::_minRepeats;
 auriolReceiverCallBack auriolReceiver::_callback;
 boolean auriolReceiver::_inCallback = false;
 boolean auriolReceiver::_enabled = false;
+RepeatVote auriolReceiver::_vote;
 
 void auriolReceiver::init(int8_t interrupt, byte minRepeats, auriolReceiverCallBack callback) {
 	_interrupt = interrupt;
@@ -80,6 +86,14 @@ void auriolReceiver::deinit() {
 }
 
 void auriolReceiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void auriolReceiver::handlePulse(unsigned int duration) {
 	// This method is written as compact code to keep it fast. While breaking up this method into more
 	// methods would certainly increase the readability, it would also be much slower to execute.
 	// Making calls to other methods is quite expensive on AVR. As These interrupt handlers are called
@@ -89,26 +103,15 @@ void auriolReceiver::interruptHandler() {
 		return;
 	}
 
-	static byte receivedBit;			// Contains "bit" currently receiving
 	static auriolCode receivedCode;		// Contains received code
-	static auriolCode previousCode;		// Contains previous received code
-	static byte repeats = 0;			// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
-	static unsigned int min1period, max1period, min2period, max2period;
+	static uint32_t receivedBits;		// The 32 bits of the frame
 
 	// Allow for large error-margin. ElCheapo-hardware :(
-	min1period = 1800;	// Lower limit for 1 period is 0.3 times measured period; 
+	const unsigned int min1period = 1800;	// Lower limit for 1 period is 0.3 times measured period; 
 						// high signals can "linger" a bit sometimes, making low signals quite short.
-	max1period = 2200;	// Upper limit 
-	min2period = 3800;	// Lower limit 
-	max2period = 4200;	// Upper limit 
-	
-	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
-	unsigned int duration = edgeTimeStamp[2] - edgeTimeStamp[1];
-	edgeTimeStamp[0] = edgeTimeStamp[1];
+	const unsigned int max1period = 2200;	// Upper limit 
+	const unsigned int min2period = 3800;	// Lower limit 
+	const unsigned int max2period = 4200;	// Upper limit 
 	
 	// Note that if state>=0, duration is always >= 1 period.
 	// The auriol does have a longer sync pulse, and sends out 4 bits as a start
@@ -123,14 +126,7 @@ void auriolReceiver::interruptHandler() {
 			receivedCode.min2Period = max2period;
 			receivedCode.max2Period = min2period;
 #endif
-			//receivedCode.period = duration  ; 	// 
-			receivedCode.address= 0;
-			receivedCode.n1 = 0;
-			receivedCode.n2 = 0;
-			receivedCode.channel= 0;
-			receivedCode.humidity= 0;
-			receivedCode.temperature= 0;
-			receivedCode.csum= 0;				// First pulse is even and does not count
+			receivedBits = 0;
 			//_state++;							// State is now 0, we have started
 		}
 		else {
@@ -140,7 +136,7 @@ void auriolReceiver::interruptHandler() {
 	// Do this check for every even _state
 	if (_state % 2 == 0){
 		if ((duration < 350 ) || (duration > 700)) {
-			RESET_STATE;
+			REJECT_STATE;
 			return;
 		}
 		// Else we increase _state below
@@ -148,51 +144,18 @@ void auriolReceiver::interruptHandler() {
 	// Must be an odd pulse. These are longer but within certain boundaries
 	if ( (duration < min1period) ||  (duration > max2period) 
 		|| ((duration > max1period) && (duration < min2period)) ){
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	} else
 		
-	// Begin of an address
-	if (_state < 16) { // Verify start address 0-7, are 16 pulses! Random ID
-		receivedCode.address = receivedCode.address *2;
-		if (duration > min2period) {
-			receivedCode.address +=1;
-			receivedCode.csum ^= 1;
-		}
-	} else 
-    //	Bits 8-11 are n2  bits. MSB is the battery bit
-	if (_state < 24) { 
-		receivedCode.n1 = receivedCode.n1 *2;
-		if (duration > min2period) {
-			receivedCode.n1 += 1;
-			receivedCode.csum ^= 1;
-		}
-	} else 
-	// Temperature is 12 bits, max 24 pulses	
-	if (_state < 48) { // 
-		receivedCode.temperature = receivedCode.temperature * 2;
-		if (duration > min2period) {
-			receivedCode.temperature += 1;
-			receivedCode.csum ^= 1;
-		}
-	} else
-	// Unknown use for next 7 bits, 14 pulses
-	if (_state < 62) {		// 
-		receivedCode.n2 = receivedCode.n2 *2;
-		if (duration > min2period) {
-			receivedCode.n2 += 1;
-			receivedCode.csum ^= 1;
-		}
-	} else
-	// Checksum 1 bits, 2 pulses, Actuall last bit used for parity (X-or all bits)
-	if (_state < 64) { // 
-		if (duration > min2period) {	// If a 1-bit	
-			receivedCode.csum ^= 1;		// So the result must always be 0
-		}
+	// Address 8 bits, n1 4 bits, temperature 12 bits, n2 7 bits and parity 1 bit: 32 bits, every
+	// bit is a short pulse (even state) followed by a long or longer one (odd state).
+	if (_state < 64) {
+		receivedBits = (receivedBits << 1) | (duration > min2period);
 	} else 
 	// Invalid
 	{
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 	
@@ -214,31 +177,22 @@ void auriolReceiver::interruptHandler() {
 	
 	// Message complete
 	if (_state == 64) {
-		
-		// a valid signal was found!
-		if (
-			receivedCode.address != previousCode.address ||
-			receivedCode.channel != previousCode.channel ||
-			receivedCode.temperature != previousCode.temperature ||
-			receivedCode.humidity != previousCode.humidity ||
-			receivedCode.csum != previousCode.csum 
-			) { // memcmp isn't deemed safe
-					repeats=0;
-					previousCode = receivedCode;
-		}
-				
-		repeats++;
-				
-		if (repeats>=_minRepeats) {
+		byte result = _vote.add(receivedBits, AURIOL_KEY, _minRepeats);
+		DecoderChain::countFrame(AURIOL, result);
+		if (result == FRAME_DECODED) {
+			receivedCode.address = receivedBits >> 24;
+			receivedCode.n1 = (receivedBits >> 20) & 0x0F;
+			receivedCode.temperature = (receivedBits >> 8) & 0x0FFF;
+			receivedCode.n2 = (receivedBits >> 1) & 0x7F;
+			receivedCode.channel = 0;
+			receivedCode.humidity = 0;
+			receivedCode.csum = 0;
 			if (!_inCallback) {
 				_inCallback = true;
 				(_callback)(receivedCode);
 				_inCallback = false;
 			}
-			// Reset after callback.
-			RESET_STATE;
-			return;
-		}		
+		}
 		// Reset for next round
 		RESET_STATE; 
 		return;
@@ -11,6 +11,7 @@
 #define auriolReceiver_h
 
 #include <Arduino.h>
+#include <RepeatVote.h>
 
 struct auriolCode {
 	unsigned long address;		// 8 bits Address (house code) of received code. 
@@ -19,7 +20,7 @@ struct auriolCode {
 	byte channel;				// Channel not used by this Auriol. Will be 0!
 	byte n1;					// 4 Various bits
 	byte n2;					// 4+3 bits 24-27 and 28-30
-	byte csum;					// Last bit is CRC
+	byte csum;					// Last bit is parity, always 0 when delivered
 #if STATISTICS==1
 	short min1Period;			// Statistics!
 	short max1Period;
@@ -57,7 +58,8 @@ class auriolReceiver {
 		*
 		* @param interrupt 	The interrupt as is used by Arduino's attachInterrupt function. See attachInterrupt for details.
 							If < 0, you must call interruptHandler() yourself.
-		* @param minRepeats The number of times the same code must be received in a row before the callback is called
+		* @param minRepeats The number of times the same code must be received in a burst before the callback is called.
+		*					Repeats with bit errors are corrected by a vote, see RepeatVote.
 		* @param callback Pointer to a callback function, with signature void (*func)(auriolCode)
 		*/
 		static void init(int8_t interrupt, byte minRepeats, auriolReceiverCallBack callback);
@@ -96,6 +98,15 @@ class auriolReceiver {
 		 */
 		static void interruptHandler();
 
+		/**
+		 * Decodes one pulse, i.e. the time between the previous and the current edge. Called by
+		 * interruptHandler(), or directly by DecoderChain which timestamps every edge only once
+		 * for all decoders.
+		 *
+		 * @param duration Duration of the pulse in microseconds, clipped to 65535.
+		 */
+		static void handlePulse(unsigned int duration);
+
 	private:
 
 		static int8_t _interrupt;					// Radio input interrupt
@@ -104,6 +115,7 @@ class auriolReceiver {
 		static auriolReceiverCallBack _callback;
 		static boolean _inCallback;					// When true, the callback function is being executed; prevents re-entrance.
 		static boolean _enabled;					// If true, monitoring and decoding is enabled. If false, interruptHandler will return immediately.
+		static RepeatVote _vote;					// Repeats of the current bursts
 
 };
 
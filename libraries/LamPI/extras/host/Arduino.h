@@ -0,0 +1,122 @@
+/*
+ * Arduino.h - Host (Linux) replacement of the Arduino core, just enough to compile
+ * and run the LamPI receivers and transmitters on a PC.
+ *
+ * Time is virtual: micros() and millis() return a clock that only moves when the
+ * tools call host::advance() or when the library calls delay() or delayMicroseconds().
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "binary.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define memcpy_P memcpy
+#define F(string_literal) (string_literal)
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void noInterrupts(void);
+void interrupts(void);
+
+class Print {
+	public:
+		virtual ~Print() {}
+		virtual size_t write(uint8_t c) = 0;
+		virtual size_t write(const uint8_t *buf, size_t len);
+		size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+		size_t print(const char *s);
+		size_t print(char c);
+		size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+		size_t print(int n, int base = DEC) { return print((long)n, base); }
+		size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+		size_t print(long n, int base = DEC);
+		size_t print(unsigned long n, int base = DEC);
+		size_t print(double n, int digits = 2);
+
+		size_t println() { return print("\r\n"); }
+		template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+		template <typename T> size_t println(T v, int f) { size_t n = print(v, f); return n + println(); }
+};
+
+class Stream : public Print {
+	public:
+		virtual int available() = 0;
+		virtual int read() = 0;
+		virtual int peek() = 0;
+		virtual void flush() {}
+};
+
+class HostSerial : public Stream {
+	public:
+		void begin(unsigned long baud) { (void)baud; }
+		int available() { return 0; }
+		int read() { return -1; }
+		int peek() { return -1; }
+		void flush() { fflush(stdout); }
+		size_t write(uint8_t c);
+		size_t write(const uint8_t *buf, size_t len);
+		using Print::write;
+
+		boolean quiet;						// Host only: if set, output is discarded
+};
+
+extern HostSerial Serial;
+
+// Host only: hooks for the tools that drive the library
+namespace host {
+	typedef void (*EdgeRecorder)(uint8_t pin, uint8_t level, unsigned long now);
+
+	void setTime(unsigned long us);			// Set the virtual clock
+	void advance(unsigned long us);			// Move the virtual clock forward
+	void fire(uint8_t interruptNum);		// Call the handler attached to interruptNum
+	void setRecorder(EdgeRecorder rec);		// Called on every level change of an output pin
+	unsigned long microsCalls();			// Number of micros() calls since start
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * HostArduino.cpp - Implementation of the host Arduino core. See Arduino.h for details.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include "Arduino.h"
+
+HostSerial Serial;
+
+static unsigned long _now = 0;						// Virtual clock in microseconds
+static unsigned long _microsCalls = 0;
+static uint8_t _level[64];							// Last level written to every pin
+static void (*_isr[8])(void);
+static host::EdgeRecorder _recorder = NULL;
+
+unsigned long micros(void) {
+	_microsCalls++;
+	return _now;
+}
+
+unsigned long millis(void) {
+	return _now / 1000;
+}
+
+void delay(unsigned long ms) {
+	_now += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+	_now += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	(void)pin; (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+	pin &= 63;
+	val = val ? HIGH : LOW;
+	if (_level[pin] != val) {
+		_level[pin] = val;
+		if (_recorder) _recorder(pin, val, _now);
+	}
+}
+
+int digitalRead(uint8_t pin) {
+	return _level[pin & 63];
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) {
+	(void)mode;
+	if (interruptNum < 8) _isr[interruptNum] = userFunc;
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+	if (interruptNum < 8) _isr[interruptNum] = NULL;
+}
+
+void noInterrupts(void) { }
+void interrupts(void) { }
+
+// --------------------------------------------------------------------------------
+// Serial
+//
+size_t HostSerial::write(uint8_t c) {
+	if (!quiet) putchar(c);
+	return 1;
+}
+
+size_t HostSerial::write(const uint8_t *buf, size_t len) {
+	if (!quiet) fwrite(buf, 1, len, stdout);
+	return len;
+}
+
+// --------------------------------------------------------------------------------
+// Print
+//
+size_t Print::write(const uint8_t *buf, size_t len) {
+	size_t n = 0;
+	while (len--) n += write(*buf++);
+	return n;
+}
+
+size_t Print::print(const char *s) {
+	return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(char c) {
+	return write((uint8_t)c);
+}
+
+size_t Print::print(long n, int base) {
+	if (n < 0 && base == DEC) {
+		return print('-') + print((unsigned long)-n, base);
+	}
+	return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+	char buf[8 * sizeof(long) + 1];
+	char *p = &buf[sizeof(buf) - 1];
+	*p = '\0';
+	if (base < 2) base = DEC;
+	do {
+		char c = n % base;
+		n /= base;
+		*--p = c < 10 ? c + '0' : c + 'A' - 10;
+	} while (n);
+	return print(p);
+}
+
+size_t Print::print(double n, int digits) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.*f", digits, n);
+	return print(buf);
+}
+
+// --------------------------------------------------------------------------------
+// Host hooks
+//
+void host::setTime(unsigned long us) {
+	_now = us;
+}
+
+void host::advance(unsigned long us) {
+	_now += us;
+}
+
+void host::fire(uint8_t interruptNum) {
+	if (interruptNum < 8 && _isr[interruptNum]) _isr[interruptNum]();
+}
+
+void host::setRecorder(host::EdgeRecorder rec) {
+	_recorder = rec;
+}
+
+unsigned long host::microsCalls() {
+	return _microsCalls;
+}
@@ -0,0 +1,178 @@
+/*
+ * bench.cpp - Replays 433MHz pulse traces through the LamPI receivers on a PC and measures
+ * the cost per edge, for the old InterruptChain fan-out and for DecoderChain (direct, with a
+ * DecoderSet and deferred mode).
+ *
+ * Usage:	bench [-n passes] [trace ...]
+ *
+ * Without trace files, a trace with all codecs is synthesized, see trace.h for this and for the
+ * format of trace files.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "trace.h"
+
+#include <InterruptChain.h>
+#include <DecoderChain.h>
+#include <DecoderSet.h>
+#include <LamPI.h>
+
+#include <kakuReceiver.h>
+#include <RemoteReceiver.h>
+#include <livoloReceiver.h>
+#include <kopouReceiver.h>
+#include <quhwaReceiver.h>
+#include <wt440Receiver.h>
+#include <auriolReceiver.h>
+
+#define I_CHAIN 0					// Interrupt used for the InterruptChain
+#define I_DECODER 1					// Interrupt used for the DecoderChain
+
+static std::vector<unsigned int> trace;
+static unsigned long decodes[32];
+
+// --------------------------------------------------------------------------------
+// Receiver callbacks, only count the decoded messages
+//
+static void onKaku(KakuCode c) { (void)c; decodes[KAKU]++; }
+static void onRemote(uint32_t c, unsigned int p) { (void)c; (void)p; decodes[ACTION]++; }
+static void onLivolo(livoloCode c) { (void)c; decodes[LIVOLO]++; }
+static void onKopou(kopouCode c) { (void)c; decodes[KOPOU]++; }
+static void onQuhwa(quhwaCode c) { (void)c; decodes[QUHWA]++; }
+static void onWt440(wt440Code c) { (void)c; decodes[WT440]++; }
+static void onAuriol(auriolCode c) { (void)c; decodes[AURIOL]++; }
+
+// --------------------------------------------------------------------------------
+// Replay
+//
+static inline unsigned long long cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+// In deferred mode process() is called every batch edges, as loop() would do.
+static void replay(const char *name, uint8_t interrupt, int passes, int batch = 0) {
+	memset(decodes, 0, sizeof(decodes));
+	unsigned long calls = host::microsCalls();
+	unsigned long long start = cycles();
+
+	for (int p = 0; p < passes; p++) {
+		for (size_t i = 0; i < trace.size(); i++) {
+			host::advance(trace[i]);
+			host::fire(interrupt);
+			if (batch && i % batch == 0) DecoderChain::process();
+		}
+	}
+	if (batch) DecoderChain::process();
+	unsigned long long total = cycles() - start;
+
+	unsigned long edges = trace.size() * passes;
+	printf("%-14s %8.1f %-10s %6.2f micros()/edge   decoded:", name, (double)total / edges,
+#if defined(__x86_64__) || defined(__i386__)
+		"cycles/edge",
+#else
+		"ns/edge",
+#endif
+		(double)(host::microsCalls() - calls) / edges);
+	const char *codecs[] = { "kaku", "action", 0, 0, 0, "livolo", "kopou", "quhwa" };
+	for (int i = 0; i < 32; i++) {
+		if (decodes[i] == 0) continue;
+		if (i < 8 && codecs[i]) printf(" %s=%lu", codecs[i], decodes[i] / passes);
+		else if (i == WT440) printf(" wt440=%lu", decodes[i] / passes);
+		else if (i == AURIOL) printf(" auriol=%lu", decodes[i] / passes);
+	}
+	printf("\n");
+	if (batch) {
+		printf("%-14s buffer high water %u of %u, %u overflows\n", "",
+			DecoderChain::getHighWater(), PULSE_BUFSIZE, DecoderChain::getOverflows());
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int passes = 100;
+	int i = 1;
+	if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+		passes = atoi(argv[i + 1]);
+		i += 2;
+	}
+	if (passes < 1) passes = 1;
+
+	Trace t;
+	if (i == argc) {
+		for (const char **codec = traceCodecs(); *codec; codec++) {
+			traceGenerate(*codec, t);
+		}
+	}
+	for (; i < argc; i++) {
+		if (!traceRead(argv[i], t)) return 1;
+	}
+	trace.swap(t.pulses);
+	if (trace.empty()) {
+		fprintf(stderr, "Empty trace\n");
+		return 1;
+	}
+
+	// Same minimum repeats as the ArduinoGateway sketch
+	KakuReceiver::init(-1, 2, onKaku);
+	RemoteReceiver::init(-1, 2, onRemote);
+	livoloReceiver::init(-1, 3, onLivolo);
+	kopouReceiver::init(-1, 3, onKopou);
+	quhwaReceiver::init(-1, 3, onQuhwa);
+	wt440Receiver::init(-1, 1, onWt440);
+	auriolReceiver::init(-1, 2, onAuriol);
+
+	// Old situation: every receiver on the chain, in the order of ArduinoGateway.ino
+	InterruptChain::setMode(I_CHAIN, CHANGE);
+	InterruptChain::addInterruptCallback(I_CHAIN, KakuReceiver::interruptHandler);
+	InterruptChain::addInterruptCallback(I_CHAIN, RemoteReceiver::interruptHandler);
+	InterruptChain::addInterruptCallback(I_CHAIN, livoloReceiver::interruptHandler);
+	InterruptChain::addInterruptCallback(I_CHAIN, kopouReceiver::interruptHandler);
+	InterruptChain::addInterruptCallback(I_CHAIN, quhwaReceiver::interruptHandler);
+	InterruptChain::addInterruptCallback(I_CHAIN, wt440Receiver::interruptHandler);
+	InterruptChain::addInterruptCallback(I_CHAIN, auriolReceiver::interruptHandler);
+
+	DecoderChain::init(I_DECODER);
+	DecoderChain::addDecoder(KAKU, KakuReceiver::handlePulse);
+	DecoderChain::addDecoder(ACTION, RemoteReceiver::handlePulse);
+	DecoderChain::addDecoder(LIVOLO, livoloReceiver::handlePulse);
+	DecoderChain::addDecoder(KOPOU, kopouReceiver::handlePulse);
+	DecoderChain::addDecoder(QUHWA, quhwaReceiver::handlePulse);
+	DecoderChain::addDecoder(WT440, wt440Receiver::handlePulse);
+	DecoderChain::addDecoder(AURIOL, auriolReceiver::handlePulse);
+
+	printf("%lu edges, %d passes\n", (unsigned long)trace.size(), passes);
+	replay("InterruptChain", I_CHAIN, passes);
+	replay("DecoderChain", I_DECODER, passes);
+
+	// Same decoders in the same order, but called directly. They are already in the chain, so
+	// only the dispatch is set instead of calling attach().
+	typedef DecoderSet<
+		Decoder<KAKU, KakuReceiver::handlePulse>,
+		Decoder<ACTION, RemoteReceiver::handlePulse>,
+		Decoder<LIVOLO, livoloReceiver::handlePulse>,
+		Decoder<KOPOU, kopouReceiver::handlePulse>,
+		Decoder<QUHWA, quhwaReceiver::handlePulse>,
+		Decoder<WT440, wt440Receiver::handlePulse>,
+		Decoder<AURIOL, auriolReceiver::handlePulse>
+	> Receivers;
+	DecoderChain::setDispatch(Receivers::handlePulse);
+	replay("DecoderSet", I_DECODER, passes);
+	DecoderChain::setDispatch(NULL);
+
+	DecoderChain::init(I_DECODER, true);
+	replay("Deferred", I_DECODER, passes, 32);
+	return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * gentrace.cpp - Writes a synthesized trace file for every codec, see trace.h.
+ *
+ * Usage:	gentrace [-o directory] [codec ...]
+ *
+ * Without codecs, traces are written for all codecs. The files are called <codec>.txt.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <unistd.h>
+
+#include "trace.h"
+
+static boolean generate(const char *dir, const char *codec) {
+	Trace trace;
+	if (!traceGenerate(codec, trace)) {
+		fprintf(stderr, "Unknown codec %s\n", codec);
+		return false;
+	}
+	char line[128];
+	snprintf(line, sizeof(line), "# %s trace, synthesized by gentrace", codec);
+	trace.comments.push_back(line);
+
+	char name[256];
+	snprintf(name, sizeof(name), "%s/%s.txt", dir, codec);
+	if (!traceWrite(name, trace)) return false;
+	printf("%s: %lu pulses\n", name, (unsigned long)trace.pulses.size());
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	const char *dir = ".";
+	int c;
+
+	while ((c = getopt(argc, argv, "o:")) != -1) {
+		switch (c) {
+			case 'o': dir = optarg; break;
+			default:
+				fprintf(stderr, "Usage: %s [-o directory] [codec ...]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	if (optind == argc) {
+		for (const char **codec = traceCodecs(); *codec; codec++) {
+			if (!generate(dir, *codec)) return 1;
+		}
+	}
+	for (int i = optind; i < argc; i++) {
+		if (!generate(dir, argv[i])) return 1;
+	}
+	return 0;
+}
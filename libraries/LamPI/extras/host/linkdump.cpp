@@ -0,0 +1,435 @@
+/*
+ * linkdump.cpp - Reference decoder of the binary frames of a gateway in binary mode, see
+ * HostLink.h for the format.
+ *
+ * Usage:	linkdump [-v] [capture ...]
+ *			linkdump -c command
+ *			linkdump -t
+ *
+ * Without -c and -t the frames in the captures (or stdin) are printed one per line, as the
+ * gateway would print them in text mode, so the output can be given to a daemon that only
+ * knows the text protocol:
+ *
+ *		stty -F /dev/ttyUSB0 115200 raw; ./linkdump < /dev/ttyUSB0
+ *
+ * Corrupted frames and gaps in the sequence numbers are reported on stderr, with -v also every
+ * frame in hex. Bytes before the first 0 byte, like the text reply to the command that started
+ * binary mode, are skipped.
+ *
+ * With -c the command is written to stdout as a LINK_COMMAND frame, after a 0 byte that makes
+ * the gateway drop whatever it received before:
+ *
+ *		./linkdump -c "> 1 0 2" > /dev/ttyUSB0
+ *
+ * With -t records are encoded by HostLink, as the gateway would send them, and decoded again,
+ * every frame is checked to fail the CRC after any one or two bits are flipped, and the output
+ * queue is checked to keep the order of the lines, to drop whole lines only and to keep the
+ * message of a callback apart from the line or frame it interrupted.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <LamPI.h>
+#include <HostLink.h>
+
+struct LinkStatistics {
+	unsigned long bytes;
+	unsigned long frames;
+	unsigned long errors;			// Frames that are not valid COBS, fail the CRC or are too short
+	unsigned long lost;				// Frames missing according to the sequence numbers
+};
+
+// --------------------------------------------------------------------------------
+// Decoding
+//
+static long get16(const byte *p) {
+	return (int16_t)(p[0] | p[1] << 8);
+}
+
+static long get32(const byte *p) {
+	return (int32_t)((unsigned long)p[0] | (unsigned long)p[1] << 8 | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24);
+}
+
+static std::string decimal(long value, byte decimals) {
+	char buf[24];
+	if (decimals == 0) snprintf(buf, sizeof(buf), "%ld", value);
+	else snprintf(buf, sizeof(buf), "%.*f", decimals, value / pow(10, decimals));
+	return buf;
+}
+
+// Prints the payload of a frame in the text protocol. Returns false if the payload does not fit
+// the type.
+static boolean format(const byte *f, int n, std::string &line) {
+	byte type = f[0];
+	char buf[96];
+	const byte *p = f + 2;
+	n -= 2;
+	switch (type) {
+		case LINK_TEXT:
+		case LINK_COMMAND:
+			line.assign((const char *)p, n);
+			return true;
+		case LINK_DEVICE: {
+			if (n != 8) return false;
+			long value = get16(p + 6);
+			std::string unit = p[5] == LINK_GROUP ? "G" : decimal(p[5], 0);
+			snprintf(buf, sizeof(buf), "< %u 2 %u %lu %s", f[1], p[0], (unsigned long)get32(p + 1) & 0xFFFFFFFFUL, unit.c_str());
+			line = buf;
+			if (value == LINK_ON) line += " on";
+			else if (value != LINK_DIM) line += " " + decimal(value, 0);
+			return true;
+		}
+		case LINK_SENSOR: {
+			if (n != 14) return false;
+			unsigned int address = p[2] | p[3] << 8;
+			if (p[0] == ONBOARD) snprintf(buf, sizeof(buf), "< %u 3 %u %X %u ", f[1], p[1], address, p[4]);
+			else snprintf(buf, sizeof(buf), "< %u 3 %u %u %u ", f[1], p[1], address, p[4]);
+			line = buf;
+			line += decimal(get32(p + 6), p[5]) + " " + decimal(get32(p + 10), p[5]);
+			return true;
+		}
+		case LINK_DALLAS: {
+			if (n != 9) return false;
+			snprintf(buf, sizeof(buf), "< %u 3 0 %02X-%02X%02X%02X%02X%02X%02X 0 ", f[1], p[0], p[6], p[5], p[4], p[3], p[2], p[1]);
+			line = buf;
+			line += decimal(get16(p + 7), 1) + " 0";
+			return true;
+		}
+		case LINK_ADMIN:
+			if (n != 5) return false;
+			snprintf(buf, sizeof(buf), "< %u 0 %u %lu", f[1], p[0], (unsigned long)get32(p + 1) & 0xFFFFFFFFUL);
+			line = buf;
+			return true;
+	}
+	return false;
+}
+
+class LinkDecoder {
+	public:
+		LinkDecoder(LinkStatistics &stats, boolean verbose) : _stats(stats), _verbose(verbose), _synced(false), _first(true) {}
+
+		// Returns true and the frame as text when b ends a valid frame
+		boolean feed(byte b, std::string &line) {
+			_stats.bytes++;
+			if (b != 0) {
+				_buf.push_back(b);
+				return false;
+			}
+			std::vector<byte> frame;
+			frame.swap(_buf);
+			if (!_synced) {									// Text before the first frame
+				_synced = true;
+				return false;
+			}
+			if (frame.empty()) {
+				return false;
+			}
+			if (_verbose) {
+				for (size_t i = 0; i < frame.size(); i++) fprintf(stderr, "%02X ", frame[i]);
+				fprintf(stderr, "\n");
+			}
+			int n = frame.size() <= 255 ? HostLink::decode(&frame[0], frame.size(), &frame[0]) : -1;
+			if (n < 4 || HostLink::crc16(&frame[0], n - 2) != (unsigned int)(frame[n - 2] | frame[n - 1] << 8)
+					|| !format(&frame[0], n - 2, line)) {
+				_stats.errors++;
+				fprintf(stderr, "# corrupted frame of %lu bytes\n", (unsigned long)frame.size());
+				return false;
+			}
+			_stats.frames++;
+			byte expected = _sequence + 1;
+			if (!_first && frame[1] != expected) {
+				byte gap = frame[1] - expected;
+				_stats.lost += gap;
+				fprintf(stderr, "# %u frames lost before %u\n", gap, frame[1]);
+			}
+			_first = false;
+			_sequence = frame[1];
+			return true;
+		}
+
+		void start() { _synced = true; }
+
+	private:
+		LinkStatistics &_stats;
+		boolean _verbose;
+		boolean _synced;
+		boolean _first;
+		byte _sequence;
+		std::vector<byte> _buf;
+};
+
+static void decodeFile(FILE *f, LinkStatistics &stats, boolean verbose) {
+	LinkDecoder decoder(stats, verbose);
+	std::string line;
+	int c;
+	while ((c = getc(f)) != EOF) {
+		if (decoder.feed(c, line)) {
+			printf("%s\n", line.c_str());
+			fflush(stdout);
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------
+// Encoding, with the library code that runs on the gateway
+//
+class BufferStream : public Stream {
+	public:
+		std::vector<byte> data;
+
+		size_t write(uint8_t c) { data.push_back(c); return 1; }
+		size_t write(const uint8_t *buf, size_t len) { data.insert(data.end(), buf, buf + len); return len; }
+		using Print::write;
+		int available() { return 0; }
+		int read() { return -1; }
+		int peek() { return -1; }
+};
+
+// A LINK_COMMAND frame, as the daemon sends it, with the 0 byte after it. out must have room
+// for LINK_FRAME + 6 bytes.
+static byte commandFrame(const char *command, byte *out) {
+	byte frame[LINK_FRAME + 4];
+	byte n = strlen(command) < LINK_FRAME ? strlen(command) : LINK_FRAME;
+	frame[0] = LINK_COMMAND;
+	frame[1] = 0;
+	memcpy(frame + 2, command, n);
+	unsigned int crc = HostLink::crc16(frame, n + 2);
+	frame[n + 2] = crc & 0xFF;
+	frame[n + 3] = crc >> 8;
+	byte m = HostLink::encode(frame, n + 4, out);
+	out[m++] = 0;
+	return m;
+}
+
+static int writeCommand(const char *command) {
+	byte out[LINK_FRAME + 6];
+	byte n = commandFrame(command, out);
+	putchar(0);
+	fwrite(out, 1, n, stdout);
+	return 0;
+}
+
+static boolean check(const char *what, boolean ok) {
+	printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+static boolean selfTest() {
+	BufferStream out;
+	HostLink link(out);
+	boolean ok = true;
+
+	link.print(F("< 1 0 10 1"));						// Text mode: unchanged
+	link.println();
+	ok &= check("text mode", std::string(out.data.begin(), out.data.end()) == "< 1 0 10 1\r\n");
+	out.data.clear();
+
+	link.setBinary(true);
+	const byte rom[7] = { 0x28, 0x2C, 0x1B, 0x7A, 0x05, 0x00, 0x00 };
+	link.sendDevice(KAKU, 12345678, 1, LINK_ON);
+	link.sendDevice(KAKU, 12345678, LINK_GROUP, 0);
+	link.sendDevice(LIVOLO, 6400, 10, 5);
+	link.sendSensor(WT440, 1, 5, 0, 9280, 55, 0);
+	link.sendSensor(ONBOARD, 0, 0x40, 0, 215, 552, 1);
+	link.sendSensor(AURIOL, 8, 77, 0, -35, 0, 0);
+	link.sendDallas(rom, 214);
+	link.sendAdmin(3, 1);
+	link.print(F("! Debug ON, a line that is longer than one frame can hold"));
+	link.println();
+	const char *expected[] = {
+		"< 0 2 0 12345678 1 on", "< 1 2 0 12345678 G 0", "< 2 2 5 6400 10 5",
+		"< 3 3 1 5 0 9280 55", "< 4 3 0 40 0 21.5 55.2", "< 5 3 8 77 0 -35 0",
+		"< 6 3 0 28-0000057A1B2C 0 21.4 0", "< 7 0 3 1",
+		"! Debug ON, a line that is longe", "r than one frame can hold"
+	};
+	const size_t count = sizeof(expected) / sizeof(expected[0]);
+
+	LinkStatistics stats = { 0 };
+	LinkDecoder decoder(stats, false);
+	decoder.start();
+	std::string line;
+	size_t n = 0;
+	boolean same = true;
+	for (size_t i = 0; i < out.data.size(); i++) {
+		if (decoder.feed(out.data[i], line)) {
+			if (n >= count || line != expected[n]) {
+				printf("got \"%s\", expected \"%s\"\n", line.c_str(), n < count ? expected[n] : "");
+				same = false;
+			}
+			n++;
+		}
+	}
+	ok &= check("records", same && n == count && stats.errors == 0 && stats.lost == 0);
+	printf("%lu bytes in %lu frames\n", stats.bytes, stats.frames);
+
+	// Every frame must fail after flipping any one or two bits of its payload or CRC
+	unsigned long tried = 0, missed = 0;
+	size_t start = 0;
+	for (size_t end = 0; end < out.data.size(); end++) {
+		if (out.data[end] != 0) continue;
+		byte frame[64];
+		int len = HostLink::decode(&out.data[start], end - start, frame);
+		for (int i = 0; i < len * 8; i++) {
+			for (int j = i; j < len * 8; j++) {
+				byte f[64];
+				memcpy(f, frame, len);
+				f[i / 8] ^= 1 << (i % 8);
+				if (j != i) f[j / 8] ^= 1 << (j % 8);
+				tried++;
+				if (HostLink::crc16(f, len - 2) == (unsigned int)(f[len - 2] | f[len - 1] << 8)) missed++;
+			}
+		}
+		start = end + 1;
+	}
+	printf("%lu corruptions, %lu not detected\n", tried, missed);
+	ok &= check("crc", missed == 0);
+
+	// Commands: a valid frame, a corrupted frame, a frame after text garbage
+	byte encoded[LINK_FRAME + 6];
+	byte m = commandFrame("> 1 0 4", encoded);
+
+	BufferStream cmd;
+	HostLink gateway(cmd);
+	gateway.setBinary(true);
+	char received[32];
+	int commands = 0;
+	const char *garbage = "> 1 0 4\n";
+	for (const char *p = garbage; *p; p++) gateway.receive(*p, received, sizeof(received));
+	gateway.receive(0, received, sizeof(received));						// Resync
+	for (byte i = 0; i < m; i++) commands += gateway.receive(encoded[i], received, sizeof(received));
+	boolean same1 = strcmp(received, "> 1 0 4") == 0;
+	encoded[3] ^= 0x10;
+	for (byte i = 0; i < m; i++) commands += gateway.receive(encoded[i], received, sizeof(received));
+	ok &= check("commands", commands == 1 && same1 && gateway.getErrors() == 2);
+
+	// Queue: nothing is written before process(), a line that does not fit is dropped whole, the
+	// lines come out in order when written a few bytes at a time
+	BufferStream slow;
+	HostLink queued(slow);
+	queued.setQueue(true);
+	std::string sent;
+	for (int i = 0; i < 20; i++) {
+		std::string l = "< " + decimal(i, 0) + " 3 0 40 0 ";
+		queued.print(l.c_str());
+		queued.printFixed(-i * 7, 1);
+		queued.println();
+		if (queued.getDropped() == 0) sent += l + decimal(-i * 7, 1) + "\r\n";
+	}
+	boolean waited = slow.data.empty();
+	unsigned int dropped = queued.getDropped();
+	while (!queued.isBinary() && slow.data.size() < sent.size()) {
+		size_t before = slow.data.size();
+		queued.process(5);
+		if (slow.data.size() == before) break;
+	}
+	queued.setBinary(true);
+	queued.sendAdmin(2, 0);
+	queued.flush();
+	std::string text(slow.data.begin(), slow.data.begin() + sent.size());
+	printf("%u lines dropped, high water %u of %u lines\n", dropped, queued.getHighWater(), LINK_LINES);
+	ok &= check("queue", waited && dropped > 0 && text == sent && slow.data.size() == sent.size() + 11);
+
+	// Nesting: a callback that interrupts loop() in the middle of a line has its message queued
+	// whole, before the line of loop(). A message nested deeper than LINK_DEPTH is dropped.
+	BufferStream nest;
+	HostLink nested(nest);
+	nested.setQueue(true);
+	nested.print(F("< 1 3 0 40 0 "));
+	nested.open();
+	nested.println(F("< 2 2 0 12345678 1 on"));
+	for (byte i = 1; i < LINK_DEPTH; i++) nested.open();
+	nested.println(F("< 3 lost"));
+	for (byte i = 1; i < LINK_DEPTH; i++) nested.close();
+	nested.close();
+	nested.printFixed(215, 1);
+	nested.println();
+	nested.flush();
+	text.assign(nest.data.begin(), nest.data.end());
+	ok &= check("nested", text == "< 2 2 0 12345678 1 on\r\n< 1 3 0 40 0 21.5\r\n" && nested.getDropped() == 1);
+
+	// The same in binary mode: the frame of loop() is not ended by the frames of the callback,
+	// every frame comes out whole with a valid CRC, and the sequence numbers follow the order
+	// in which the frames are sent
+	BufferStream nestBinary;
+	HostLink binary(nestBinary);
+	binary.setBinary(true);
+	binary.setQueue(true);
+	binary.print(F("! Loop "));
+	binary.open();
+	binary.sendDevice(KAKU, 12345678, 1, LINK_ON);
+	binary.println(F("! Callback"));
+	binary.close();
+	binary.println(F("line"));
+	binary.sendSensor(ONBOARD, 0, 0x40, 0, 215, 552, 1);
+	binary.flush();
+	const char *frames[] = { "< 0 2 0 12345678 1 on", "! Callback", "! Loop line", "< 3 3 0 40 0 21.5 55.2" };
+	LinkStatistics nestStats = { 0 };
+	LinkDecoder nestDecoder(nestStats, false);
+	nestDecoder.start();
+	n = 0;
+	same = true;
+	for (size_t i = 0; i < nestBinary.data.size(); i++) {
+		if (nestDecoder.feed(nestBinary.data[i], line)) {
+			if (n >= 4 || line != frames[n]) {
+				printf("got \"%s\", expected \"%s\"\n", line.c_str(), n < 4 ? frames[n] : "");
+				same = false;
+			}
+			n++;
+		}
+	}
+	ok &= check("nested frames", same && n == 4 && nestStats.errors == 0 && nestStats.lost == 0);
+	return ok;
+}
+
+static int usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-v] [capture ...]\n", name);
+	fprintf(stderr, "       %s -c command\n", name);
+	fprintf(stderr, "       %s -t\n", name);
+	return 2;
+}
+
+int main(int argc, char *argv[]) {
+	boolean verbose = false, test = false;
+	const char *command = NULL;
+	int c;
+
+	while ((c = getopt(argc, argv, "vc:t")) != -1) {
+		switch (c) {
+			case 'v': verbose = true; break;
+			case 'c': command = optarg; break;
+			case 't': test = true; break;
+			default:
+				return usage(argv[0]);
+		}
+	}
+
+	if (test) {
+		return selfTest() ? 0 : 1;
+	}
+	if (command != NULL) {
+		return writeCommand(command);
+	}
+
+	LinkStatistics stats = { 0 };
+	if (optind == argc) {
+		decodeFile(stdin, stats, verbose);
+	}
+	for (int i = optind; i < argc; i++) {
+		FILE *f = fopen(argv[i], "rb");
+		if (f == NULL) {
+			perror(argv[i]);
+			return 1;
+		}
+		decodeFile(f, stats, verbose);
+		fclose(f);
+	}
+	fprintf(stderr, "%lu bytes, %lu frames, %lu corrupted, %lu lost\n", stats.bytes, stats.frames, stats.errors, stats.lost);
+	return 0;
+}
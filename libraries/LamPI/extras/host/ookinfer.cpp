@@ -0,0 +1,624 @@
+/*
+ * ookinfer.cpp - Infers the protocol of an on-off keyed remote or sensor from a trace, and
+ * writes the rows of the protocol table of OokReceiver.
+ *
+ * Usage:	ookinfer [-v] [-c] [-k codec] [-r repeats] [-o table.h] trace ...
+ *
+ * The traces are read as one trace, so several captures of the same remote can be combined.
+ * The steps:
+ *
+ *	1. The pulse widths are clustered: a histogram with bins of 5%, neighbouring bins that are
+ *	   well above the noise floor form a cluster.
+ *	2. Every cluster is tried as the sync gap. A frame is the run of pulses after a sync pulse
+ *	   that all fall in clusters narrower than the sync. A run often ends in receiver noise, so
+ *	   the frame length is the length at which the start of most runs is repeated; the frames
+ *	   that were received at least twice are the messages. A long gap that is not a cluster,
+ *	   like the pause between the bursts of a sensor without a sync pulse, starts a frame too.
+ *	3. The encoding is found from the classes of the pulses of the messages: a fixed number of
+ *	   pulses per bit (PWM, PPM, tri-state) with two patterns, the grouping that gives the
+ *	   fewest bits; else biphase (a 1 is two short pulses, a 0 one long pulse); else
+ *	   Manchester.
+ *	4. Of the syncs with an encoding, the one whose frames cover most pulses is taken, then the
+ *	   next one that is not a pulse of a protocol taken and has none of their syncs as a pulse
+ *	   (the long gap between repeats is a sync too, of frames that contain the real sync).
+ *
+ * For every protocol found the row is printed, as a C initializer for a table in the sketch
+ * and as the argument of the OOK admin command of the ESP gateway. With -o the table is written
+ * as a header for the sketch. With -c the trace is decoded by OokReceiver with the new table and
+ * every message must be found; make check does this for the synthesized traces.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <unistd.h>
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include "trace.h"
+#include <OokReceiver.h>
+#include <LamPI.h>
+
+#define MIN_WIDTH 60				// Shorter pulses are receiver noise
+#define BIN_RATIO 1.05				// Width of a histogram bin
+#define MIN_FRAME 8					// Pulses in the shortest frame
+#define SYNC_RATIO 1.4				// A sync is at least this much longer than the widest pulse
+#define TOLERANCE 30				// Default tolerance of the widths, in percent
+
+static boolean verbose = false;
+
+struct Cluster {
+	unsigned int min;
+	unsigned int max;
+	unsigned long count;
+	double width;
+};
+
+struct Protocol {
+	int sync;						// Cluster of the sync
+	size_t length;					// Pulses per frame
+	std::vector<size_t> frames;		// Index of the first pulse of every frame of the messages
+	std::map<std::string, int> messages;	// Classes of the pulses of a frame, and repeats
+	std::vector<int> classes;		// Clusters used by the frames, narrowest first
+	boolean gaps;					// Some frames start after a long gap instead of the sync
+	OokProtocol row;
+	std::set<unsigned long> codes;	// Codes of the messages
+	std::set<unsigned long> decoded;// Codes decoded by OokReceiver, with -c
+};
+
+static std::vector<Cluster> clusters;
+
+// --------------------------------------------------------------------------------
+// 1. Clusters
+//
+static int bin(unsigned int width) {
+	return (int)(log((double)width) / log(BIN_RATIO));
+}
+
+static void findClusters(const std::vector<unsigned int> &pulses) {
+	std::map<int, unsigned long> histogram;
+	unsigned long total = 0;
+	for (size_t i = 0; i < pulses.size(); i++) {
+		if (pulses[i] >= MIN_WIDTH && pulses[i] < 0xFFFF) {
+			histogram[bin(pulses[i])]++;
+			total++;
+		}
+	}
+	unsigned long floor = total / 300 > 2 ? total / 300 : 2;
+
+	// Neighbouring bins above the floor, a gap of one bin is allowed
+	std::vector<std::pair<int, int> > ranges;
+	for (std::map<int, unsigned long>::iterator it = histogram.begin(); it != histogram.end(); ++it) {
+		if (it->second < floor) continue;
+		if (!ranges.empty() && it->first - ranges.back().second <= 2) {
+			ranges.back().second = it->first;
+		}
+		else {
+			ranges.push_back(std::make_pair(it->first, it->first));
+		}
+	}
+
+	for (size_t r = 0; r < ranges.size(); r++) {
+		Cluster c = { 0xFFFF, 0, 0, 0 };
+		double sum = 0;
+		for (size_t i = 0; i < pulses.size(); i++) {
+			if (pulses[i] < MIN_WIDTH || pulses[i] == 0xFFFF) continue;
+			int b = bin(pulses[i]);
+			if (b < ranges[r].first || b > ranges[r].second) continue;
+			if (pulses[i] < c.min) c.min = pulses[i];
+			if (pulses[i] > c.max) c.max = pulses[i];
+			c.count++;
+			sum += pulses[i];
+		}
+		c.width = sum / c.count;
+		clusters.push_back(c);
+	}
+}
+
+static int classify(unsigned int width) {
+	for (size_t c = 0; c < clusters.size(); c++) {
+		if (width >= clusters[c].min && width <= clusters[c].max) return c;
+	}
+	return -1;
+}
+
+// --------------------------------------------------------------------------------
+// 2. Sync and frames
+//
+static boolean findFrames(const std::vector<unsigned int> &pulses, const std::vector<int> &cls,
+		int sync, Protocol &p) {
+	std::vector<std::pair<size_t, size_t> > runs;
+	for (size_t i = 0; i < pulses.size(); i++) {
+		// A long gap that is no cluster, like the pause between two bursts, is a sync as well
+		if (cls[i] != sync && (cls[i] >= 0 || pulses[i] < clusters[sync].max)) continue;
+		size_t j = i + 1;
+		while (j < pulses.size() && cls[j] >= 0 && clusters[cls[j]].width * SYNC_RATIO < clusters[sync].width) {
+			j++;
+		}
+		if (j - i - 1 >= MIN_FRAME) {
+			runs.push_back(std::make_pair(i + 1, j - i - 1));
+		}
+	}
+	if (runs.empty()) return false;
+
+	// A run often ends in noise, so the frame is the part that repeats: the length for which
+	// most pulses are in runs that start the same as another run.
+	std::vector<std::string> strings;
+	for (size_t r = 0; r < runs.size(); r++) {
+		std::string s;
+		for (size_t k = 0; k < runs[r].second; k++) {
+			s += (char)cls[runs[r].first + k];
+		}
+		strings.push_back(s);
+	}
+	std::set<size_t> lengths;
+	for (size_t r = 0; r < strings.size(); r++) {
+		for (size_t q = r + 1; q < strings.size(); q++) {
+			size_t k = 0;
+			while (k < strings[r].size() && k < strings[q].size() && strings[r][k] == strings[q][k]) k++;
+			if (k >= MIN_FRAME) lengths.insert(k);
+		}
+	}
+	size_t length = 0, covered = 0;
+	for (std::set<size_t>::iterator it = lengths.begin(); it != lengths.end(); ++it) {
+		std::map<std::string, int> prefixes;
+		for (size_t r = 0; r < strings.size(); r++) {
+			if (strings[r].size() >= *it) prefixes[strings[r].substr(0, *it)]++;
+		}
+		size_t n = 0;
+		for (std::map<std::string, int>::iterator pr = prefixes.begin(); pr != prefixes.end(); ++pr) {
+			if (pr->second > 1) n += pr->second;
+		}
+		if (n * *it > covered) {
+			covered = n * *it;
+			length = *it;
+		}
+	}
+	if (length == 0) return false;
+
+	p.sync = sync;
+	p.length = length;
+	std::map<std::string, std::vector<size_t> > frames;
+	for (size_t r = 0; r < runs.size(); r++) {
+		if (strings[r].size() >= length) {
+			frames[strings[r].substr(0, length)].push_back(runs[r].first);
+		}
+	}
+	p.gaps = false;
+
+	// Messages are frames that were repeated, a frame seen once may have a bit error
+	std::set<int> used;
+	for (std::map<std::string, std::vector<size_t> >::iterator it = frames.begin(); it != frames.end(); ++it) {
+		if (it->second.size() < 2) continue;
+		p.messages[it->first] = it->second.size();
+		p.frames.insert(p.frames.end(), it->second.begin(), it->second.end());
+		for (size_t f = 0; f < it->second.size(); f++) {
+			if (cls[it->second[f] - 1] != sync) p.gaps = true;
+		}
+		for (size_t k = 0; k < length; k++) {
+			used.insert(it->first[k]);
+		}
+	}
+	// Clusters are sorted by width, so the classes are too
+	p.classes.assign(used.begin(), used.end());
+	return !p.messages.empty() && p.classes.size() <= OOK_CLASSES;
+}
+
+// --------------------------------------------------------------------------------
+// 3. Encoding
+//
+static byte classOf(const Protocol &p, char cluster) {
+	for (byte c = 0; c < p.classes.size(); c++) {
+		if (p.classes[c] == cluster) return c;
+	}
+	return OOK_CLASSES;
+}
+
+// Groups the pulses of every message in symbols of n pulses, after skipping o pulses, and
+// counts the patterns of the symbols
+static std::map<byte, size_t> patterns(const Protocol &p, byte n, byte o, size_t &symbols) {
+	std::map<byte, size_t> found;
+	symbols = (p.length - o) / n;
+	for (std::map<std::string, int>::const_iterator it = p.messages.begin(); it != p.messages.end(); ++it) {
+		for (size_t s = 0; s < symbols; s++) {
+			byte pattern = 0;
+			for (byte k = 0; k < n; k++) {
+				pattern = (pattern << 2) | classOf(p, it->first[o + s * n + k]);
+			}
+			found[pattern]++;
+		}
+	}
+	return found;
+}
+
+static boolean inferPulses(Protocol &p) {
+	byte best = 0, bestSkip = 0;
+	size_t bestSymbols = 0;
+	byte zero = 0, one = 0;
+	for (byte n = 1; n <= 4; n *= 2) {
+		for (byte o = 0; o < n; o++) {
+			size_t symbols;
+			std::map<byte, size_t> found = patterns(p, n, o, symbols);
+			if (found.size() != 2) continue;
+			byte a = found.begin()->first, b = found.rbegin()->first;
+
+			// Two patterns that come as AB or BA are the halves of a bit of twice the length. A
+			// few other pairs are allowed, for a special bit like the dim bit of Kaku.
+			byte m = n;
+			while (2 * m <= 4) {
+				size_t doubled, total = 0;
+				std::map<byte, size_t> pairs = patterns(p, 2 * m, o, doubled);
+				byte ab = (a << (2 * m)) | b, ba = (b << (2 * m)) | a;
+				for (std::map<byte, size_t>::iterator it = pairs.begin(); it != pairs.end(); ++it) {
+					total += it->second;
+				}
+				if (pairs[ab] == 0 || pairs[ba] == 0 || 10 * (pairs[ab] + pairs[ba]) < 9 * total) break;
+				m *= 2;
+				symbols = doubled;
+				a = ab < ba ? ab : ba;
+				b = ab < ba ? ba : ab;
+			}
+			if (symbols < MIN_FRAME / 2 || (best != 0 && symbols >= bestSymbols)) continue;
+			best = m;
+			bestSkip = o;
+			bestSymbols = symbols;
+			zero = a;
+			one = b;
+		}
+	}
+	if (best == 0) return false;
+
+	p.row.encoding = OOK_PULSES;
+	p.row.pulses = best;
+	p.row.skip = bestSkip;
+	// The pattern that has the shorter pulse first is the 0
+	p.row.zero = zero;
+	p.row.one = one;
+	if (bestSymbols > 32) {
+		p.row.skip += (bestSymbols - 32) * best;		// Keep the last 32 bits
+		bestSymbols = 32;
+	}
+	p.row.bits = bestSymbols;
+	return true;
+}
+
+static boolean longIsDouble(const Protocol &p) {
+	if (p.classes.size() != 2) return false;
+	double ratio = clusters[p.classes[1]].width / clusters[p.classes[0]].width;
+	return ratio > 1.6 && ratio < 2.4;
+}
+
+// Parses a message as biphase, from pulse o on. Returns the number of bits, 0 if it is not biphase.
+static size_t biphase(const Protocol &p, const std::string &m, size_t o, std::vector<size_t> &starts) {
+	size_t bits = 0;
+	size_t k = o;
+	starts.clear();
+	while (k < p.length) {
+		starts.push_back(k);
+		if (classOf(p, m[k]) == 1) {
+			k++;
+		}
+		else if (k + 1 < p.length && classOf(p, m[k + 1]) == 0) {
+			k += 2;
+		}
+		else if (k + 1 == p.length) {
+			starts.pop_back();						// A trailing pulse is allowed
+			break;
+		}
+		else {
+			return 0;
+		}
+		bits++;
+	}
+	return bits;
+}
+
+static boolean inferBiphase(Protocol &p) {
+	if (!longIsDouble(p)) return false;
+	for (size_t o = 0; o < 2; o++) {
+		size_t bits = 0;
+		std::vector<size_t> starts;
+		for (std::map<std::string, int>::iterator it = p.messages.begin(); it != p.messages.end(); ++it) {
+			size_t b = biphase(p, it->first, o, starts);
+			if (b == 0 || (bits != 0 && b != bits)) {
+				bits = 0;
+				break;
+			}
+			bits = b;
+		}
+		if (bits < 8) continue;
+		p.row.encoding = OOK_BIPHASE;
+		p.row.skip = o;
+		if (bits > 32) {
+			p.row.skip = starts[bits - 32];			// Keep the last 32 bits
+			bits = 32;
+		}
+		p.row.bits = bits;
+		return true;
+	}
+	return false;
+}
+
+static boolean inferManchester(Protocol &p) {
+	if (!longIsDouble(p)) return false;
+	for (size_t o = 0; o < 2; o++) {
+		size_t bits = 0;
+		for (std::map<std::string, int>::iterator it = p.messages.begin(); it != p.messages.end(); ++it) {
+			std::vector<byte> halves;
+			byte level = HIGH;
+			for (size_t k = 0; k < p.length; k++) {
+				for (byte h = 0; h <= classOf(p, it->first[k]); h++) halves.push_back(level);
+				level ^= 1;
+			}
+			size_t b;
+			for (b = 0; o + 2 * b + 1 < halves.size(); b++) {
+				if (halves[o + 2 * b] == halves[o + 2 * b + 1]) break;
+			}
+			if (o + 2 * b + 1 < halves.size() && o + 2 * b + 2 < halves.size()) {
+				b = 0;								// Only the last half bit may be missing
+			}
+			if (b == 0 || (bits != 0 && b != bits)) {
+				bits = 0;
+				break;
+			}
+			bits = b;
+		}
+		if (bits < 8) continue;
+		p.row.encoding = OOK_MANCHESTER;
+		p.row.skip = o;
+		if (bits > 32) {
+			p.row.skip += 2 * (bits - 32);
+			bits = 32;
+		}
+		p.row.bits = bits;
+		return true;
+	}
+	return false;
+}
+
+// Widths, tolerance and sync range of the row
+static void fillRow(const std::vector<unsigned int> &pulses, Protocol &p, byte codec, byte repeats) {
+	p.row.codec = codec;
+	p.row.minRepeats = repeats;
+	double sum[OOK_CLASSES] = { 0 };
+	unsigned long count[OOK_CLASSES] = { 0 };
+	for (size_t f = 0; f < p.frames.size(); f++) {
+		for (size_t k = 0; k < p.length; k++) {
+			unsigned int w = pulses[p.frames[f] + k];
+			byte c = classOf(p, classify(w));
+			if (c < OOK_CLASSES) {
+				sum[c] += w;
+				count[c]++;
+			}
+		}
+	}
+	double tolerance = TOLERANCE;
+	for (byte c = 0; c < OOK_CLASSES; c++) {
+		p.row.width[c] = c < p.classes.size() ? (unsigned int)(sum[c] / count[c] + 0.5) : 0;
+		if (c > 0 && p.row.width[c] > 0) {
+			// The ranges of neighbouring widths must not overlap
+			double ratio = (double)p.row.width[c] / p.row.width[c - 1];
+			double limit = 90 * (ratio - 1) / (ratio + 1);
+			if (limit < tolerance) tolerance = limit;
+		}
+	}
+	p.row.tolerance = (byte)tolerance;
+
+	unsigned int widest = p.row.width[p.classes.size() - 1];
+	double lowest = widest * (1 + tolerance / 100) + 1;
+	double syncMin = clusters[p.sync].width * (1 - TOLERANCE / 100.0);
+	double syncMax = clusters[p.sync].width * (1 + TOLERANCE / 100.0);
+	p.row.syncMin = (unsigned int)(syncMin > lowest ? syncMin : lowest);
+	p.row.syncMax = syncMax > 0xFFFE ? 0xFFFE : (unsigned int)syncMax;
+	if (p.row.syncMin > clusters[p.sync].min) p.row.syncMin = clusters[p.sync].min;
+	if (p.row.syncMax < clusters[p.sync].max) p.row.syncMax = clusters[p.sync].max;
+	if (p.gaps) p.row.syncMax = 0xFFFF;
+}
+
+// --------------------------------------------------------------------------------
+// Decoding with OokReceiver
+//
+static Protocol *decoding[OOK_PROTOCOLS];
+
+static void showOokCode(OokCode code) {
+	decoding[code.protocol]->decoded.insert(code.code);
+	if (verbose) printf("  decoded: protocol %u code 0x%08lX\n", code.protocol, code.code);
+}
+
+// The codes of the messages, by the same decoder
+static void messageCodes(const std::vector<unsigned int> &pulses, Protocol &p) {
+	OokReceiver::init(showOokCode);
+	OokProtocol row = p.row;
+	row.minRepeats = 1;
+	OokReceiver::setProtocol(0, row);
+	decoding[0] = &p;
+	for (size_t f = 0; f < p.frames.size(); f++) {
+		OokReceiver::handlePulse(pulses[p.frames[f] - 1]);
+		for (size_t k = 0; k < p.length; k++) {
+			OokReceiver::handlePulse(pulses[p.frames[f] + k]);
+		}
+	}
+	p.codes = p.decoded;
+	p.decoded.clear();
+	row.bits = 0;
+	OokReceiver::setProtocol(0, row);
+}
+
+static const char *encodingName(byte encoding) {
+	switch (encoding) {
+		case OOK_PULSES: return "OOK_PULSES";
+		case OOK_BIPHASE: return "OOK_BIPHASE";
+		default: return "OOK_MANCHESTER";
+	}
+}
+
+static void printRow(FILE *f, const OokProtocol &r, const char *indent) {
+	fprintf(f, "%s{ %u, %s, %u, %u, { %u, %u, %u }, %u, %u, %u, 0x%02X, 0x%02X, %u, %u },\n", indent,
+		r.codec, encodingName(r.encoding), r.syncMin, r.syncMax, r.width[0], r.width[1], r.width[2],
+		r.tolerance, r.skip, r.pulses, r.zero, r.one, r.bits, r.minRepeats);
+}
+
+static void report(const Protocol &p, byte index) {
+	const OokProtocol &r = p.row;
+	printf("Protocol %u: sync %.0f us (%u-%u), %lu frames of %lu pulses, %lu messages\n", index,
+		clusters[p.sync].width, r.syncMin, r.syncMax, (unsigned long)p.frames.size(),
+		(unsigned long)p.length, (unsigned long)p.messages.size());
+	printf("  widths %u %u %u us, tolerance %u%%\n", r.width[0], r.width[1], r.width[2], r.tolerance);
+	if (r.encoding == OOK_PULSES) {
+		printf("  %u pulses per bit, 0 = 0x%02X, 1 = 0x%02X, ", r.pulses, r.zero, r.one);
+	}
+	else {
+		printf("  %s, ", r.encoding == OOK_BIPHASE ? "biphase" : "Manchester");
+	}
+	printf("%u bits after skipping %u %s\n", r.bits, r.skip, r.encoding == OOK_MANCHESTER ? "half bits" : "pulses");
+	for (std::set<unsigned long>::const_iterator it = p.codes.begin(); it != p.codes.end(); ++it) {
+		printf("  code 0x%08lX\n", *it);
+	}
+	printRow(stdout, r, "  row: ");
+	printf("  ESP:  /OOK=%u:%u:%u:%u:%u:%u:%u:%u:%u:%u:%u:%u:%u:%u:%u\n", index, r.codec, r.encoding,
+		r.syncMin, r.syncMax, r.width[0], r.width[1], r.width[2], r.tolerance, r.skip, r.pulses,
+		r.zero, r.one, r.bits, r.minRepeats);
+}
+
+static boolean writeTable(const char *name, const std::vector<Protocol> &found, int argc, char *argv[]) {
+	FILE *f = fopen(name, "w");
+	if (f == NULL) {
+		perror(name);
+		return false;
+	}
+	fprintf(f, "// Protocol table for OokReceiver, written by ookinfer from");
+	for (int i = 0; i < argc; i++) fprintf(f, " %s", argv[i]);
+	fprintf(f, "\n// Load it with OokReceiver::loadTable(ookTable, OOK_TABLE_SIZE)\n\n");
+	fprintf(f, "#define OOK_TABLE_SIZE %lu\n\n", (unsigned long)found.size());
+	fprintf(f, "const OokProtocol ookTable[OOK_TABLE_SIZE] PROGMEM = {\n");
+	fprintf(f, "//  codec, encoding, syncMin, syncMax, widths, tolerance, skip, pulses, zero, one, bits, minRepeats\n");
+	for (size_t i = 0; i < found.size(); i++) {
+		printRow(f, found[i].row, "\t");
+	}
+	fprintf(f, "};\n");
+	return fclose(f) == 0;
+}
+
+int main(int argc, char *argv[]) {
+	const char *out = NULL;
+	boolean check = false;
+	byte codec = OOK;
+	byte repeats = 2;
+	int c;
+
+	while ((c = getopt(argc, argv, "vco:k:r:")) != -1) {
+		switch (c) {
+			case 'v': verbose = true; break;
+			case 'c': check = true; break;
+			case 'o': out = optarg; break;
+			case 'k': codec = atoi(optarg); break;
+			case 'r': repeats = atoi(optarg); break;
+			default:
+				fprintf(stderr, "Usage: %s [-v] [-c] [-k codec] [-r repeats] [-o table.h] trace ...\n", argv[0]);
+				return 2;
+		}
+	}
+	if (optind == argc) {
+		fprintf(stderr, "No trace\n");
+		return 2;
+	}
+
+	Trace trace;
+	for (int i = optind; i < argc; i++) {
+		if (!traceRead(argv[i], trace)) return 1;
+		trace.pulses.push_back(0xFFFF);
+	}
+	const std::vector<unsigned int> &pulses = trace.pulses;
+
+	findClusters(pulses);
+	std::vector<int> cls(pulses.size());
+	for (size_t i = 0; i < pulses.size(); i++) {
+		cls[i] = classify(pulses[i]);
+	}
+	if (verbose) {
+		for (size_t k = 0; k < clusters.size(); k++) {
+			printf("Cluster %lu: %.0f us (%u-%u), %lu pulses\n", (unsigned long)k, clusters[k].width,
+				clusters[k].min, clusters[k].max, clusters[k].count);
+		}
+	}
+
+	std::vector<Protocol> candidates;
+	for (size_t k = 0; k < clusters.size(); k++) {
+		Protocol p;
+		if (!findFrames(pulses, cls, k, p)) continue;
+		memset(&p.row, 0, sizeof(p.row));
+		if (!inferPulses(p) && !inferBiphase(p) && !inferManchester(p)) {
+			if (verbose) printf("Sync %.0f us: %lu pulses per frame, no encoding found\n", clusters[k].width, (unsigned long)p.length);
+			continue;
+		}
+		candidates.push_back(p);
+	}
+
+	// The sync that explains most pulses first. A sync of a protocol that was found may not be a
+	// pulse of another one, and the other way round.
+	std::vector<Protocol> found;
+	std::vector<boolean> taken(candidates.size(), false);
+	while (found.size() < OOK_PROTOCOLS) {
+		int best = -1;
+		for (size_t i = 0; i < candidates.size(); i++) {
+			if (taken[i]) continue;
+			boolean overlaps = false;
+			for (size_t f = 0; f < found.size(); f++) {
+				const std::vector<int> &a = candidates[i].classes, &b = found[f].classes;
+				if (std::find(a.begin(), a.end(), found[f].sync) != a.end()) overlaps = true;
+				if (std::find(b.begin(), b.end(), candidates[i].sync) != b.end()) overlaps = true;
+			}
+			if (overlaps) {
+				taken[i] = true;
+				continue;
+			}
+			if (best < 0 || candidates[i].frames.size() * candidates[i].length > candidates[best].frames.size() * candidates[best].length) {
+				best = i;
+			}
+		}
+		if (best < 0) break;
+		taken[best] = true;
+		Protocol &p = candidates[best];
+		fillRow(pulses, p, codec, repeats);
+		messageCodes(pulses, p);
+		found.push_back(p);
+	}
+
+	if (found.empty()) {
+		printf("No protocol found\n");
+		return 1;
+	}
+	for (size_t i = 0; i < found.size(); i++) {
+		report(found[i], i);
+	}
+	if (out != NULL && !writeTable(out, found, argc - optind, argv + optind)) {
+		return 1;
+	}
+
+	if (check) {
+		// Decode the whole trace with the table, as the gateway would
+		OokReceiver::init(showOokCode);
+		for (size_t i = 0; i < found.size(); i++) {
+			OokReceiver::setProtocol(i, found[i].row);
+			decoding[i] = &found[i];
+		}
+		for (size_t i = 0; i < pulses.size(); i++) {
+			OokReceiver::handlePulse(pulses[i]);
+		}
+		boolean ok = true;
+		for (size_t i = 0; i < found.size(); i++) {
+			size_t missed = 0;
+			for (std::set<unsigned long>::iterator it = found[i].codes.begin(); it != found[i].codes.end(); ++it) {
+				if (found[i].decoded.count(*it) == 0) missed++;
+			}
+			printf("Protocol %lu: %lu of %lu codes decoded by OokReceiver: %s\n", (unsigned long)i,
+				(unsigned long)(found[i].codes.size() - missed), (unsigned long)found[i].codes.size(),
+				missed == 0 && !found[i].codes.empty() ? "ok" : "FAILED");
+			if (missed > 0 || found[i].codes.empty()) ok = false;
+		}
+		return ok ? 0 : 1;
+	}
+	return 0;
+}
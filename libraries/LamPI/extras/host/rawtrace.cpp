@@ -0,0 +1,254 @@
+/*
+ * rawtrace.cpp - Converts the raw pulse stream of a gateway in capture mode to a trace file,
+ * see PulseCapture.h for the format of the stream.
+ *
+ * Usage:	rawtrace [-o trace] [capture ...]
+ *			rawtrace -e [-o capture] trace
+ *			rawtrace -t [-j jitter] trace ...
+ *
+ * Without -e the captures (or stdin) are converted to one trace, written to the -o file or to
+ * stdout. Text before the first frame marker, like the reply to the capture command, and
+ * bytes after the end of a capture are skipped, so a capture can be made with for example:
+ *
+ *		stty -F /dev/ttyUSB0 115200 raw; cat /dev/ttyUSB0 > remote.raw
+ *		nc <esp address> 8081 > remote.raw
+ *
+ * With -e the trace is encoded by PulseCapture, as the gateway would send it. With -t every
+ * trace is encoded and decoded again, the pulses must come back unchanged, and the size of the
+ * stream is reported.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <unistd.h>
+
+#include "trace.h"
+#include <PulseCapture.h>
+
+#define BAUD_BYTES 11520			// Bytes per second at 115200 baud
+
+struct RawStatistics {
+	unsigned long bytes;
+	unsigned long frames;
+	unsigned long lost;				// Number of times pulses were lost by the gateway
+	unsigned long errors;			// Invalid pulses, the decoder skipped to the next frame
+};
+
+// --------------------------------------------------------------------------------
+// Decoding
+//
+class RawDecoder {
+	public:
+		RawDecoder(Trace &trace, RawStatistics &stats) : _trace(trace), _stats(stats), _state(SKIP) {}
+
+		void feed(byte b) {
+			_stats.bytes++;
+			if (b == CAPTURE_MARK && _state == MARK && _shift == 0) {
+				frame(CAPTURE_END);					// The only value that is a 0 byte
+				return;
+			}
+			if (b == CAPTURE_MARK) {
+				_state = MARK;
+				_value = 0;
+				_shift = 0;
+				return;
+			}
+			if (_state == SKIP) {
+				return;
+			}
+			_value |= (unsigned long)(b & 0x7F) << _shift;
+			_shift += 7;
+			if (b & 0x80) {
+				if (_shift > 21) error();
+				return;
+			}
+			if (_state == MARK) {
+				frame(_value);
+			}
+			else {
+				pulse(_value);
+			}
+			_value = 0;
+			_shift = 0;
+		}
+
+	private:
+		enum { SKIP, MARK, PULSE };
+
+		Trace &_trace;
+		RawStatistics &_stats;
+		byte _state;
+		unsigned long _value;
+		byte _shift;
+		unsigned int _previous[2];
+
+		void frame(unsigned long value) {
+			if (value == CAPTURE_END) {
+				_state = SKIP;
+				return;
+			}
+			if (value == CAPTURE_LOST) {
+				_stats.lost++;
+				_trace.pulses.push_back(0xFFFF);	// Resets every decoder, as a very long pulse does
+				_state = SKIP;						// A frame marker follows
+				return;
+			}
+			if (value > 0xFFFF) {
+				error();
+				return;
+			}
+			_stats.frames++;
+			_trace.pulses.push_back(value);
+			_previous[0] = 0;
+			_previous[1] = 0;
+			_state = PULSE;
+		}
+
+		void pulse(unsigned long value) {
+			value--;
+			long delta = value & 1 ? -(long)((value + 1) >> 1) : (long)(value >> 1);
+			long duration = _previous[0] + delta;
+			if (duration < 1 || duration > 0xFFFF) {
+				error();
+				return;
+			}
+			_trace.pulses.push_back(duration);
+			_previous[0] = _previous[1];
+			_previous[1] = duration;
+		}
+
+		void error() {
+			_stats.errors++;
+			_state = SKIP;
+		}
+};
+
+static boolean decodeFile(FILE *f, Trace &trace, RawStatistics &stats) {
+	RawDecoder decoder(trace, stats);
+	int c;
+	while ((c = getc(f)) != EOF) {
+		decoder.feed(c);
+	}
+	return !ferror(f);
+}
+
+// --------------------------------------------------------------------------------
+// Encoding, with the library code that runs on the gateway
+//
+static void drain(std::vector<byte> &raw) {
+	byte buf[32];
+	byte n;
+	while ((n = PulseCapture::read(buf, sizeof(buf))) > 0) {
+		raw.insert(raw.end(), buf, buf + n);
+	}
+}
+
+static void encode(const Trace &trace, std::vector<byte> &raw) {
+	PulseCapture::start();
+	for (size_t i = 0; i < trace.pulses.size(); i++) {
+		PulseCapture::handlePulse(trace.pulses[i]);
+		drain(raw);
+	}
+	PulseCapture::stop();
+	drain(raw);
+}
+
+static boolean roundTrip(const char *name, unsigned int jitter) {
+	Trace trace, back;
+	if (!traceRead(name, trace)) return false;
+	if (jitter > 0) traceDisturb(trace, 1, jitter, 0);
+
+	std::vector<byte> raw;
+	encode(trace, raw);
+	RawStatistics stats = { 0 };
+	RawDecoder decoder(back, stats);
+	for (size_t i = 0; i < raw.size(); i++) {
+		decoder.feed(raw[i]);
+	}
+
+	size_t n = trace.pulses.size();
+	boolean ok = back.pulses.size() == n && stats.errors == 0 && stats.lost == 0;
+	for (size_t i = 0; ok && i < n; i++) {
+		ok = back.pulses[i] == (trace.pulses[i] > CAPTURE_LOST ? trace.pulses[i] : CAPTURE_LOST + 1);
+	}
+	double perPulse = n > 0 ? (double)raw.size() / n : 0;
+	printf("%s: %lu pulses, %lu bytes, %.2f bytes/pulse, %lu frames, %.0f edges/s at 115200 baud: %s\n",
+		name, (unsigned long)n, (unsigned long)raw.size(), perPulse, stats.frames,
+		perPulse > 0 ? BAUD_BYTES / perPulse : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+static int usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-o trace] [capture ...]\n", name);
+	fprintf(stderr, "       %s -e [-o capture] trace\n", name);
+	fprintf(stderr, "       %s -t [-j jitter] trace ...\n", name);
+	return 2;
+}
+
+int main(int argc, char *argv[]) {
+	const char *out = "/dev/stdout";
+	boolean encodeTrace = false, test = false;
+	unsigned int jitter = 0;
+	int c;
+
+	while ((c = getopt(argc, argv, "o:etj:")) != -1) {
+		switch (c) {
+			case 'o': out = optarg; break;
+			case 'e': encodeTrace = true; break;
+			case 't': test = true; break;
+			case 'j': jitter = atoi(optarg); break;
+			default:
+				return usage(argv[0]);
+		}
+	}
+
+	if (test) {
+		boolean ok = optind < argc;
+		for (int i = optind; i < argc; i++) {
+			if (!roundTrip(argv[i], jitter)) ok = false;
+		}
+		return ok ? 0 : 1;
+	}
+
+	if (encodeTrace) {
+		Trace trace;
+		if (optind != argc - 1) return usage(argv[0]);
+		if (!traceRead(argv[optind], trace)) return 1;
+		std::vector<byte> raw;
+		encode(trace, raw);
+		FILE *f = fopen(out, "wb");
+		if (f == NULL) {
+			perror(out);
+			return 1;
+		}
+		fwrite(&raw[0], 1, raw.size(), f);
+		return fclose(f) == 0 ? 0 : 1;
+	}
+
+	Trace trace;
+	RawStatistics stats = { 0 };
+	if (optind == argc) {
+		if (!decodeFile(stdin, trace, stats)) return 1;
+	}
+	for (int i = optind; i < argc; i++) {
+		FILE *f = fopen(argv[i], "rb");
+		if (f == NULL) {
+			perror(argv[i]);
+			return 1;
+		}
+		boolean ok = decodeFile(f, trace, stats);
+		fclose(f);
+		if (!ok) return 1;
+	}
+
+	char line[128];
+	snprintf(line, sizeof(line), "# Captured, converted by rawtrace: %lu bytes, %lu frames, lost %lu times, %lu errors",
+		stats.bytes, stats.frames, stats.lost, stats.errors);
+	trace.comments.push_back(line);
+	if (!traceWrite(out, trace)) return 1;
+	fprintf(stderr, "%lu pulses, %lu frames, lost %lu times, %lu errors\n",
+		(unsigned long)trace.pulses.size(), stats.frames, stats.lost, stats.errors);
+	return 0;
+}
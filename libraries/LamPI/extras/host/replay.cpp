@@ -0,0 +1,310 @@
+/*
+ * replay.cpp - Feeds pulse traces through the interruptHandler() of every LamPI receiver and
+ * checks the decoded messages against the "#!" lines in the trace.
+ *
+ * Usage:	replay [-v] [-b] [-d] [-n runs] [-s seed] [-j jitter] [-g glitches] trace ...
+ *
+ *	-v			Print every decoded message, the frame counters of every decoder, and the Kaku
+ *				reject counters and estimates
+ *	-b			Benchmark: decoded edges per second for every decoder
+ *	-d			Drop repeated messages with DupCache, as the gateways do. Every expected message must
+ *				then be decoded exactly as often as it has a "#!" line, not only at least once
+ *	-n runs		Replay the trace runs times, every run with different noise (default 1)
+ *	-s seed		Seed of the noise of the first run (default 1)
+ *	-j jitter	Add a random error of at most jitter microseconds to every pulse
+ *	-g glitches	Split glitches of every 1000 pulses by a short spike
+ *
+ * Every run is done in a child process, so the decoders always start from a clean state.
+ * The exit status is 0 if all expected messages were decoded in every run, and no other
+ * message was decoded by the same decoders. Messages of other decoders are only reported.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <map>
+
+#include "trace.h"
+
+#include <kakuReceiver.h>
+#include <RemoteReceiver.h>
+#include <livoloReceiver.h>
+#include <kopouReceiver.h>
+#include <quhwaReceiver.h>
+#include <wt440Receiver.h>
+#include <auriolReceiver.h>
+#include <DecoderChain.h>
+#include <DupCache.h>
+#include <LamPI.h>
+
+#define DECODERS 7
+
+// The decoders in order of their interrupt number
+static const char *decoders[DECODERS] = { "kaku", "action", "livolo", "kopou", "quhwa", "wt440", "auriol" };
+
+static int output = 1;						// File descriptor the decoded messages are written to
+static boolean verbose = false;
+static boolean dedup = false;
+
+// --------------------------------------------------------------------------------
+// Receiver callbacks, print the decoded message as one line
+//
+static void message(const char *format, ...) {
+	char line[80];
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(line, sizeof(line) - 1, format, args);
+	va_end(args);
+	line[n++] = '\n';
+	if (write(output, line, n) != n) exit(2);
+}
+
+static void onKaku(KakuCode c) {
+	if (dedup && DupCache::suppress(c)) return;
+	message("kaku %lu %u %d %d %d", (unsigned long)c.address, c.unit, c.groupBit, c.switchType,
+		c.dimLevelPresent ? c.dimLevel : -1);
+}
+static void onRemote(uint32_t c, unsigned int p) {
+	if (dedup && DupCache::suppressAction(c)) return;
+	(void)p;
+	message("action %lu", (unsigned long)c);
+}
+static void onLivolo(livoloCode c) {
+	if (dedup && DupCache::suppress(c)) return;
+	message("livolo %lu %u", (unsigned long)c.address, c.unit);
+}
+static void onKopou(kopouCode c) {
+	if (dedup && DupCache::suppress(c)) return;
+	message("kopou %lu %u", (unsigned long)c.address, c.unit);
+}
+static void onQuhwa(quhwaCode c) {
+	if (dedup && DupCache::suppress(c)) return;
+	message("quhwa %lu %u", (unsigned long)c.address, c.unit);
+}
+static void onWt440(wt440Code c) {
+	if (dedup && DupCache::suppress(c)) return;
+	message("wt440 %u %u %u %d", c.address, c.channel, c.humidity, c.temperature);
+}
+static void onAuriol(auriolCode c) {
+	if (dedup && DupCache::suppress(c)) return;
+	message("auriol %lu %u %d %u", (unsigned long)c.address, c.n1, c.temperature, c.n2);
+}
+
+static void initReceivers() {
+	// Same minimum repeats as the ArduinoGateway sketch. The interrupt number is the index in decoders[]
+	KakuReceiver::init(0, 2, onKaku);
+	RemoteReceiver::init(1, 2, onRemote);
+	livoloReceiver::init(2, 3, onLivolo);
+	kopouReceiver::init(3, 3, onKopou);
+	quhwaReceiver::init(4, 3, onQuhwa);
+	wt440Receiver::init(5, 1, onWt440);
+	auriolReceiver::init(6, 2, onAuriol);
+
+	// Only for the frame counters of countFrame(), the pulses do not go through the chain
+	static const byte codecs[DECODERS] = { KAKU, ACTION, LIVOLO, KOPOU, QUHWA, WT440, AURIOL };
+	DecoderChain::init(-1);
+	DupCache::init();
+	for (uint8_t d = 0; d < DECODERS; d++) {
+		DecoderChain::addDecoder(codecs[d], NULL);
+	}
+}
+
+static void frameStatistics() {
+	DecoderStatistics s;
+	for (byte i = 0; DecoderChain::getStatistics(i, s); i++) {
+		if (s.decoded + s.rejected + s.duplicates > 0) {
+			fprintf(stderr, "  %s: %u decoded, %u rejected, %u duplicates, %u suppressed\n", decoders[i],
+				s.decoded, s.rejected, s.duplicates, s.suppressed);
+		}
+	}
+}
+
+static void kakuStatistics() {
+	KakuStatistics s;
+	KakuReceiver::getStatistics(s);
+	fprintf(stderr, "  kaku: %u accepted, %u glitches, rejects: %u start bit, %u timing, %u invalid bit"
+		" (%u narrowed)\n", s.accepted, s.glitches, s.startBit, s.timing, s.invalidBit, s.narrowed);
+	KakuEstimate e;
+	for (byte i = 0; i < KAKU_ESTIMATORS; i++) {
+		if (KakuReceiver::getEstimate(i, e)) {
+			fprintf(stderr, "  kaku remote %lu: T %u us, sigma %u us, %u frames\n",
+				(unsigned long)e.address, e.period, e.jitter, e.frames);
+		}
+	}
+}
+
+static void replay(const Trace &trace, uint8_t decoder) {
+	for (size_t i = 0; i < trace.pulses.size(); i++) {
+		host::advance(trace.pulses[i]);
+		host::fire(decoder);
+	}
+}
+
+// --------------------------------------------------------------------------------
+// Checking
+//
+static std::string codecOf(const std::string &msg) {
+	return msg.substr(0, msg.find(' '));
+}
+
+// Does one run in a child process and returns the decoded messages
+static boolean run(const Trace &trace, std::vector<std::string> &messages) {
+	int fd[2];
+	if (pipe(fd) < 0) {
+		perror("pipe");
+		return false;
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return false;
+	}
+	if (pid == 0) {
+		close(fd[0]);
+		output = fd[1];
+		initReceivers();
+		for (uint8_t d = 0; d < DECODERS; d++) {
+			replay(trace, d);
+		}
+		if (verbose) {
+			frameStatistics();
+			kakuStatistics();
+		}
+		_exit(0);
+	}
+
+	close(fd[1]);
+	FILE *f = fdopen(fd[0], "r");
+	char line[80];
+	while (fgets(line, sizeof(line), f)) {
+		line[strcspn(line, "\n")] = '\0';
+		messages.push_back(line);
+	}
+	fclose(f);
+	int status;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static boolean check(const char *name, const Trace &clean, int runs, unsigned long seed,
+		unsigned int jitter, unsigned int glitches) {
+	std::map<std::string, int> expected;	// Expected message -> number of "#!" lines
+	std::map<std::string, int> found;		// Expected message -> number of runs it was decoded in
+	std::map<std::string, int> repeated;	// Expected message -> runs it was decoded too often, -d
+	std::map<std::string, int> other;		// Other messages -> number of times decoded
+	std::map<std::string, boolean> checked;	// Codecs with expected messages
+
+	for (size_t i = 0; i < clean.expect.size(); i++) {
+		expected[clean.expect[i]]++;
+		found[clean.expect[i]] = 0;
+		repeated[clean.expect[i]] = 0;
+		checked[codecOf(clean.expect[i])] = true;
+	}
+
+	unsigned long pulses = 0;
+	for (int r = 0; r < runs; r++) {
+		Trace trace = clean;
+		if (jitter || glitches) {
+			traceDisturb(trace, seed + r, jitter, glitches);
+		}
+		pulses += trace.pulses.size();
+
+		std::vector<std::string> messages;
+		if (!run(trace, messages)) {
+			printf("%s: run %d failed\n", name, r + 1);
+			return false;
+		}
+		std::map<std::string, int> seen;
+		for (size_t i = 0; i < messages.size(); i++) {
+			if (verbose) printf("  run %d: %s\n", r + 1, messages[i].c_str());
+			if (found.count(messages[i])) seen[messages[i]]++;
+			else other[messages[i]]++;
+		}
+		for (std::map<std::string, int>::iterator it = seen.begin(); it != seen.end(); ++it) {
+			int n = expected[it->first];
+			if (dedup && it->second > n) repeated[it->first]++;
+			else if (!dedup || it->second == n) found[it->first]++;
+		}
+	}
+
+	boolean ok = true;
+	printf("%s: %lu pulses, %d run%s\n", name, pulses / runs, runs, runs == 1 ? "" : "s");
+	for (std::map<std::string, int>::iterator it = found.begin(); it != found.end(); ++it) {
+		printf("  %-32s %d/%d%s\n", it->first.c_str(), it->second, runs,
+			it->second == runs ? "" : repeated[it->first] > 0 ? "  REPEATED" : "  MISSED");
+		if (it->second != runs) ok = false;
+	}
+	for (std::map<std::string, int>::iterator it = other.begin(); it != other.end(); ++it) {
+		boolean wrong = checked.count(codecOf(it->first)) > 0;
+		printf("  %-32s %dx%s\n", it->first.c_str(), it->second, wrong ? "  WRONG" : "  (other decoder)");
+		if (wrong) ok = false;
+	}
+	return ok;
+}
+
+// --------------------------------------------------------------------------------
+// Benchmark
+//
+static void benchmark(const Trace &trace) {
+	output = open("/dev/null", O_WRONLY);
+	initReceivers();
+	int passes = 1 + 2000000 / trace.pulses.size();		// About 2 million edges per decoder
+	for (uint8_t d = 0; d < DECODERS; d++) {
+		struct timespec start, end;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int p = 0; p < passes; p++) {
+			replay(trace, d);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+		double edges = (double)passes * trace.pulses.size();
+		printf("  %-8s %8.2f Medges/s %8.1f ns/edge\n", decoders[d], edges / ns * 1000, ns / edges);
+	}
+	close(output);
+	output = 1;
+}
+
+int main(int argc, char *argv[]) {
+	int runs = 1;
+	unsigned long seed = 1;
+	unsigned int jitter = 0, glitches = 0;
+	boolean bench = false;
+	int c;
+
+	while ((c = getopt(argc, argv, "vbdn:s:j:g:")) != -1) {
+		switch (c) {
+			case 'v': verbose = true; break;
+			case 'b': bench = true; break;
+			case 'd': dedup = true; break;
+			case 'n': runs = atoi(optarg); break;
+			case 's': seed = strtoul(optarg, NULL, 10); break;
+			case 'j': jitter = atoi(optarg); break;
+			case 'g': glitches = atoi(optarg); break;
+			default:
+				fprintf(stderr, "Usage: %s [-v] [-b] [-d] [-n runs] [-s seed] [-j jitter] [-g glitches] trace ...\n", argv[0]);
+				return 2;
+		}
+	}
+	if (optind == argc || runs < 1) {
+		fprintf(stderr, "No trace files\n");
+		return 2;
+	}
+
+	boolean ok = true;
+	for (int i = optind; i < argc; i++) {
+		Trace trace;
+		if (!traceRead(argv[i], trace)) return 2;
+		if (!check(argv[i], trace, runs, seed, jitter, glitches)) ok = false;
+		if (bench) {
+			if (jitter || glitches) traceDisturb(trace, seed, jitter, glitches);
+			benchmark(trace);
+		}
+	}
+	return ok ? 0 : 1;
+}
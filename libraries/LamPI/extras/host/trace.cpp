@@ -0,0 +1,306 @@
+/*
+ * trace.cpp - Pulse traces for the host tools. See trace.h for details.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include "trace.h"
+
+#include <stdarg.h>
+
+#include <kakuTransmitter.h>
+#include <RemoteTransmitter.h>
+#include <livoloTransmitter.h>
+#include <quhwaTransmitter.h>
+
+static Trace *_trace = NULL;
+static unsigned long _lastEdge;
+static byte _level = LOW;
+
+static const char *_codecs[] = { "kaku", "action", "livolo", "kopou", "quhwa", "wt440", "auriol", "overlap", NULL };
+
+// --------------------------------------------------------------------------------
+// Recording of the transmitter pin
+//
+static void recordEdge(uint8_t pin, uint8_t level, unsigned long now) {
+	if (pin != TRACE_PIN) return;
+	_level = level;
+	_trace->pulses.push_back(now - _lastEdge > 0xFFFF ? 0xFFFF : now - _lastEdge);
+	_lastEdge = now;
+}
+
+// Keeps the current level for duration microseconds, and then changes it.
+static void pulse(unsigned int duration) {
+	delayMicroseconds(duration);
+	digitalWrite(TRACE_PIN, !_level);
+}
+
+// A receiver without a carrier outputs noise. Without it, the long silence before a
+// transmission looks like a sync pulse to the receivers. The noise ends with a quiet
+// low period that no decoder mistakes for part of a message, and the level goes high
+// for the next transmission.
+static unsigned long _noise = 1;						// Seed of the noise of all traces
+
+static void noise(unsigned long &seed = _noise) {
+	for (unsigned long t = 0; t < TRACE_GAP; ) {
+		seed = seed * 1103515245 + 12345;
+		unsigned int d = 100 + (seed >> 16) % 800;
+		pulse(d);
+		t += d;
+	}
+	if (_level == HIGH) {
+		pulse(300);
+	}
+	delayMicroseconds(3000);
+	digitalWrite(TRACE_PIN, HIGH);
+}
+
+static void expect(Trace &trace, const char *format, ...) {
+	char line[64];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	trace.expect.push_back(line);
+}
+
+// --------------------------------------------------------------------------------
+// Protocols without a matching transmitter in the library
+//
+static void kopouFrame(unsigned int address, byte unit) {
+	pulse(140);											// Start: T low, 5T high
+	pulse(600);
+	unsigned long bits = ((unsigned long)address << 8) | unit;
+	for (int8_t i = 23; i >= 0; i--) {
+		if ((bits >> i) & 1) {
+			pulse(260); pulse(140);
+		} else {
+			pulse(140); pulse(260);
+		}
+	}
+}
+
+// FM encoded, a 1 is two short pulses and a 0 one long pulse
+static void wt440Bits(unsigned int value, byte count, byte &par) {
+	for (int8_t i = count - 1; i >= 0; i--) {
+		if ((value >> i) & 1) {
+			pulse(1000); pulse(1000);
+			par ^= 1;
+		} else {
+			pulse(2000);
+		}
+	}
+}
+
+static void wt440Frame(byte address, byte channel, byte humidity, unsigned int temperature) {
+	byte par = 0;
+	wt440Bits(B1100, 4, par);							// Leader
+	par = 0;
+	wt440Bits(address, 4, par);
+	wt440Bits(channel, 2, par);
+	wt440Bits(B110, 3, par);							// Constant
+	wt440Bits(humidity, 7, par);
+	wt440Bits(temperature, 15, par);
+	wt440Bits(par, 1, par);
+}
+
+// flips are the bits that are inverted after the parity is set
+static void auriolFrame(byte address, byte n1, unsigned int temperature, byte n2, unsigned long flips = 0) {
+	pulse(500);											// Sync: T high, 18T low
+	pulse(9000);
+	unsigned long bits = ((unsigned long)address << 24) | ((unsigned long)(n1 & 0x0F) << 20)
+		| ((unsigned long)(temperature & 0x0FFF) << 8) | ((n2 & 0x7F) << 1);
+	byte par = 0;
+	for (byte i = 1; i < 32; i++) {
+		par ^= (bits >> i) & 1;
+	}
+	bits |= par;										// Even parity
+	bits ^= flips;
+	for (int8_t i = 31; i >= 0; i--) {
+		pulse(500);
+		pulse((bits >> i) & 1 ? 4000 : 2000);
+	}
+	pulse(500);
+}
+
+// --------------------------------------------------------------------------------
+// Synthesis
+//
+boolean traceGenerate(const char *codec, Trace &trace) {
+	boolean quiet = Serial.quiet;
+	Serial.quiet = true;								// Some transmitters print on Serial
+	_trace = &trace;
+	_lastEdge = micros();
+	digitalWrite(TRACE_PIN, LOW);
+	host::setRecorder(recordEdge);
+	noise();
+
+	boolean found = true;
+	if (strcmp(codec, "kaku") == 0) {
+		KakuTransmitter kaku(TRACE_PIN);
+		kaku.sendUnit(1234567, 3, true); noise();
+		expect(trace, "kaku 1234567 3 0 1 -1");
+		kaku.sendDim(1234567, 3, 9); noise();
+		expect(trace, "kaku 1234567 3 0 2 9");
+		kaku.sendGroup(7654321, false); noise();
+		expect(trace, "kaku 7654321 0 1 0 -1");
+		// 4 repeats: on, off and on again within the window of DupCache, all three are reported.
+		// With noise of its own, so the traces after this one keep the noise they had.
+		KakuTransmitter quick(TRACE_PIN, 260, 2);
+		unsigned long seed = 2;
+		quick.sendUnit(1234567, 5, true); noise(seed);
+		expect(trace, "kaku 1234567 5 0 1 -1");
+		quick.sendUnit(1234567, 5, false); noise(seed);
+		expect(trace, "kaku 1234567 5 0 0 -1");
+		quick.sendUnit(1234567, 5, true); noise(seed);
+		expect(trace, "kaku 1234567 5 0 1 -1");
+	}
+	else if (strcmp(codec, "action") == 0) {
+		RemoteTransmitter::sendCode(TRACE_PIN, 123456, 190, 3); noise();
+		expect(trace, "action 123456");
+		RemoteTransmitter::sendCode(TRACE_PIN, 400000, 320, 3); noise();
+		expect(trace, "action 400000");
+	}
+	else if (strcmp(codec, "livolo") == 0) {
+		Livolo livolo(TRACE_PIN);
+		livolo.sendButton(6400, 120); noise();
+		expect(trace, "livolo 6400 120");
+	}
+	else if (strcmp(codec, "kopou") == 0) {
+		for (byte i = 0; i < 10; i++) kopouFrame(4242, 7);
+		noise();
+		expect(trace, "kopou 4242 7");
+	}
+	else if (strcmp(codec, "quhwa") == 0) {
+		Quhwa quhwa(TRACE_PIN);
+		quhwa.sendButton(2424, 3); noise();
+		expect(trace, "quhwa 2424 3");
+	}
+	else if (strcmp(codec, "wt440") == 0) {
+		for (byte i = 0; i < 2; i++) { wt440Frame(5, 1, 55, 6400 + 215 * 128 / 10); noise(); }
+		expect(trace, "wt440 5 1 55 %u", 6400 + 215 * 128 / 10);
+	}
+	else if (strcmp(codec, "auriol") == 0) {
+		for (byte i = 0; i < 6; i++) auriolFrame(131, 8, 215, 5);
+		noise();
+		expect(trace, "auriol 131 8 215 5");
+	}
+	else if (strcmp(codec, "overlap") == 0) {
+		// Two sensors of one codec at the same time, with their frames interleaved, see RepeatVote
+		for (byte i = 0; i < 2; i++) {
+			wt440Frame(6, 2, 60, 6400 + 180 * 128 / 10);
+			wt440Frame(7, 2, 40, 6400 + 120 * 128 / 10);
+		}
+		noise();
+		expect(trace, "wt440 6 2 60 %u", 6400 + 180 * 128 / 10);
+		expect(trace, "wt440 7 2 40 %u", 6400 + 120 * 128 / 10);
+		// Every frame of 77 has another bit flipped, so its reading can only come from the vote
+		for (byte i = 0; i < 6; i++) {
+			auriolFrame(77, 8, 190, 5, 1UL << (9 + 3 * i));
+			auriolFrame(99, 8, 230, 5);
+		}
+		noise();
+		expect(trace, "auriol 77 8 190 5");
+		expect(trace, "auriol 99 8 230 5");
+		// Repeats with errors before the first correct frame, the same error in the temperature of
+		// two of them. They and a later repeat with an error in the address must not be voted
+		// into a second, wrong reading.
+		for (byte i = 0; i < 12; i++) pulse(50000);		// Longer than VOTE_GAP, the bursts above end
+		noise();
+		auriolFrame(55, 8, 170, 5, 1UL << 29 | 1UL << 14 | 1UL << 15);
+		auriolFrame(55, 8, 170, 5, 1UL << 30 | 1UL << 14 | 1UL << 15);
+		for (byte i = 0; i < 3; i++) auriolFrame(55, 8, 170, 5);
+		auriolFrame(55, 8, 170, 5, 1UL << 28);
+		noise();
+		expect(trace, "auriol 55 8 170 5");
+	}
+	else {
+		found = false;
+	}
+
+	host::setRecorder(NULL);
+	Serial.quiet = quiet;
+	return found;
+}
+
+const char **traceCodecs() {
+	return _codecs;
+}
+
+// --------------------------------------------------------------------------------
+// Files
+//
+boolean traceRead(const char *name, Trace &trace) {
+	FILE *f = fopen(name, "r");
+	if (f == NULL) {
+		perror(name);
+		return false;
+	}
+	char line[128];
+	while (fgets(line, sizeof(line), f)) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (strncmp(line, "#!", 2) == 0) {
+			trace.expect.push_back(line + 2 + strspn(line + 2, " \t"));
+		}
+		else if (line[0] == '#') {
+			trace.comments.push_back(line);
+		}
+		else if (line[0] != '\0') {
+			unsigned long d = strtoul(line, NULL, 10);
+			trace.pulses.push_back(d > 0xFFFF ? 0xFFFF : d);
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+boolean traceWrite(const char *name, const Trace &trace) {
+	FILE *f = fopen(name, "w");
+	if (f == NULL) {
+		perror(name);
+		return false;
+	}
+	for (size_t i = 0; i < trace.comments.size(); i++) {
+		fprintf(f, "%s\n", trace.comments[i].c_str());
+	}
+	for (size_t i = 0; i < trace.expect.size(); i++) {
+		fprintf(f, "#! %s\n", trace.expect[i].c_str());
+	}
+	for (size_t i = 0; i < trace.pulses.size(); i++) {
+		fprintf(f, "%u\n", trace.pulses[i]);
+	}
+	return fclose(f) == 0;
+}
+
+// --------------------------------------------------------------------------------
+// Noise
+//
+void traceDisturb(Trace &trace, unsigned long seed, unsigned int jitter, unsigned int glitches) {
+	std::vector<unsigned int> out;
+	out.reserve(trace.pulses.size() + trace.pulses.size() * glitches / 1000 * 2);
+
+	for (size_t i = 0; i < trace.pulses.size(); i++) {
+		long d = trace.pulses[i];
+		if (jitter > 0) {
+			seed = seed * 1103515245 + 12345;
+			d += (long)((seed >> 16) % (2 * jitter + 1)) - jitter;
+			if (d < 1) d = 1;
+		}
+		seed = seed * 1103515245 + 12345;
+		if (glitches > 0 && (seed >> 16) % 1000 < glitches && d > 80) {
+			// Split the pulse by a short spike of the other level
+			seed = seed * 1103515245 + 12345;
+			unsigned int spike = 10 + (seed >> 16) % 51;
+			seed = seed * 1103515245 + 12345;
+			unsigned int before = 1 + (seed >> 16) % (d - spike);
+			out.push_back(before);
+			out.push_back(spike);
+			d -= before + spike;
+			if (d < 1) d = 1;
+		}
+		out.push_back(d > 0xFFFF ? 0xFFFF : d);
+	}
+	trace.pulses.swap(out);
+}
@@ -0,0 +1,60 @@
+/*
+ * trace.h - Pulse traces for the host tools: reading, writing, synthesizing and disturbing.
+ *
+ * A trace file contains one pulse duration in microseconds per line, i.e. the time between two
+ * edges on the receiver pin. Lines starting with '#' are comments, except lines starting with
+ * "#!" which give a message that the decoders must find in the trace, for example:
+ *
+ *		#! kaku 1234567 3 0 1 -1
+ *
+ * The format of the messages is the same as printed by the replay tool, see README.txt.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#ifndef trace_h
+#define trace_h
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+#define TRACE_PIN 8					// Pin used by the transmitters when synthesizing
+#define TRACE_GAP 20000				// Receiver noise between two transmissions, in microseconds
+
+struct Trace {
+	std::vector<unsigned int> pulses;
+	std::vector<std::string> expect;		// Messages the decoders must find
+	std::vector<std::string> comments;
+};
+
+/**
+* Synthesizes a trace for one codec, by running the LamPI transmitter on the virtual clock, or
+* by generating the pulses of the protocol where there is no (matching) transmitter. The
+* messages sent are added to the expected messages of the trace.
+*
+* @param codec	Name of the codec: kaku, action, livolo, kopou, quhwa, wt440 or auriol. Or overlap:
+*				two WT440 and two Auriol sensors that send at the same time, with bit errors,
+*				and an Auriol whose first repeats have errors.
+* @return false if the codec is unknown.
+*/
+boolean traceGenerate(const char *codec, Trace &trace);
+
+boolean traceRead(const char *name, Trace &trace);
+boolean traceWrite(const char *name, const Trace &trace);
+
+/**
+* Adds noise to a trace: every pulse gets a random error of at most jitter microseconds, and
+* for every 1000 pulses, glitches pulses are split by a spike of 10 to 60 microseconds. The
+* same seed gives the same noise.
+*/
+void traceDisturb(Trace &trace, unsigned long seed, unsigned int jitter, unsigned int glitches);
+
+/**
+* Returns the names of the codecs known by traceGenerate(), NULL terminated.
+*/
+const char **traceCodecs();
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * txcheck.cpp - Checks the parts of the transmit and uplink path of the gateways that do not
+ * decode pulses: TxScheduler, FrameCache and QueueChain.
+ *
+ * Usage:	txcheck [-v]
+ *
+ * TxScheduler is driven with the virtual clock, calling process() every millisecond as loop()
+ * would. On the host PulseTransmitter::queue() sends the frame at once, so every call of
+ * process() sends at most one turn, which is recorded from the edges on the transmitter pins.
+ * Every command is given a pin of its own, so the edges tell which command was sent. Checked
+ * are that a command replaces the waiting command of the same device, that the repeats of the
+ * devices are sent round robin in turns of as many repeats as fit in TX_SLICE, that a busy
+ * channel postpones the turn and that a channel that stays busy is used anyway after
+ * TX_MAXDEFER ms.
+ *
+ * FrameCache is checked to hit on a command it has, and to replace the least recently used
+ * frame when it is full. QueueChain is checked to keep the order of the items and, when full,
+ * to drop the oldest or the newest item as set by setMode() and to count every item dropped.
+ *
+ * With -v every turn of TxScheduler is printed. make check runs txcheck.
+ *
+ * Copyright 2015 by M. Westenberg (mw12554@hotmail.com)
+ *
+ * License: GPLv3. See license.txt
+ */
+
+#include <unistd.h>
+#include <vector>
+
+#include <Arduino.h>
+#include <LamPI.h>
+#include <TxScheduler.h>
+#include <FrameCache.h>
+#include <wifiQueue.h>
+
+struct Turn {
+	byte pin;
+	unsigned int repeats;			// Rising edges, one per repeat
+	unsigned long start;			// Virtual time in microseconds of the first edge
+};
+
+static boolean verbose = false;
+static std::vector<Turn> turns;
+static boolean busy = false;		// Channel state returned to TxScheduler
+
+// Every repeat of the frames below starts with a rising edge. run() ends a turn with a marker
+// of 0 repeats, that the first edge of the next turn replaces, so turns holds the turns in the
+// order they were sent and a marker at the end.
+static void record(uint8_t pin, uint8_t level, unsigned long now) {
+	if (level != HIGH) {
+		return;
+	}
+	if (turns.empty() || turns.back().repeats == 0) {
+		Turn t = { pin, 0, now };
+		if (turns.empty()) {
+			turns.push_back(t);
+		} else {
+			turns.back() = t;
+		}
+	}
+	turns.back().repeats++;
+}
+
+static boolean channelBusy() {
+	return busy;
+}
+
+// Frame of air microseconds per repeat: 10000 gives 3 repeats per turn, 40000 one
+static PulseFrame frame(byte pin, byte repeats, unsigned int air) {
+	PulseFrame f;
+	f.begin(pin, repeats, 500, air - 500);
+	f.add(0);
+	f.add(1);
+	return f;
+}
+
+// Calls process() every millisecond for ms milliseconds. A turn ends at the next call.
+static void run(unsigned long ms) {
+	for (unsigned long i = 0; i < ms; i++) {
+		TxScheduler::process();
+		if (!turns.empty() && turns.back().repeats > 0) {
+			if (verbose) {
+				printf("\tpin %d, %u repeats at %lu ms\n", turns.back().pin, turns.back().repeats, turns.back().start / 1000);
+			}
+			Turn t = { 0, 0, 0 };
+			turns.push_back(t);				// Marks the end of the turn
+		}
+		host::advance(1000);
+	}
+}
+
+static void start(TxChannelBusy channel) {
+	turns.clear();
+	busy = false;
+	TxScheduler::init(channel);
+	TxScheduler::resetStatistics();
+	run(100);								// Ends the listen time of an earlier test
+	turns.clear();
+}
+
+static unsigned int repeatsOn(byte pin) {
+	unsigned int n = 0;
+	for (size_t i = 0; i < turns.size(); i++) {
+		if (turns[i].pin == pin) n += turns[i].repeats;
+	}
+	return n;
+}
+
+static boolean check(const char *what, boolean ok) {
+	printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+// --------------------------------------------------------------------------------
+// TxScheduler
+//
+static boolean testScene() {
+	start(NULL);
+	// A scene of three dimmers; the second is moved again before its first repeat went out
+	boolean ok = TxScheduler::add(KAKU, 100, 1, frame(1, 4, 40000));
+	ok = TxScheduler::add(KAKU, 100, 2, frame(2, 4, 40000)) && ok;
+	ok = TxScheduler::add(KAKU, 100, 3, frame(3, 4, 40000)) && ok;
+	ok = TxScheduler::add(KAKU, 100, 2, frame(4, 4, 40000)) && ok;
+	ok = TxScheduler::pending() == 3 && ok;
+	run(2000);
+	return check("scene", ok && TxScheduler::getCoalesced() == 1 && TxScheduler::pending() == 0
+		&& repeatsOn(1) == 4 && repeatsOn(2) == 0 && repeatsOn(3) == 4 && repeatsOn(4) == 4
+		&& turns.size() >= 3 && turns[0].pin == 1 && turns[1].pin == 4 && turns[2].pin == 3);
+}
+
+static boolean testBursts() {
+	start(NULL);
+	TxScheduler::add(LIVOLO, 200, 1, frame(5, 7, 10000));	// 3 repeats per turn
+	TxScheduler::add(KAKU, 200, 1, frame(6, 2, 40000));		// 1 repeat per turn
+	run(2000);
+
+	// Turns A3 B1 A3 B1 A1, and the marker of the end of the last one
+	const Turn want[] = { { 5, 3, 0 }, { 6, 1, 0 }, { 5, 3, 0 }, { 6, 1, 0 }, { 5, 1, 0 } };
+	boolean ok = turns.size() == 5 + 1;
+	for (byte i = 0; ok && i < 5; i++) {
+		ok = turns[i].pin == want[i].pin && turns[i].repeats == want[i].repeats;
+	}
+	return check("bursts", ok);
+}
+
+static boolean testBusy() {
+	start(channelBusy);
+	busy = true;
+	unsigned long added = micros();
+	TxScheduler::add(KAKU, 300, 1, frame(7, 1, 40000));
+	run(300);
+	boolean ok = turns.empty() && TxScheduler::getDeferrals() > 0;
+	busy = false;
+	unsigned long freed = micros();
+	run(TX_MAXDEFER);
+	ok = ok && repeatsOn(7) == 1 && turns[0].start >= freed
+		&& turns[0].start - freed <= (TX_BACKOFF_MAX + 16 + 2) * 1000UL;
+	ok = ok && turns[0].start - added < TX_MAXDEFER * 1000UL;
+	return check("busy channel", ok);
+}
+
+static boolean testMaxDefer() {
+	start(channelBusy);
+	busy = true;
+	unsigned long added = micros();
+	TxScheduler::add(KAKU, 400, 1, frame(8, 1, 40000));
+	run(2 * TX_MAXDEFER);
+	busy = false;
+	unsigned int deferrals = TxScheduler::getDeferrals();
+	boolean ok = repeatsOn(8) == 1 && deferrals > 1 && turns[0].start - added >= TX_MAXDEFER * 1000UL
+		&& turns[0].start - added <= (TX_MAXDEFER + TX_BACKOFF_MAX + 16 + 2) * 1000UL;
+	return check("max defer", ok);
+}
+
+// --------------------------------------------------------------------------------
+// FrameCache
+//
+static boolean testCache() {
+	PulseFrame *f;
+	boolean ok = true;
+	FrameCache::clear();
+	FrameCache::resetStatistics();
+
+	// Fill the cache, the pin tells the frames apart
+	for (byte i = 0; i < TX_CACHE; i++) {
+		ok = !FrameCache::get(KAKU, 500, i, 1, f) && ok;
+		f->pin = i;
+	}
+	ok = FrameCache::get(KAKU, 500, 0, 1, f) && f->pin == 0 && ok;	// Now the most recent
+	ok = !FrameCache::get(KAKU, 500, 0, 0, f) && ok;				// Other value: evicts unit 1
+	f->pin = 100;
+	ok = FrameCache::get(KAKU, 500, 2, 1, f) && f->pin == 2 && ok;
+	ok = FrameCache::get(KAKU, 500, 0, 1, f) && f->pin == 0 && ok;
+	ok = FrameCache::get(KAKU, 500, 0, 0, f) && f->pin == 100 && ok;
+	ok = !FrameCache::get(KAKU, 500, 1, 1, f) && ok;				// Evicted: evicts unit 3
+	ok = !FrameCache::get(KAKU, 500, 3, 1, f) && ok;
+	return check("frame cache", ok && FrameCache::getHits() == 4 && FrameCache::getMisses() == TX_CACHE + 3);
+}
+
+// --------------------------------------------------------------------------------
+// QueueChain
+//
+static boolean fillQueue(byte mode, unsigned int extra) {
+	queueItem item;
+	memset(&item, 0, sizeof(item));
+	while (QueueChain::processQueue(&item) == 0) { }
+
+	QueueChain::setMode(mode);
+	unsigned int dropped = QueueChain::getDropped();
+	boolean ok = true;
+	for (unsigned int i = 0; i < MAX_QUEUE + extra; i++) {
+		item.value = i;
+		ok = QueueChain::addQueue(item) == (i < MAX_QUEUE) && ok;
+	}
+	ok = ok && QueueChain::count() == MAX_QUEUE && QueueChain::getDropped() - dropped == extra;
+
+	// The items left, oldest first
+	long first = mode == QUEUE_DROP_OLDEST ? extra : 0;
+	for (unsigned int i = 0; i < MAX_QUEUE; i++) {
+		ok = QueueChain::processQueue(&item) == 0 && item.value == first + (long)i && ok;
+	}
+	ok = QueueChain::processQueue(&item) == -1 && ok;
+	QueueChain::setMode(QUEUE_DROP_OLDEST);
+	return ok;
+}
+
+static boolean testQueue() {
+	boolean ok = fillQueue(QUEUE_DROP_OLDEST, 5);
+	ok = fillQueue(QUEUE_DROP_NEWEST, 5) && ok;
+	return check("queue", ok && QueueChain::getHighWater() == MAX_QUEUE);
+}
+
+static int usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-v]\n", name);
+	return 2;
+}
+
+int main(int argc, char *argv[]) {
+	int c;
+	while ((c = getopt(argc, argv, "v")) != -1) {
+		switch (c) {
+			case 'v': verbose = true; break;
+			default:
+				return usage(argv[0]);
+		}
+	}
+
+	host::setTime(1000000);
+	host::setRecorder(record);
+	boolean ok = testScene();
+	ok = testBursts() && ok;
+	ok = testBusy() && ok;
+	ok = testMaxDefer() && ok;
+	ok = testCache() && ok;
+	ok = testQueue() && ok;
+	return ok ? 0 : 1;
+}
@@ -8,8 +8,13 @@
  */
 
 #include "kakuReceiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
 
 #define RESET_STATE _state = -1 // Resets state to initial position.
+#define REJECT(reason) { _stats.reason++; if (narrowed) _stats.narrowed++; if (_state >= 34) DecoderChain::countFrame(KAKU, FRAME_REJECTED); RESET_STATE; return; }
+
+#define KAKU_MINFRAMES 4		// Number of frames of a remote before its windows are narrowed
 
 /************
 * KakuReceiver
@@ -44,6 +49,11 @@ byte KakuReceiver::_minRepeats;
 KakuReceiverCallBack KakuReceiver::_callback;
 boolean KakuReceiver::_inCallback = false;
 boolean KakuReceiver::_enabled = false;
+unsigned int KakuReceiver::_minSync = KAKU_MINSYNC;
+volatile KakuStatistics KakuReceiver::_stats;
+#if KAKU_ESTIMATORS > 0
+KakuReceiver::Estimator KakuReceiver::_estimators[KAKU_ESTIMATORS];
+#endif
 
 void KakuReceiver::init(int8_t interrupt, byte minRepeats, KakuReceiverCallBack callback) {
 	_interrupt = interrupt;
@@ -72,6 +82,14 @@ void KakuReceiver::deinit() {
 }
 
 void KakuReceiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void KakuReceiver::handlePulse(unsigned int pulse) {
 	// This method is written as compact code to keep it fast. While breaking up this method into more
 	// methods would certainly increase the readability, it would also be much slower to execute.
 	// Making calls to other methods is quite expensive on AVR. As These interrupt handlers are called
@@ -85,28 +103,32 @@ void KakuReceiver::interruptHandler() {
 	static KakuCode receivedCode;		// Contains received code
 	static KakuCode previousCode;		// Contains previous received code
 	static byte repeats = 0;				// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
+	static unsigned int span;				// Time between the last decoded edge and the start of this pulse
 	static unsigned int min1Period, max1Period, min5Period, max5Period;
 	static bool skip;
+	static unsigned long shortSum;			// Sum of the 1T bit parts of this frame
+	static byte shortCount;
+	static bool narrowed;					// Windows are narrowed by the estimate of the remote
 
-	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
+	// Filter out too short pulses. This method works as a low pass filter: a pulse that is too
+	// short is merged, together with the pulse following it, into the pulse before.
 	if (skip) {
 		skip = false;
+		span += pulse;
 		return;
 	}
 
-	if (_state >= 0 && edgeTimeStamp[2]-edgeTimeStamp[1] < min1Period) {
+	if (_state >= 0 && pulse < min1Period) {
 		// Last edge was too short.
 		// Skip this edge, and the next too.
 		skip = true;
+		_stats.glitches++;
+		span += pulse;
 		return;
 	}
 
-	unsigned int duration = edgeTimeStamp[1] - edgeTimeStamp[0];
-	edgeTimeStamp[0] = edgeTimeStamp[1];
+	unsigned int duration = span;
+	span = pulse;
 
 	// Note that if state>=0, duration is always >= 1 period.
 
@@ -114,9 +136,13 @@ void KakuReceiver::interruptHandler() {
 		// wait for the long low part of a stop bit.
 		// Stopbit: 1T high, 40T low
 		// By default 1T is 260µs, but for maximum compatibility go as low as 120µs
-		if (duration > 4800) { // =40*120µs, minimal time between two edges before decoding starts.
+		// A duration of 0xFFFF is a silence longer than the timer range (or the squelch of DecoderChain
+		// that just opened), not a stop bit. Its period would open the windows so wide that every
+		// real edge is taken for a glitch.
+		if (duration > _minSync && duration < 0xFFFF) { // Default 40*120µs, minimal time between two edges before decoding starts.
 			// Sync signal received.. Preparing for decoding
 			repeats = 0;
+			narrowed = false;
 
 			receivedCode.period = duration / 40; // Measured signal is 40T, so 1T (period) is measured signal / 40.
 
@@ -131,18 +157,14 @@ void KakuReceiver::interruptHandler() {
 		}
 	} else if (_state == 0) { // Verify start bit part 1 of 2
 		// Duration must be ~1T
-		if (duration > max1Period) {
-			RESET_STATE;
-			return;
-		}
+		if (duration > max1Period) REJECT(startBit);
 		// Start-bit passed. Do some clean-up.
 		receivedCode.address = receivedCode.unit = receivedCode.dimLevel = 0;
+		receivedCode.dimLevelPresent = false;
+		shortSum = shortCount = 0;
 	} else if (_state == 1) { // Verify start bit part 2 of 2
 		// Duration must be ~10.44T
-		if (duration < 7 * receivedCode.period || duration > 15 * receivedCode.period) {
-			RESET_STATE;
-			return;
-		}
+		if (duration < 7 * receivedCode.period || duration > 15 * receivedCode.period) REJECT(startBit);
 	} else if (_state < 148) { // state 146 is first edge of stop-sequence. All bits before that adhere to default protocol, with exception of dim-bit
 		receivedBit <<= 1;
 
@@ -150,6 +172,8 @@ void KakuReceiver::interruptHandler() {
 		// bit part durations can ONLY be 1 or 5 periods.
 		if (duration <= max1Period) {
 			receivedBit &= B1110; // Clear LSB of receivedBit
+			shortSum += duration;
+			shortCount++;
 		} else if (duration >= min5Period && duration <= max5Period) {
 			receivedBit |= B1; // Set LSB of receivedBit
 		} else if (
@@ -166,6 +190,12 @@ void KakuReceiver::interruptHandler() {
 				}
 				
 				// a valid signal was found!
+				_stats.accepted++;
+#if KAKU_ESTIMATORS > 0
+				if (shortCount > 0) {
+					updateEstimate(receivedCode.address, shortSum / shortCount);
+				}
+#endif
 				if (
 						receivedCode.address != previousCode.address ||
 						receivedCode.unit != previousCode.unit ||
@@ -180,6 +210,7 @@ void KakuReceiver::interruptHandler() {
 				
 				repeats++;
 				
+				DecoderChain::countFrame(KAKU, repeats >= _minRepeats ? FRAME_DECODED : FRAME_DUPLICATE);
 				if (repeats>=_minRepeats) {
 					if (!_inCallback) {
 						_inCallback = true;
@@ -193,12 +224,13 @@ void KakuReceiver::interruptHandler() {
 				
 				// Reset for next round
 				_state=0; // no need to wait for another sync-bit!
+#if KAKU_ESTIMATORS > 0
+				// The repeat is most likely from the same remote
+				narrowed = narrow(receivedCode.address, receivedCode.period, max1Period, min5Period, max5Period);
+#endif
 				return;
 		}		
-		else { // Otherwise the entire sequence is invalid
-			RESET_STATE;
-			return;
-		}
+		else REJECT(timing); // Otherwise the entire sequence is invalid
 
 		if (_state % 4 == 1) { // Last bit part? Note: this is the short version of "if ( (_state-2) % 4 == 3 )"
 			// There are 3 valid options for receivedBit:
@@ -222,9 +254,14 @@ void KakuReceiver::interruptHandler() {
 						receivedCode.address |= 1;
 						break;
 					default: // Bit was invalid. Abort.
-						RESET_STATE;
-						return;
+						REJECT(invalidBit);
+				}
+#if KAKU_ESTIMATORS > 0
+				if (_state == 105 && !narrowed) {
+					// Address complete, use the windows of this remote for the rest of the frame
+					narrowed = narrow(receivedCode.address, receivedCode.period, max1Period, min5Period, max5Period);
 				}
+#endif
 			} else if (_state < 110) {
 				// States 106 - 109 are group bit states.
 				switch (receivedBit & B1111) {
@@ -235,8 +272,7 @@ void KakuReceiver::interruptHandler() {
 						receivedCode.groupBit = true;
 						break;
 					default: // Bit was invalid. Abort.
-						RESET_STATE;
-						return;
+						REJECT(invalidBit);
 				}
 			} else if (_state < 114) {
 				// States 110 - 113 are switch bit states.
@@ -251,8 +287,7 @@ void KakuReceiver::interruptHandler() {
 						receivedCode.switchType = KakuCode::dim;
 						break;
 					default: // Bit was invalid. Abort.
-						RESET_STATE;
-						return;
+						REJECT(invalidBit);
 				}
 			} else if (_state < 130){
 				// States 114 - 129 are unit bit states.
@@ -267,8 +302,7 @@ void KakuReceiver::interruptHandler() {
 						receivedCode.unit |= 1;
 						break;
 					default: // Bit was invalid. Abort.
-						RESET_STATE;
-						return;
+						REJECT(invalidBit);
 				}
 				
 			} else if (_state < 146) {
@@ -286,8 +320,7 @@ void KakuReceiver::interruptHandler() {
 						receivedCode.dimLevel |= 1;
 						break;
 					default: // Bit was invalid. Abort.
-						RESET_STATE;
-						return;
+						REJECT(invalidBit);
 				}
 			}
 		}
@@ -310,3 +343,122 @@ boolean KakuReceiver::isReceiving(int waitMillis) {
 
 	return false;
 }
+
+void KakuReceiver::setSyncThreshold(unsigned int minSync) {
+	_minSync = minSync;
+}
+
+void KakuReceiver::getStatistics(KakuStatistics &stats) {
+	noInterrupts();
+	memcpy(&stats, (const void *)&_stats, sizeof(stats));
+	interrupts();
+}
+
+void KakuReceiver::resetStatistics() {
+	noInterrupts();
+	memset((void *)&_stats, 0, sizeof(_stats));
+	interrupts();
+}
+
+boolean KakuReceiver::getEstimate(byte index, KakuEstimate &estimate) {
+#if KAKU_ESTIMATORS > 0
+	if (index >= KAKU_ESTIMATORS) {
+		return false;
+	}
+	noInterrupts();
+	Estimator e = _estimators[index];
+	interrupts();
+	if (e.frames == 0) {
+		return false;
+	}
+	estimate.address = e.address;
+	estimate.period = (e.mean + 8) / 16;
+	estimate.jitter = (e.margin + 2) / 4;
+	estimate.frames = e.frames;
+	return true;
+#else
+	(void)index; (void)estimate;
+	return false;
+#endif
+}
+
+#if KAKU_ESTIMATORS > 0
+// Integer square root, bit by bit. Only called once per accepted frame.
+static unsigned int isqrt(unsigned long n) {
+	unsigned long root = 0;
+	unsigned long bit = 1UL << 30;
+	while (bit > n) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (n >= root + bit) {
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+void KakuReceiver::updateEstimate(unsigned long address, unsigned int period) {
+	// Find the remote, or replace the entry with the fewest frames
+	byte i, victim = 0;
+	for (i = 0; i < KAKU_ESTIMATORS; i++) {
+		if (_estimators[i].frames > 0 && _estimators[i].address == address) {
+			break;
+		}
+		if (_estimators[i].frames < _estimators[victim].frames) {
+			victim = i;
+		}
+	}
+
+	if (period > 4095) {
+		period = 4095;						// Noise, the sample must fit in an unsigned int
+	}
+	unsigned int sample = period * 16;
+	if (i == KAKU_ESTIMATORS) {
+		Estimator &e = _estimators[victim];
+		e.address = address;
+		e.mean = sample;
+		e.variance = 0;
+		e.frames = 1;
+		e.margin = 0;
+		return;
+	}
+
+	// Exponentially weighted mean and variance, weight 1/8 for the new sample:
+	// mean += diff/8, variance = 7/8 * (variance + diff²/8)
+	Estimator &e = _estimators[i];
+	long diff = (long)sample - e.mean;
+	e.mean += diff / 8;
+	unsigned long square = (unsigned long)abs(diff) * (unsigned long)abs(diff);	// At most 65535²
+	e.variance = (e.variance + square / 8) / 8 * 7;
+	if (e.frames < 255) {
+		e.frames++;
+	}
+	e.margin = isqrt(e.variance) / 4;		// 4 sigma in µs, variance is in (1/16 µs)²
+}
+
+boolean KakuReceiver::narrow(unsigned long address, unsigned int period,
+		unsigned int &max1Period, unsigned int &min5Period, unsigned int &max5Period) {
+	for (byte i = 0; i < KAKU_ESTIMATORS; i++) {
+		Estimator &e = _estimators[i];
+		if (e.frames >= KAKU_MINFRAMES && e.address == address) {
+			unsigned int t = e.mean / 16;
+			unsigned int margin = e.margin > t / 2 ? e.margin : t / 2;
+
+			// Never wider than the windows derived from the sync pulse
+			max1Period = t + margin;
+			if (max1Period > period * 3) max1Period = period * 3;
+			min5Period = 5 * t > 2 * margin ? 5 * t - 2 * margin : 0;
+			if (min5Period < period * 3) min5Period = period * 3;
+			max5Period = 5 * t + 2 * margin;
+			if (max5Period > period * 8) max5Period = period * 8;
+			return true;
+		}
+	}
+	return false;
+}
+#endif
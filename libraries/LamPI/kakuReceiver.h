@@ -29,6 +29,29 @@ struct KakuCode {
 
 typedef void (*KakuReceiverCallBack)(KakuCode);
 
+#ifndef KAKU_ESTIMATORS
+#define KAKU_ESTIMATORS 4			// Number of remotes for which the period T is tracked. 0 disables the estimator
+#endif
+#define KAKU_MINSYNC 4800			// Default minimal sync pulse: 40*120µs
+
+// Number of frames rejected by KakuReceiver, per reason
+struct KakuStatistics {
+	unsigned int accepted;		// Frames with a valid stop bit, repeats included
+	unsigned int glitches;		// Pulses shorter than 0.3T, removed by the low pass filter
+	unsigned int startBit;		// Start bit after the sync with a wrong duration
+	unsigned int timing;		// Pulse that is neither 1T, 5T nor a stop bit in the right state
+	unsigned int invalidBit;	// Four bit parts that do not make a 0, 1 or dim bit
+	unsigned int narrowed;		// Of the rejects above, frames decoded with the windows of an estimate
+};
+
+// Estimated period of one remote. See KakuReceiver::getEstimate()
+struct KakuEstimate {
+	unsigned long address;		// Address of the remote
+	unsigned int period;		// Mean of 1T in microseconds
+	unsigned int jitter;		// Standard deviation of 1T in microseconds
+	byte frames;				// Number of accepted frames (saturates at 255)
+};
+
 /**
 * See RemoteSwitch for introduction.
 *
@@ -42,6 +65,13 @@ typedef void (*KakuReceiverCallBack)(KakuCode);
 *
 * When sending your own code using NewRemoteSwich, disable() the receiver first.
 *
+* For every accepted frame the mean length of the short (1T) pulses is measured. Per remote address
+* an exponentially weighted mean and variance of T is kept (1/8 weight for the newest frame). Once
+* a remote has sent a few frames, the windows for 1T and 5T pulses of its next frames are narrowed
+* to the mean plus or minus 4 standard deviations (but at least T/2), instead of the wide windows
+* derived from the sync pulse. The window is narrowed after the address bits, or directly after
+* the stop bit for a repeat of the same remote. Rejected frames are counted per reason.
+*
 * This is a pure static class, for simplicity and to limit memory-use.
 */
 
@@ -95,6 +125,43 @@ class KakuReceiver {
 		 */
 		static void interruptHandler();
 
+		/**
+		 * Decodes one pulse, i.e. the time between the previous and the current edge. Called by
+		 * interruptHandler(), or directly by DecoderChain which timestamps every edge only once
+		 * for all decoders.
+		 *
+		 * @param duration Duration of the pulse in microseconds, clipped to 65535.
+		 */
+		static void handlePulse(unsigned int duration);
+
+		/**
+		* Sets the minimal duration of the low part of the stop bit that starts decoding. The
+		* period T is this duration / 40, so lowering it accepts faster remotes, but also
+		* makes noise more likely to start a frame.
+		*
+		* @param minSync Minimal sync pulse in microseconds, default KAKU_MINSYNC.
+		*/
+		static void setSyncThreshold(unsigned int minSync);
+
+		/**
+		* Copies the reject counters. Counting is done in the interrupt handler, so interrupts
+		* are disabled during the copy.
+		*/
+		static void getStatistics(KakuStatistics &stats);
+
+		/**
+		* Clears the reject counters. The estimates are kept.
+		*/
+		static void resetStatistics();
+
+		/**
+		* Gets the estimated period and jitter of a remote.
+		*
+		* @param index	Index in the estimator table, 0 .. KAKU_ESTIMATORS-1.
+		* @return false if the index is out of range or no remote was seen in this entry yet.
+		*/
+		static boolean getEstimate(byte index, KakuEstimate &estimate);
+
 	private:
 
 		static int8_t _interrupt;					// Radio input interrupt
@@ -103,6 +170,22 @@ class KakuReceiver {
 		static KakuReceiverCallBack _callback;
 		static boolean _inCallback;					// When true, the callback function is being executed; prevents re-entrance.
 		static boolean _enabled;					// If true, monitoring and decoding is enabled. If false, interruptHandler will return immediately.
+		static unsigned int _minSync;				// Minimal duration of the sync pulse
+		volatile static KakuStatistics _stats;
+
+#if KAKU_ESTIMATORS > 0
+		struct Estimator {
+			unsigned long address;
+			unsigned int mean;						// Mean of T in 1/16 µs
+			unsigned long variance;					// Variance of T in (1/16 µs)²
+			unsigned int margin;					// 4 sigma of T in µs
+			byte frames;
+		};
+		static Estimator _estimators[KAKU_ESTIMATORS];
+
+		static void updateEstimate(unsigned long address, unsigned int period);
+		static boolean narrow(unsigned long address, unsigned int period, unsigned int &max1Period, unsigned int &min5Period, unsigned int &max5Period);
+#endif
 
 };
 
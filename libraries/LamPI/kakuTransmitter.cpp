@@ -8,6 +8,12 @@
 
 #include "kakuTransmitter.h"
 
+// Index of the pulse durations in the frame
+#define KAKU_T 0
+#define KAKU_5T 1
+#define KAKU_START 2
+#define KAKU_STOP 3
+
 
 KakuTransmitter::KakuTransmitter(byte pin, unsigned int periodusec, byte repeats) {
 //	_address = address;
@@ -19,146 +25,141 @@ KakuTransmitter::KakuTransmitter(byte pin, unsigned int periodusec, byte repeats
 }
 
 void KakuTransmitter::sendGroup(unsigned long address, boolean switchOn) {
-	for (int8_t i = _repeats; i >= 0; i--) {
-		_sendStartPulse();
+	PulseFrame frame;
+	frameGroup(frame, address, switchOn);
+	PulseTransmitter::transmit(frame);
+}
 
-		_sendAddress(address);
+void KakuTransmitter::sendUnit(unsigned long address, byte unit, boolean switchOn) {
+	PulseFrame frame;
+	frameUnit(frame, address, unit, switchOn);
+	PulseTransmitter::transmit(frame);
+}
 
-		// Do send group bit
-		_sendBit(true);
+void KakuTransmitter::sendDim(unsigned long address, byte unit, byte dimLevel) {
+	PulseFrame frame;
+	frameDim(frame, address, unit, dimLevel);
+	PulseTransmitter::transmit(frame);
+}
 
-		// Switch on | off
-		_sendBit(switchOn);
+void KakuTransmitter::sendGroupDim(unsigned long address, byte dimLevel) {
+	PulseFrame frame;
+	frameGroupDim(frame, address, dimLevel);
+	PulseTransmitter::transmit(frame);
+}
 
-		// No unit. Is this actually ignored?..
-		_sendUnit(0);
+void KakuTransmitter::frameGroup(PulseFrame &frame, unsigned long address, boolean switchOn) {
+	_beginFrame(frame);
 
-		_sendStopPulse();
-	}
+	_addAddress(frame, address);
+
+	// Do send group bit
+	_addBit(frame, true);
+
+	// Switch on | off
+	_addBit(frame, switchOn);
+
+	// No unit. Is this actually ignored?..
+	_addUnit(frame, 0);
+
+	_addStopPulse(frame);
 }
 
-void KakuTransmitter::sendUnit(unsigned long address, byte unit, boolean switchOn) {
-	for (int8_t i = _repeats; i >= 0; i--) {
-		_sendStartPulse();
+void KakuTransmitter::frameUnit(PulseFrame &frame, unsigned long address, byte unit, boolean switchOn) {
+	_beginFrame(frame);
 
-		_sendAddress(address);
+	_addAddress(frame, address);
 
-		// No group bit
-		_sendBit(false);
+	// No group bit
+	_addBit(frame, false);
 
-		// Switch on | off
-		_sendBit(switchOn);
+	// Switch on | off
+	_addBit(frame, switchOn);
 
-		_sendUnit(unit);
+	_addUnit(frame, unit);
 
-		_sendStopPulse();
-	}
+	_addStopPulse(frame);
 }
 
-void KakuTransmitter::sendDim(unsigned long address, byte unit, byte dimLevel) {
-	for (int8_t i = _repeats; i >= 0; i--) {
-		_sendStartPulse();
-
-		_sendAddress(address);
+void KakuTransmitter::frameDim(PulseFrame &frame, unsigned long address, byte unit, byte dimLevel) {
+	_beginFrame(frame);
 
-		// No group bit
-		_sendBit(false);
+	_addAddress(frame, address);
 
-		// Switch type 'dim'
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec);
+	// No group bit
+	_addBit(frame, false);
 
-		_sendUnit(unit);
+	// Switch type 'dim'
+	frame.add(KAKU_T); frame.add(KAKU_T); frame.add(KAKU_T); frame.add(KAKU_T);
 
-		for (int8_t j=3; j>=0; j--) {
-		   _sendBit(dimLevel & 1<<j);
-		}
+	_addUnit(frame, unit);
 
-		_sendStopPulse();
+	for (int8_t j=3; j>=0; j--) {
+	   _addBit(frame, dimLevel & 1<<j);
 	}
-}
 
-void KakuTransmitter::sendGroupDim(unsigned long address, byte dimLevel) {
-	for (int8_t i = _repeats; i >= 0; i--) {
-		_sendStartPulse();
+	_addStopPulse(frame);
+}
 
-		_sendAddress(address);
+void KakuTransmitter::frameGroupDim(PulseFrame &frame, unsigned long address, byte dimLevel) {
+	_beginFrame(frame);
 
-		// No group bit
-		_sendBit(true);
+	_addAddress(frame, address);
 
-		// Switch type 'dim'
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec);
+	// No group bit
+	_addBit(frame, true);
 
-		_sendUnit(0);
+	// Switch type 'dim'
+	frame.add(KAKU_T); frame.add(KAKU_T); frame.add(KAKU_T); frame.add(KAKU_T);
 
-		for (int8_t j=3; j>=0; j--) {
-		   _sendBit(dimLevel & 1<<j);
-		}
+	_addUnit(frame, 0);
 
-		_sendStopPulse();
+	for (int8_t j=3; j>=0; j--) {
+	   _addBit(frame, dimLevel & 1<<j);
 	}
+
+	_addStopPulse(frame);
 }
 
-void KakuTransmitter::_sendStartPulse(){
-	digitalWrite(_pin, HIGH);
-	delayMicroseconds(_periodusec);
-	digitalWrite(_pin, LOW);
-	delayMicroseconds(_periodusec * 10 + (_periodusec >> 1)); // Actually 10.5T instead of 10.44T. Close enough.
+void KakuTransmitter::_beginFrame(PulseFrame &frame) {
+	// Pulse durations: T, 5T, start 10.5T (instead of 10.44T, close enough) and stop 40T
+	frame.begin(_pin, _repeats == 255 ? 255 : _repeats + 1,
+		_periodusec, _periodusec * 5, _periodusec * 10 + (_periodusec >> 1), _periodusec * 40);
+
+	// Start pulse
+	frame.add(KAKU_T);
+	frame.add(KAKU_START);
 }
 
-void KakuTransmitter::_sendAddress(unsigned long address) {
+void KakuTransmitter::_addAddress(PulseFrame &frame, unsigned long address) {
 	for (int8_t i=25; i>=0; i--) {
-	   _sendBit((address >> i) & 1);
+	   _addBit(frame, (address >> i) & 1);
 	}
 }
 
-void KakuTransmitter::_sendUnit(byte unit) {
+void KakuTransmitter::_addUnit(PulseFrame &frame, byte unit) {
 	for (int8_t i=3; i>=0; i--) {
-	   _sendBit(unit & 1<<i);
+	   _addBit(frame, unit & 1<<i);
 	}
 }
 
-void KakuTransmitter::_sendStopPulse() {
-	digitalWrite(_pin, HIGH);
-	delayMicroseconds(_periodusec);
-	digitalWrite(_pin, LOW);
-	delayMicroseconds(_periodusec * 40);
+void KakuTransmitter::_addStopPulse(PulseFrame &frame) {
+	frame.add(KAKU_T);
+	frame.add(KAKU_STOP);
 }
 
-void KakuTransmitter::_sendBit(boolean isBitOne) {
+void KakuTransmitter::_addBit(PulseFrame &frame, boolean isBitOne) {
 	if (isBitOne) {
 		// Send '1'
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec * 5);
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec);
+		frame.add(KAKU_T);
+		frame.add(KAKU_5T);
+		frame.add(KAKU_T);
+		frame.add(KAKU_T);
 	} else {
 		// Send '0'
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, HIGH);
-		delayMicroseconds(_periodusec);
-		digitalWrite(_pin, LOW);
-		delayMicroseconds(_periodusec * 5);
+		frame.add(KAKU_T);
+		frame.add(KAKU_T);
+		frame.add(KAKU_T);
+		frame.add(KAKU_5T);
 	}
 }
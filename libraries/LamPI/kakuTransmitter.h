@@ -9,6 +9,7 @@
 #define KakuTransmitter_h
 
 #include <Arduino.h>
+#include <PulseTransmitter.h>
 
 /**
 * KakuTransmitter provides a generic class for simulation of common RF remote controls, like the A-series
@@ -27,6 +28,8 @@
 *   period length for your devices.
 * - You can copy the address of your "real" remotes, so you won't have to learn new codes into the receivers.
 *   In effect this duplicates a remote. But you can also pick a random number in the range 0..2^26-1.
+* - The send functions use PulseTransmitter::transmit(), which waits until the signal is sent unless
+*   PulseTransmitter is in background mode. The frame functions only compile the signal into a PulseFrame.
 */
 class KakuTransmitter {
 	public:
@@ -77,6 +80,15 @@ class KakuTransmitter {
 		 */
 		void sendGroupDim(unsigned long address, byte dimLevel);
 
+		/**
+		 * Compile the signal of sendGroup(), sendUnit(), sendDim() or sendGroupDim() into a frame,
+		 * including the repeats, without sending it.
+		 */
+		void frameGroup(PulseFrame &frame, unsigned long address, boolean switchOn);
+		void frameUnit(PulseFrame &frame, unsigned long address, byte unit, boolean switchOn);
+		void frameDim(PulseFrame &frame, unsigned long address, byte unit, byte dimLevel);
+		void frameGroupDim(PulseFrame &frame, unsigned long address, byte dimLevel);
+
 	protected:
 		unsigned long _address;		// Address of this transmitter.
 		byte _pin;					// Transmitter output pin
@@ -84,32 +96,32 @@ class KakuTransmitter {
 		byte _repeats;				// Number over repetitions of one telegram
 
 		/**
-		 * Transmits start-pulse
+		 * Starts a frame with the pulse durations for this period, and adds the start pulse
 		 */
-		void _sendStartPulse();
+		void _beginFrame(PulseFrame &frame);
 
 		/**
-		 * Transmits address part
+		 * Adds address part
 		 */
-		void _sendAddress(unsigned long address);
+		void _addAddress(PulseFrame &frame, unsigned long address);
 
 		/**
-		 * Transmits unit part.
+		 * Adds unit part.
 		 *
 		 * @param unit      [0-15] target unit.
 		 */
-		void _sendUnit(byte unit);
+		void _addUnit(PulseFrame &frame, byte unit);
 
 		/**
-		 * Transmits stop pulse.
+		 * Adds stop pulse.
 		 */
-		void _sendStopPulse();
+		void _addStopPulse(PulseFrame &frame);
 
 		/**
-		 * Transmits a single bit.
+		 * Adds a single bit.
 		 *
 		 * @param isBitOne	True, to send '1', false to send '0'.
 		 */
-		void _sendBit(boolean isBitOne);
+		void _addBit(PulseFrame &frame, boolean isBitOne);
 };
 #endif
@@ -6,8 +6,11 @@
  */
 
 #include "kopouReceiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
 
 #define RESET_STATE _state = -1 // Resets state to initial position.
+#define REJECT_STATE { if (_state >= 40) DecoderChain::countFrame(KOPOU, FRAME_REJECTED); RESET_STATE; } // Gives up the frame
 
 /************
 * kopouReceiver
@@ -73,6 +76,14 @@ void kopouReceiver::deinit() {
 // We start with the
 //
 void kopouReceiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void kopouReceiver::handlePulse(unsigned int duration) {
 	// This handler is written as one big fuction as that is the fastest
 	
 	if (!_enabled) {
@@ -83,32 +94,23 @@ void kopouReceiver::interruptHandler() {
 	static kopouCode receivedCode;		// Contains received code
 	static kopouCode previousCode;		// Contains previous received code
 	static byte repeats = 0;			// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
-	static unsigned int min1Period, max1Period, min2Period, max2Period;
 
 	// Allow for large error-margin. ElCheapo-hardware :(
 	// By default 1T is 120µs, but for maximum compatibility go as low as 100µs
-	min1Period =  90; // Lower limit for 0 period is 0.3 times measured period; high signals can "linger" a bit sometimes, making low signals quite short.
-	max1Period = 180; // Upper limit 
-	min2Period = 180; // Lower limit for a 1 bit
-	max2Period = 300; // Upper limit
+	const unsigned int min1Period =  90; // Lower limit for 0 period is 0.3 times measured period; high signals can "linger" a bit sometimes, making low signals quite short.
+	const unsigned int max1Period = 180; // Upper limit 
+	const unsigned int min2Period = 180; // Lower limit for a 1 bit
+	const unsigned int max2Period = 300; // Upper limit
 	
 	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
 	if (_state >= 0 && 
-		((edgeTimeStamp[2]-edgeTimeStamp[1] < min1Period) ||			// Filter shorts
-		 (edgeTimeStamp[2]-edgeTimeStamp[1] > max2Period)) )			// Filter Long
+		((duration < min1Period) ||			// Filter shorts
+		 (duration > max2Period)) )			// Filter Long
 	{
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 
-	//unsigned int duration = edgeTimeStamp[1] - edgeTimeStamp[0];
-	unsigned int duration = edgeTimeStamp[2] - edgeTimeStamp[1];
-	//edgeTimeStamp[0] = edgeTimeStamp[1];
-
 	// Note that if state>=0, duration is always >= 1 period.
 
 	if (_state == -1) {
@@ -145,13 +147,13 @@ void kopouReceiver::interruptHandler() {
 		else {									// This is the second pulse
 			if (duration > min2Period) {		// second pulse is short! -> 0 bit
 				if (receivedBit != 0) { 
-					RESET_STATE;
+					REJECT_STATE;
 					return;
 				}
 			}
 			else {								// second pulse is short -> expect a 1-bit
 				if (receivedBit != 1) { 
-					RESET_STATE;
+					REJECT_STATE;
 					return;
 				}
 			}
@@ -171,7 +173,7 @@ void kopouReceiver::interruptHandler() {
 		else {									// This is the second pulse
 			if (duration > min2Period) {		// second pulse is short! -> 0 bit
 				if (receivedBit != 0) { 
-					RESET_STATE;
+					REJECT_STATE;
 					return;
 				}
 #if STATISTICS==1
@@ -180,7 +182,7 @@ void kopouReceiver::interruptHandler() {
 				}
 			else {								// second pulse is short -> expect a 1-bit
 				if (receivedBit != 1) { 
-					RESET_STATE;
+					REJECT_STATE;
 					return;
 				}
 #if STATISTICS==1
@@ -191,7 +193,7 @@ void kopouReceiver::interruptHandler() {
 		}
 	} 
 	else { // Otherwise the entire sequence is invalid
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 
@@ -211,6 +213,7 @@ void kopouReceiver::interruptHandler() {
 		}		
 		repeats++;
 				
+		DecoderChain::countFrame(KOPOU, repeats >= _minRepeats ? FRAME_DECODED : FRAME_DUPLICATE);
 		if (repeats >= _minRepeats) {
 			if (!_inCallback) {
 				_inCallback = true;
@@ -6,8 +6,11 @@
  */
 
 #include "livoloReceiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
 
 #define RESET_STATE _state = -1 // Resets state to initial position.
+#define REJECT_STATE { if (_state >= 40) DecoderChain::countFrame(LIVOLO, FRAME_REJECTED); RESET_STATE; } // Gives up the frame
 
 /************
 * livoloReceiver
@@ -70,6 +73,14 @@ void livoloReceiver::deinit() {
 }
 
 void livoloReceiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void livoloReceiver::handlePulse(unsigned int duration) {
 	// This handler is written as one big fuction as that is the fastest
 	
 	if (!_enabled) {
@@ -80,32 +91,23 @@ void livoloReceiver::interruptHandler() {
 	static livoloCode receivedCode;		// Contains received code
 	static livoloCode previousCode;		// Contains previous received code
 	static byte repeats = 0;		// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
-	static unsigned int min1Period, max1Period, min3Period, max3Period;
 
 	// Allow for large error-margin. ElCheapo-hardware :(
 	// Be careful, when selecting a too large max3period the receiver will "claim" action messages too.
-	min1Period = 100; // Lower limit for 0 period is 0.3 times measured period; high signals can "linger" a bit sometimes, making low signals quite short.
-	max1Period = 230; // Upper limit 
-	min3Period = 240; // Lower limit for a 1 bit
-	max3Period = 400; // Upper limit
+	const unsigned int min1Period = 100; // Lower limit for 0 period is 0.3 times measured period; high signals can "linger" a bit sometimes, making low signals quite short.
+	const unsigned int max1Period = 230; // Upper limit 
+	const unsigned int min3Period = 240; // Lower limit for a 1 bit
+	const unsigned int max3Period = 400; // Upper limit
 	
 	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
 	if (_state >= 0 && 
-		((edgeTimeStamp[2]-edgeTimeStamp[1] < min1Period) ||			// Filter shorts
-		 (edgeTimeStamp[2]-edgeTimeStamp[1] > max3Period)) )			// Filter Long
+		((duration < min1Period) ||			// Filter shorts
+		 (duration > max3Period)) )			// Filter Long
 	{
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 
-	//unsigned int duration = edgeTimeStamp[1] - edgeTimeStamp[0];
-	unsigned int duration = edgeTimeStamp[2] - edgeTimeStamp[1];
-	//edgeTimeStamp[0] = edgeTimeStamp[1];
-
 	// Note that if state>=0, duration is always >= 1 period.
 
 	if (_state == -1) {
@@ -140,7 +142,7 @@ void livoloReceiver::interruptHandler() {
 			// We have a potential 0, if oneven _state and last read was also 0
 			if ((_state % 2) == 1) {
 				if (receivedBit != 0) { 
-					RESET_STATE;
+					REJECT_STATE;
 					return;
 				}
 				receivedCode.address = receivedCode.address *2 + receivedBit;
@@ -160,7 +162,7 @@ void livoloReceiver::interruptHandler() {
 			// We have a potential 0, if oneven _state and last read was also 0
 			if ((_state % 2) == 1) {
 				if (receivedBit != 0) { 
-					RESET_STATE;
+					REJECT_STATE;
 					return;
 				}
 				receivedCode.unit = receivedCode.unit *2 + receivedBit;
@@ -169,7 +171,7 @@ void livoloReceiver::interruptHandler() {
 		}
 	} 
 	else { // Otherwise the entire sequence is invalid
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
  
@@ -206,6 +208,7 @@ void livoloReceiver::interruptHandler() {
 				
 		repeats++;
 				
+		DecoderChain::countFrame(LIVOLO, repeats >= _minRepeats ? FRAME_DECODED : FRAME_DUPLICATE);
 		if (repeats >= _minRepeats) {
 			if (!_inCallback) {
 				_inCallback = true;
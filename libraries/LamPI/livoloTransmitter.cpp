@@ -26,80 +26,41 @@ Livolo::Livolo(byte pin)
 
 
 void Livolo::sendButton(unsigned int remoteID, byte keycode) {
+  PulseFrame frame;
+  frameButton(frame, remoteID, keycode);
+  PulseTransmitter::transmit(frame);
+}
+
+// Pulse durations: start, zero and one.
+// slightly corrected pulse length, use old values (550, 110, 303) if these not working for you
+
+void Livolo::frameButton(PulseFrame &frame, unsigned int remoteID, byte keycode) {
+  frame.begin(txPin, 181, 500, 100, 300); // how many times to transmit a command
 
-  for (pulse= 0; pulse <= 180; pulse = pulse+1) { // how many times to transmit a command
-  sendPulse(1); // Start  
-  high = true; // first pulse is always high
+  frame.add(0); // Start, first pulse is always high
 
   for (i = 16; i>0; i--) { // transmit remoteID
     byte txPulse=bitRead(remoteID, i-1); // read bits from remote ID
-    selectPulse(txPulse);    
+    selectPulse(frame, txPulse);
     }
 
   for (i = 7; i>0; i--) { // transmit keycode
     byte txPulse=bitRead(keycode, i-1); // read bits from keycode
-    selectPulse(txPulse);    
-    }    
+    selectPulse(frame, txPulse);
+    }
+  if (frame.count & 1) {
+    frame.add(1); // end low, so the start pulse of the next repeat is a separate pulse
   }
-   digitalWrite(txPin, LOW);
 }
 
-// build transmit sequence so that every high pulse is followed by low and vice versa
+// build transmit sequence so that every high pulse is followed by low and vice versa:
+// a zero is two short pulses, a one is one long pulse
 
-void Livolo::selectPulse(byte inBit) {
-  
-      switch (inBit) {
-      case 0: 
-       for (byte ii=1; ii<3; ii++) {
-        if (high == true) {   // if current pulse should be high, send High Zero
-          sendPulse(2); 
-        } else {              // else send Low Zero
-                sendPulse(4);
-        }
-        high=!high; // invert next pulse
-       }
-        break;
-      case 1:                // if current pulse should be high, send High One
-        if (high == true) {
-          sendPulse(3);
-        } else {             // else send Low One
-                sendPulse(5);
-        }
-        high=!high; // invert next pulse
-        break;        
-      }
+void Livolo::selectPulse(PulseFrame &frame, byte inBit) {
+  if (inBit) {
+    frame.add(2);
+  } else {
+    frame.add(1);
+    frame.add(1);
+  }
 }
-
-// transmit pulses
-// slightly corrected pulse length, use old (commented out) values if these not working for you
-
-void Livolo::sendPulse(byte txPulse) {
-
-  switch(txPulse) { // transmit pulse
-   case 1: // Start
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(500); // 550
-   // digitalWrite(txPin, LOW); 
-   break;
-   case 2: // "High Zero"
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(100); // 110
-   digitalWrite(txPin, HIGH);
-   break;   
-   case 3: // "High One"
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(300); // 303
-   digitalWrite(txPin, HIGH);
-   break;      
-   case 4: // "Low Zero"
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(100); // 110
-   digitalWrite(txPin, LOW);
-   break;      
-   case 5: // "Low One"
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(300); // 290
-   digitalWrite(txPin, LOW);
-   break;      
-  } 
-}
\ No newline at end of file
@@ -8,19 +8,18 @@
 #define Livolo_h
 
 #include "Arduino.h"
+#include "PulseTransmitter.h"
 
 class Livolo
 {
   public:
     Livolo(byte pin);
     void sendButton(unsigned int remoteID, byte keycode);
+    void frameButton(PulseFrame &frame, unsigned int remoteID, byte keycode); // queue with PulseTransmitter::queue()
   private:
     byte txPin;
 	byte i; // just a counter
-	byte pulse; // counter for command repeat
-	boolean high; // pulse "sign"
-	void selectPulse(byte inBit);
-	void sendPulse(byte txPulse);
+	void selectPulse(PulseFrame &frame, byte inBit);
 };
 
 #endif
\ No newline at end of file
@@ -6,8 +6,11 @@
  */
 
 #include "quhwaReceiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
 
 #define RESET_STATE _state = -1 // Resets state to initial position.
+#define REJECT_STATE { if (_state >= 40) DecoderChain::countFrame(QUHWA, FRAME_REJECTED); RESET_STATE; } // Gives up the frame
 
 /************
 * quhwaReceiver
@@ -71,6 +74,14 @@ void quhwaReceiver::deinit() {
 // We start with the
 //
 void quhwaReceiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void quhwaReceiver::handlePulse(unsigned int duration) {
 	// This handler is written as one big fuction as that is the fastest
 	
 	if (!_enabled) {
@@ -82,7 +93,6 @@ void quhwaReceiver::interruptHandler() {
 	static quhwaCode receivedCode;		// Contains received code
 	static quhwaCode previousCode;		// Contains previous received code
 	static byte repeats = 0;			// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
 	
 	//static unsigned int min1Period, max1Period, min3Period, max3Period;
 	// What are the minimum and maximum values for 1 pulse and for 3 pulses (1)
@@ -92,21 +102,14 @@ void quhwaReceiver::interruptHandler() {
 #	define _max3Period 1250
 	
 	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
 	if (_state >= 0 && 
-		((edgeTimeStamp[2]-edgeTimeStamp[1] < _min1Period) ||			// Filter shorts
-		 (edgeTimeStamp[2]-edgeTimeStamp[1] > _max3Period)) )			// Filter Long
+		((duration < _min1Period) ||			// Filter shorts
+		 (duration > _max3Period)) )			// Filter Long
 	{
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 	
-	//unsigned int duration = edgeTimeStamp[1] - edgeTimeStamp[0];
-	unsigned int duration = edgeTimeStamp[2] - edgeTimeStamp[1];
-	//edgeTimeStamp[0] = edgeTimeStamp[1];
-
 	// Note that if state>=0, duration is always >= 1 period.
 
 	if (_state == -1) {
@@ -168,7 +171,7 @@ void quhwaReceiver::interruptHandler() {
 		}
 		receivedCode.unit = receivedCode.unit *2 + receivedBit;
 	} else {
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 	
@@ -192,6 +195,7 @@ void quhwaReceiver::interruptHandler() {
 		}		
 		repeats++;
 				
+		DecoderChain::countFrame(QUHWA, repeats >= _minRepeats ? FRAME_DECODED : FRAME_DUPLICATE);
 		if (repeats >= _minRepeats) {
 			if (!_inCallback) {
 				_inCallback = true;
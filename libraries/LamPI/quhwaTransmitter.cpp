@@ -21,88 +21,37 @@ Quhwa::Quhwa(byte pin)
 // Send the code (multiple times) for the Bell Button
 
 void Quhwa::sendButton(unsigned long remoteID, byte keycode) {
-  Serial.println();
-  Serial.print("Quhwa TX g: ");
-  Serial.print(remoteID);
-  Serial.print(", u: ");
-  Serial.println(keycode);
+  PulseFrame frame;
+  frameButton(frame, remoteID, keycode);
+  PulseTransmitter::transmit(frame);
+}
+
+void Quhwa::frameButton(PulseFrame &frame, unsigned long remoteID, byte keycode) {
   // how many times to transmit a command
-  for (pulse= 0; pulse <= 25; pulse++) { 
-    sendPulse(1); 	// Start  
-    high = true;	// first pulse is always high
+  frame.begin(txPin, 26, QUHWA_0, QUHWA_START, QUHWA_1);
 
-    for (i = 27; i>0; i--) { // transmit remoteID
-		byte txPulse=bitRead(remoteID, i-1); // read bits from remote ID
-		selectPulse(txPulse);
-    }
+  frame.add(0);				// Start: high 350, low 6000
+  frame.add(1);
 
-    for (i = 8; i>0; i--) { // transmit keycode
-		byte txPulse=bitRead(keycode, i-1); // read bits from keycode
-		selectPulse(txPulse); 	
-    }
-	
-	// After last pulse, change
-	if (high)
-		digitalWrite(txPin, HIGH);
-	else
-		digitalWrite(txPin, LOW);
+  for (i = 27; i>0; i--) { // transmit remoteID
+	byte txPulse=bitRead(remoteID, i-1); // read bits from remote ID
+	selectPulse(frame, txPulse);
   }
-}
 
-// build transmit sequence so that every high pulse is followed by low and vice versa
+  for (i = 8; i>0; i--) { // transmit keycode
+	byte txPulse=bitRead(keycode, i-1); // read bits from keycode
+	selectPulse(frame, txPulse);
+  }
 
-void Quhwa::selectPulse(byte inBit) {
-    switch (inBit) {
-      case 0: 
-        if (high == true) {		// if current pulse should be high, send High Zero
-			sendPulse(4); 
-        } else {        		// else send Low Zero
-			sendPulse(2);
-        }
-        high=!high; 			// invert next pulse
-      break;
-      case 1:          			// if current pulse should be high, send High One
-        if (high == true) {
-			sendPulse(5);
-        } else {				// else send Low One
-			sendPulse(3);
-        }
-        high=!high;				// invert next pulse
-      break;        
-    }
+  // After last pulse, change: end low, so the start pulse of the next repeat is a separate pulse
+  if (frame.count & 1) {
+	frame.add(0);
+  }
 }
 
-// transmit pulses
-// slightly corrected pulse length, use old (commented out) values if these not working for you
+// build transmit sequence so that every high pulse is followed by low and vice versa:
+// a zero is one short pulse, a one is one long pulse, first pulse is always high
 
-void Quhwa::sendPulse(byte txPulse) {
-  switch(txPulse) { // transmit pulse
-   case 1:							// Start
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(350);
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(6000); 		// 5800
-   digitalWrite(txPin, HIGH); 
-   break;
-   case 2:							// "Low Zero"
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(350); 			// 350
-   digitalWrite(txPin, HIGH);
-   break;
-   case 3:							// "Low One"
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(1050); 		// 1050
-   digitalWrite(txPin, HIGH);
-   break;
-   case 4:							// "High Zero"
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(350); 			// 350
-   digitalWrite(txPin, LOW);
-   break;      
-   case 5:							// "High One"
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(1050); 		// 1050
-   digitalWrite(txPin, LOW);
-   break;      
-  } 
-}
\ No newline at end of file
+void Quhwa::selectPulse(PulseFrame &frame, byte inBit) {
+  frame.add(inBit ? 2 : 0);
+}
@@ -10,6 +10,7 @@
 #define Quhwa_h
 
 #include "Arduino.h"
+#include "PulseTransmitter.h"
 
 //
 // Pulse is 350 uSec, 0
@@ -25,13 +26,11 @@ class Quhwa
   public:
     Quhwa(byte pin);
     void sendButton(unsigned long remoteID, byte keycode);
+    void frameButton(PulseFrame &frame, unsigned long remoteID, byte keycode);	// queue with PulseTransmitter::queue()
   private:
     byte txPin;
 	byte i; 				// just a counter
-	byte pulse; 			// counter for command repeat
-	boolean high; 			// pulse "sign"
-	void selectPulse(byte inBit);
-	void sendPulse(byte txPulse);
+	void selectPulse(PulseFrame &frame, byte inBit);
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,5 @@
 /*
- * Queue library v1.7.5 (151129)
+ * Queue library v1.7.8
  *
  * Copyright 2015-2015 by M Westenberg (mw12554@hotmail.com)
  *
@@ -7,82 +7,143 @@
  */
 
 #include <wifiQueue.h>
-     
-void QueueLink::init(queueItem itemIn, QueueLink *nextIn) {
-	item = itemIn;					// Should copy the complete structure
-	next = nextIn;
-}
+#include <LamPI.h>
+
+// Short critical sections that also work inside an interrupt: the interrupt state is
+// restored instead of interrupts being enabled.
+#if defined(__AVR__)
+#define QUEUE_LOCK() uint8_t savedState = SREG; cli()
+#define QUEUE_UNLOCK() SREG = savedState
+#elif defined(ESP8266)
+#define QUEUE_LOCK() uint32_t savedState = xt_rsil(15)
+#define QUEUE_UNLOCK() xt_wsr_ps(savedState)
+#else
+#define QUEUE_LOCK()
+#define QUEUE_UNLOCK()
+#endif
 
-QueueLink *QueueChain::queue = NULL;
-byte QueueChain::mode = 0;
+queueItem QueueChain::_ring[MAX_QUEUE];
+volatile byte QueueChain::_head = 0;
+volatile byte QueueChain::_tail = 0;
+byte QueueChain::mode = QUEUE_DROP_OLDEST;
+byte QueueChain::_highWater = 0;
+volatile unsigned int QueueChain::_dropped = 0;
 
 // OK
 void QueueChain::setMode(byte modeIn) {     
     mode = modeIn;
 }
 
-// Add an item to the queue. Including the function needed to process....
-// We need to add members at the backend of the queue for first in first out operation
+// Add an item at the end of the queue, first in first out.
+// The indices are free running bytes, (byte)(_head - _tail) is the number of entries.
 //
-void QueueChain::addQueue(queueItem item, QueueCallback callback) {
-  if (queue == NULL) {
-	    queue = (QueueLink *) malloc(sizeof(QueueLink));
-		queue->init(item, NULL);
-  } 
-  else {
-	QueueLink *walk = queue;
-	while (walk->next != NULL) {
-		walk = walk->next;
+boolean QueueChain::addQueue(const queueItem &item, QueueCallback callback) {
+	boolean ok = true;
+	QUEUE_LOCK();
+	if ((byte)(_head - _tail) >= MAX_QUEUE) {
+		_dropped++;
+		ok = false;
+		if (mode == QUEUE_DROP_NEWEST) {
+			QUEUE_UNLOCK();
+			return(false);
+		}
+		_tail++;						// Oldest entry is overwritten below
 	}
-	walk->next = (QueueLink *) malloc(sizeof(QueueLink)); // malloc instead of new, due to the lack of new / delete support in AVR-libc
-	walk = walk->next;
-	walk->init(item, NULL); 
-  }
-}
-
-// XXX Delete an interrupt from the interrupt chain.
-void QueueChain::delQueue(queueItem item, QueueCallback callback) {
-  QueueLink *prevLink = queue; // Note: the chain-array is NULL initialized, so the first time prevLink is indeed NULL
-  queue = (QueueLink *) malloc(sizeof(QueueLink)); // malloc instead of new, due to the lack of new / delete support in AVR-libc
-  queue->init(item, prevLink);      
+	_ring[_head & (MAX_QUEUE - 1)] = item;
+	_head++;
+	byte n = _head - _tail;
+	if (n > _highWater) _highWater = n;
+	QUEUE_UNLOCK();
+	return(ok);
 }
 
 // This function is non descruptive for the queue
 void QueueChain::printQueue() {
-	QueueLink *q;
-	q = queue;
-	if (q != NULL) Serial.println(F("Print Sensor QUEUE: "));
-	while (q != NULL) {
-		Serial.print(F("\tA: ")); Serial.print(q->item.address) ;
-		Serial.print(F(", C: ")); Serial.print(q->item.channel) ;
-		Serial.print(F(", B: ")); Serial.print(q->item.brand) ;
-		Serial.print(F(", L: ")); Serial.print(q->item.label) ;
-		Serial.print(F(", V: ")); Serial.print(q->item.value) ;
+	byte head = _head;
+	byte t = _tail;
+	if (t != head) Serial.println(F("Print Sensor QUEUE: "));
+	for (; t != head; t++) {
+		queueItem *q = &_ring[t & (MAX_QUEUE - 1)];
+		Serial.print(F("\t")); Serial.print(actionName(q->action)) ;
+		Serial.print(F(" A: ")); Serial.print(q->address) ;
+		Serial.print(F(", C: ")); Serial.print(q->channel) ;
+		Serial.print(F(", B: ")); Serial.print(codecName(q->brand)) ;
+		Serial.print(F(", L: ")); Serial.print(q->label) ;
+		Serial.print(F(", V: ")); Serial.print(q->value) ;
 		Serial.println();
-		q = q->next;
 	}
 }
 
 // processQueue starts at the from-end of the queue (oldest members)
-// We have to be carefull when adding to the queue to protect the queue head.
-// We use a pointer else we will not be be to output.
+// The item is copied with interrupts enabled. If addQueue() dropped the oldest entry
+// during the copy, the copy may be a mix of two items: it is thrown away and the new
+// oldest entry is taken instead.
 // Memory allocation is done by calling function!
-// After returning the first item, the item is removed from the queue
-// and its memory is released
 int QueueChain::processQueue(queueItem *itemIn) {
-	QueueLink *ql;
-	if (queue != NULL) {
-		// Lock queue for a small time
-		ql = queue;
-		// If exactly at this moment the interrupt routine kicks in
-		queue = queue->next;			// Now we're ready for new queue
-		// From this moment on there is no danger
-		// output the item
-		*itemIn = ql->item;
-		// Delete node
-		free(ql);
-		// return value
-		return (0);
+	for (;;) {
+		byte t = _tail;
+		if (t == _head) {
+			return (-1);
+		}
+		*itemIn = _ring[t & (MAX_QUEUE - 1)];
+		QUEUE_LOCK();
+		boolean ok = (_tail == t);
+		if (ok) _tail = t + 1;
+		QUEUE_UNLOCK();
+		if (ok) {
+			return (0);
+		}
+	}
+}
+
+byte QueueChain::count() {
+	return (_head - _tail);
+}
+
+byte QueueChain::getHighWater() {
+	return (_highWater);
+}
+
+unsigned int QueueChain::getDropped() {
+	return (_dropped);
+}
+
+const char *QueueChain::actionName(byte action) {
+	switch (action) {
+		case Q_SENSOR: return ("sensor");
+		case Q_GUI: return ("gui");
+		case Q_HANDSET: return ("handset");
+	}
+	return ("unknown");
+}
+
+const char *QueueChain::codecName(byte codec) {
+	switch (codec) {
+		case KAKU: return ("kaku");
+		case ACTION: return ("action");
+		case BLOKKER: return ("blokker");
+		case KAKUOLD: return ("kakuold");
+		case ELRO: return ("elro");
+		case LIVOLO: return ("livolo");
+		case KOPOU: return ("kopou");
+		case QUHWA: return ("quhwa");
+		case ONBOARD: return ("onboard");
+		case WT440: return ("wt440");
+		case OREGON: return ("oregon");
+		case AURIOL: return ("auriol");
+		case CRESTA: return ("cresta");
+		case OOK: return ("ook");
+	}
+	return ("unknown");
+}
+
+const char *QueueChain::labelName(byte label) {
+	switch (label) {
+		case Q_TEMPERATURE: return ("temperature");
+		case Q_HUMIDITY: return ("humidity");
+		case Q_AIRPRESSURE: return ("airpressure");
+		case Q_PIR: return ("pir");
+		case Q_BATTERY: return ("battery");
 	}
-	return (-1);
+	return ("unknown");
 }
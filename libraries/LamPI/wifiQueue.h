@@ -11,46 +11,109 @@
 
 #include <Arduino.h>
 
-// We have to define how many entries are allowd in the Queue.
-// As all entries have memory availble through malloc() there should not be a problem.
-#define MAX_QUEUE 32
+// We have to define how many entries are allowed in the Queue. The queue is a static ring
+// buffer of MAX_QUEUE entries of 12 bytes, so no malloc() is needed. Must be a power of 2 and
+// at most 128.
+#ifndef MAX_QUEUE
+#define MAX_QUEUE 128
+#endif
+
+// What addQueue() does when the queue is full
+#define QUEUE_DROP_OLDEST 0				// Overwrite the oldest entry, newer sensor values matter more
+#define QUEUE_DROP_NEWEST 1				// Discard the new entry
 
 typedef void (*QueueCallback)();
 
+// Values of queueItem.action
+#define Q_SENSOR 0
+#define Q_GUI 1
+#define Q_HANDSET 2
+
+// Values of queueItem.label for sensors: what was measured
+#define Q_TEMPERATURE 0
+#define Q_HUMIDITY 1
+#define Q_AIRPRESSURE 2
+#define Q_PIR 3
+#define Q_BATTERY 4
+
+// Values of queueItem.label for devices: how value is sent to the daemon
+#define Q_ONOFF 16						// val "off"/"on", message "!A<gaddr>D<uaddr>F0" or F1
+#define Q_DIM 17						// val "<value>", message "!A<gaddr>D<uaddr>FdP<value>"
+#define Q_LEVEL 18						// val "<value>", message "!A<gaddr>D<uaddr>F<value>"
+
 // We need to use this structure for both sensors and devices.
 // As a result we'll need to double up some felds
-// without enlarging memory usage.
+// without enlarging memory usage. Everything is a number, the text for the daemon
+// is only made when the item is sent, see QueueChain::actionName() etc.
 struct queueItem {
 		union { uint32_t address; uint32_t gaddr; };
+		int32_t value;									// sensors: value * 10, devices: level
 		union { uint8_t channel; uint8_t uaddr; };		// channel is used with sensors, uaddr for devices
-		union { float value; char val[4]; };			// val can be "off", "on", 0-15
-		char action[8];									// both sensors and device messages have action 
-		char type[8];									// and type;
-		union { char brand[8]; char cmd[8]; };
-		union { char label[16]; char message[16]; };
-};
-
-//
-// For internal use
-//
-class QueueLink {
-	public:
-		QueueLink *next;
-		queueItem item;
-		void init(queueItem itemIn, QueueLink *nextIn);		
+		uint8_t action;									// Q_SENSOR, Q_GUI or Q_HANDSET
+		union { uint8_t brand; uint8_t cmd; };			// Codec, KAKU, WT440 etc. See LamPI.h
+		uint8_t label;									// Q_TEMPERATURE etc. or Q_ONOFF etc.
 };
 
+/**
+* QueueChain passes messages from the receiver interrupts to loop(), which sends them over Wifi.
+*
+* The queue is a ring of MAX_QUEUE entries with free-running indices, so adding and taking an
+* entry is O(1) and the heap is not used. addQueue() runs with interrupts disabled for a few
+* microseconds, so it may be called from interrupts and from loop(). processQueue() copies the
+* entry with interrupts enabled, and only keeps the copy if addQueue() did not drop that entry
+* meanwhile.
+*
+* This is a pure static class, for simplicity and to limit memory-use.
+*/
 class QueueChain {  
 	public:
-		// Add an  handler on interrupt queueNr. The callback is of the same type as	
-		static void addQueue(queueItem item, QueueCallback callbackIn);
-		static void delQueue(queueItem item, QueueCallback callbackIn);		
-		//Set the queue mode for given queue number. 
+		/**
+		* Adds a copy of item at the end of the queue. Can be called from an interrupt.
+		*
+		* @param callback	Not used, for compatibility.
+		* @return false if the queue was full and an item was dropped (see setMode()).
+		*/
+		static boolean addQueue(const queueItem &item, QueueCallback callback = NULL);
+
+		/**
+		* Sets what to do when the queue is full: QUEUE_DROP_OLDEST (default) or QUEUE_DROP_NEWEST.
+		*/
 		static void setMode(byte modeIn);
+
+		/**
+		* Prints the queue to Serial, oldest entry first, without removing anything.
+		*/
 		static void printQueue();
+
+		/**
+		* Takes the oldest item from the queue.
+		*
+		* @return 0 if an item was copied to itemIn, -1 if the queue was empty.
+		*/
 		static int processQueue(queueItem *itemIn);
+
+		/**
+		* Number of items in the queue, the largest number of items that was ever in the
+		* queue, and the number of items dropped because the queue was full.
+		*/
+		static byte count();
+		static byte getHighWater();
+		static unsigned int getDropped();
+
+		/**
+		* Text of the action, codec and label numbers of a queueItem, as used in the messages to
+		* the daemon ("sensor", "kaku", "temperature" etc.). Unknown numbers give "unknown".
+		*/
+		static const char *actionName(byte action);
+		static const char *codecName(byte codec);
+		static const char *labelName(byte label);
+
 	private:
-		static QueueLink *queue;
+		static queueItem _ring[MAX_QUEUE];
+		static volatile byte _head;			// Next free entry, written by addQueue() only
+		static volatile byte _tail;			// Oldest entry, moved by addQueue() when it drops it
 		static byte mode;
+		static byte _highWater;
+		static volatile unsigned int _dropped;
 };
 #endif
\ No newline at end of file
@@ -8,8 +8,12 @@
  */
 
 #define RESET_STATE _state = -1 // Resets state to initial position.
+#define REJECT_STATE { if (_state >= 30) DecoderChain::countFrame(WT440, FRAME_REJECTED); RESET_STATE; } // Gives up the frame
+#define WT440_KEY 0xFF800000UL // Address, channel and constant: the frames of one sensor message
 
 #include "wt440Receiver.h"
+#include <DecoderChain.h>
+#include <LamPI.h>
 
 /************
  * wt440Receiver
@@ -38,7 +42,8 @@
  * how far to read ahead is enough to have potentially received a whole message.
  * 
  * As far as I can see, every message is sent 2 times, interval is 1 minute between
- * sending new values from the sensor.
+ * sending new values from the sensor. The repeats of a message are checked on parity and
+ * voted on by RepeatVote, and one reading per message is passed to the callback.
  *
  * PULSE defines are found in the LamPI-wt440.h include file. T=1000, 2T = 2000
  #define WT440H_MIN_SHORT 700
@@ -54,6 +59,7 @@ byte wt440Receiver::_minRepeats;
 wt440ReceiverCallBack wt440Receiver::_callback;
 boolean wt440Receiver::_inCallback = false;
 boolean wt440Receiver::_enabled = false;
+RepeatVote wt440Receiver::_vote;
 
 void wt440Receiver::init(int8_t interrupt, byte minRepeats, wt440ReceiverCallBack callback) {
 	_interrupt = interrupt;
@@ -83,6 +89,14 @@ void wt440Receiver::deinit() {
 }
 
 void wt440Receiver::interruptHandler() {
+	static unsigned long lastEdge;
+	unsigned long now = micros();
+	unsigned long pulse = now - lastEdge;
+	lastEdge = now;
+	handlePulse(pulse > 0xFFFF ? 0xFFFF : pulse);
+}
+
+void wt440Receiver::handlePulse(unsigned int duration) {
 	// This method is written as compact code to keep it fast. While breaking up this method into more
 	// methods would certainly increase the readability, it would also be much slower to execute.
 	// Making calls to other methods is quite expensive on AVR. As These interrupt handlers are called
@@ -94,42 +108,25 @@ void wt440Receiver::interruptHandler() {
 
 
 	static wt440Code receivedCode;		// Contains received code
-	static wt440Code previousCode;		// Contains previous received code
+	static uint32_t receivedBits;		// The 32 bits after the leader
 	static byte receivedBit;			// Contains "bit" currently receiving
-	static byte repeats = 0;			// The number of times the an identical code is received in a row.
-	static unsigned long edgeTimeStamp[3] = {0, };	// Timestamp of edges
-	static uint16_t min1period, max1period, min2period, max2period;
-	static bool skip;
 
 	// Allow for large error-margin. ElCheapo-hardware :(
-	min1period = 700; // Lower limit for 1 period is 0.3 times measured period; high signals can "linger" a bit sometimes, making low signals quite short.
-	max1period = 1500; // Upper limit 
-	min2period = 1500; // Lower limit 
-	max2period = 2400; // Upper limit 
+	const uint16_t min1period = 700; // Lower limit for 1 period is 0.3 times measured period; high signals can "linger" a bit sometimes, making low signals quite short.
+	const uint16_t max1period = 1500; // Upper limit 
+	const uint16_t min2period = 1500; // Lower limit 
+	const uint16_t max2period = 2400; // Upper limit 
 	
 	// Filter out too short pulses. This method works as a low pass filter.
-	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
-
-	if (skip) {
-		skip = false;
-		return;
-	}
-
-	if (_state >= 0 && edgeTimeStamp[2]-edgeTimeStamp[1] < min1period) {
+	if (_state >= 0 && duration < min1period) {
 		// Last edge was too short.
-		// Skip this edge, and the next too.
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 	
-	// unsigned int duration = edgeTimeStamp[1] - edgeTimeStamp[0];
-	uint16_t duration = edgeTimeStamp[2] - edgeTimeStamp[1];
-	edgeTimeStamp[0] = edgeTimeStamp[1];
-	
 	// Filter
 	if (duration > max2period) {
-		RESET_STATE;
+		REJECT_STATE;
 		return;
 	}
 
@@ -148,14 +145,6 @@ void wt440Receiver::interruptHandler() {
 			receivedCode.min2Period = max2period;
 			receivedCode.max2Period = min2period;
 #endif
-			//receivedCode.period = duration  ; 	// 
-			receivedCode.sync = 1;				// First state (this one) is OK
-			receivedCode.address= 0;
-			receivedCode.channel= 0;
-			receivedCode.wconst= 0;
-			receivedCode.humidity= 0;
-			receivedCode.temperature= 0;
-			receivedCode.par= 0;				// First pulse is even and doe snot count
 			_state++;							// State is now 0, we have started
 		}
 		else {
@@ -165,44 +154,23 @@ void wt440Receiver::interruptHandler() {
 	if (_state < 4) { // Verify start bit 1 and 2, are 4 pulses!
 		// Duration must be ~1T
 		if (duration > max1period) {
-			RESET_STATE;
+			REJECT_STATE;
 			return;
 		}
-		if (_state % 2 == 1 ) {
-			receivedCode.sync = receivedCode.sync << 1 + 1;
-			receivedCode.par ^= 1;
-		}
 	} else 
     //	Bit 3 and 4 are 0 (long)	
 	if (_state < 8) { // Verify start bit part 3 en 4 of Sync pulse
 		// Duration must be 2 pulses
 		if ((duration < min2period) || (duration > max2period)){
-			RESET_STATE;
+			REJECT_STATE;
 			return;
 		}
 		_state++;
-		receivedCode.sync = receivedCode.sync << 1; // + 0
-		receivedCode.par ^= 0;
-	} else 
-	// Address is 4 bits, max 8 pulses	
-	if (_state < 16) { // 
-		//if (receivedCode.sync != 6) { RESET_STATE; return; }
-
-		if (duration > max1period) {
-			// We have a 0
-			_state++;
-			receivedCode.address = receivedCode.address * 2 ; // + 0;
-			receivedCode.par ^= 0;
-		}
-		else { 
-			if (_state % 2 == 1 ) {
-				receivedCode.address = ( receivedCode.address * 2 ) + 1; 
-				receivedCode.par ^= 1;				
-			}
-		}
+		receivedBits = 0;
 	} else
-	// Channel is 2 bits
-	if (_state < 20) { // 
+	// Address 4 bits, channel 2 bits, constant 3 bits, humidity 7 bits, temperature 15 bits
+	// and parity 1 bit: 32 bits in 64 states. A 0 is one long pulse and takes 2 states.
+	if (_state < 72) {
 		if (duration > max1period) {
 			// We have a 0
 			_state++;
@@ -212,74 +180,11 @@ void wt440Receiver::interruptHandler() {
 			receivedBit = 1; 
 		}
 		if (_state % 2 == 1 ) {
-			receivedCode.channel = ( receivedCode.channel << 1 ) + receivedBit; 
-			receivedCode.par ^= receivedBit;
-		}
-	} else
-	// Constant 3 bits
-	if (_state < 26) { // 
-		if (duration > max1period) {
-			_state++;
-			receivedBit = 0;
-		}
-		else { 
-			receivedBit = 1; 
-		}
-		if (_state % 2 == 1 ) {
-			receivedCode.wconst = ( receivedCode.wconst << 1 ) + receivedBit; 
-			receivedCode.par ^= 1;
+			receivedBits = (receivedBits << 1) | receivedBit;
 		}
-	} else
-	// humidity 7 bits
-	if (_state < 40) { 
-		// If constant not equals 6, do not bother
-		//if (receivedCode.wconst != 6) {
-		//	Serial.print(F("! WH440 batt")); Serial.println(receivedCode.channel); // Check later!!!
-		//	RESET_STATE;
-		//	return;
-		//}
-		if (duration > max1period) {
-			// We have a 0
-			_state++;
-			receivedBit = 0;
-		}
-		else { 
-			receivedBit = 1; 
-		}
-		if (_state % 2 == 1 ) {
-			receivedCode.humidity = ( receivedCode.humidity * 2 ) + receivedBit;
-			receivedCode.par ^= receivedBit;
-		}
-	} else
-	// Temperature 15 bits
-	if (_state < 70) { // 
-		if (duration > max1period) {
-			// We have a 0
-			_state++;
-			receivedBit = 0;
-		}
-		else { 
-			receivedBit = 1; 
-		}
-		if (_state % 2 == 1 ) {
-			receivedCode.temperature = ( receivedCode.temperature * 2 ) + receivedBit; 
-			receivedCode.par ^= receivedBit;
-		}
-	} else
-	// parity is 1 bit
-	if (_state < 72) { // 
-		if (duration > max1period) {
-			// We have a 0
-			_state++;
-			receivedBit = 0;
-		}
-		else { 
-			receivedBit = 1; 
-		}
-		if (_state % 2 == 1 ) receivedCode.par ^= receivedBit; // No use for a 0 value
 	} 
 	else { // Otherwise the entire sequence is invalid
-			RESET_STATE;
+			REJECT_STATE;
 			return;
 	}
 	_state++;
@@ -297,36 +202,21 @@ void wt440Receiver::interruptHandler() {
 #endif	
 	// Message complete, just in case we check on >72 chars too
 	if (_state >= 72) {
-		
-		// a valid signal was found!
-		if (
-			receivedCode.sync != previousCode.sync ||
-			receivedCode.address != previousCode.address ||
-			receivedCode.channel != previousCode.channel ||
-			receivedCode.temperature != previousCode.temperature ||
-			receivedCode.humidity != previousCode.humidity ||
-			receivedCode.par != previousCode.par 
-			) { 
-					repeats=0;
-					previousCode = receivedCode;
-					// if below is temporary
-					if (receivedCode.par != previousCode.par){
-						Serial.print(F(" ! WT440 P err C: "));
-						Serial.println(receivedCode.channel);
-					}
-		}
-				
-		repeats++;
-				
-		if (repeats>=_minRepeats) {
+		byte result = _vote.add(receivedBits, WT440_KEY, _minRepeats);
+		DecoderChain::countFrame(WT440, result);
+		if (result == FRAME_DECODED) {
+			receivedCode.sync = B1100;
+			receivedCode.address = receivedBits >> 28;
+			receivedCode.channel = (receivedBits >> 26) & B11;
+			receivedCode.wconst = (receivedBits >> 23) & B111;
+			receivedCode.humidity = (receivedBits >> 16) & 0x7F;
+			receivedCode.temperature = (receivedBits >> 1) & 0x7FFF;
+			receivedCode.par = 0;
 			if (!_inCallback) {
 				_inCallback = true;
 				(_callback)(receivedCode);
 				_inCallback = false;
 			}
-			// Reset after callback.
-			RESET_STATE;
-			return;
 		}
 				
 		// Reset for next round
@@ -8,6 +8,7 @@
 #define wt440Receiver_h
 
 #include <Arduino.h>
+#include <RepeatVote.h>
 
 struct wt440Code {
 	//unsigned int period;		// Detected duration in microseconds of 1T in the received signal
@@ -17,7 +18,7 @@ struct wt440Code {
 	uint8_t wconst;					// 3 bits
 	int16_t temperature;			//14 bits temperature (encoded)
 	uint8_t humidity;				// 8 bits humidity
-	uint8_t par;					// 1 bit (Xor must be 0)
+	uint8_t par;					// 1 bit (Xor must be 0, always 0 when delivered)
 #if STATISTICS==1
 	int16_t min1Period;			// Statistics!
 	int16_t max1Period;
@@ -55,7 +56,8 @@ class wt440Receiver {
 		*
 		* @param interrupt 	The interrupt as is used by Arduino's attachInterrupt function. See attachInterrupt for details.
 							If < 0, you must call interruptHandler() yourself.
-		* @param minRepeats The number of times the same code must be received in a row before the callback is called
+		* @param minRepeats The number of times the same code must be received in a burst before the callback is called.
+		*					Repeats with bit errors are corrected by a vote, see RepeatVote.
 		* @param callback Pointer to a callback function, with signature void (*func)(wt440Code)
 		*/
 		static void init(int8_t interrupt, byte minRepeats, wt440ReceiverCallBack callback);
@@ -94,6 +96,15 @@ class wt440Receiver {
 		 */
 		static void interruptHandler();
 
+		/**
+		 * Decodes one pulse, i.e. the time between the previous and the current edge. Called by
+		 * interruptHandler(), or directly by DecoderChain which timestamps every edge only once
+		 * for all decoders.
+		 *
+		 * @param duration Duration of the pulse in microseconds, clipped to 65535.
+		 */
+		static void handlePulse(unsigned int duration);
+
 	private:
 
 		static int8_t _interrupt;					// Radio input interrupt
@@ -102,6 +113,7 @@ class wt440Receiver {
 		static wt440ReceiverCallBack _callback;
 		static boolean _inCallback;					// When true, the callback function is being executed; prevents re-entrance.
 		static boolean _enabled;					// If true, monitoring and decoding is enabled. If false, interruptHandler will return immediately.
+		static RepeatVote _vote;					// Repeats of the current bursts
 
 };
 
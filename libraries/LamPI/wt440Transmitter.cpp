@@ -47,28 +47,33 @@ wt440Transmitter::wt440Transmitter(byte pin)
 */
 
 void wt440Transmitter::sendMsg(wt440TxCode msgCode) {
-  unsigned int temp, humi;
-  
-  // Retransmit 4 times to transmit a command
-  for (pulse= 0; pulse <= 3; pulse = pulse+1) {
+  PulseFrame frame;
+  frameMsg(frame, msgCode);
+  PulseTransmitter::transmit(frame);
+}
+
+void wt440Transmitter::frameMsg(PulseFrame &frame, wt440TxCode msgCode) {
 	byte par = 0;
-  	high = false;	// XXX first pulse is always low-high
-	
-	selectPulse(1); // Start  
-	selectPulse(1); // Start
-	selectPulse(0); // Start
-	selectPulse(0); // Start
+
+	// Retransmit 4 times to transmit a command, first pulse is always low-high
+	frame.begin(txPin, 4, PULSE1, PULSE0);
+	frame.gap = 50000;					// Avoid receiver pick up transmission
+
+	selectPulse(frame, 1); // Start
+	selectPulse(frame, 1); // Start
+	selectPulse(frame, 0); // Start
+	selectPulse(frame, 0); // Start
 
 	for (i = 4; i>0; i--) { // transmit address of 4 bits
 		byte txPulse=bitRead(msgCode.address, i-1); // read bits from address
 		par ^= txPulse;
-		selectPulse(txPulse);    
+		selectPulse(frame, txPulse);
     }
 
 	for (i = 2; i>0; i--) { // transmit channel of 2 bits
 		byte txPulse=bitRead(msgCode.channel, i-1); // read bits from keycode
 		par ^= txPulse;
-		selectPulse(txPulse);    
+		selectPulse(frame, txPulse);
 	}
 	
 	for (i = 3; i>0; i--) { // transmit wcode of 3 bits
@@ -78,7 +83,7 @@ void wt440Transmitter::sendMsg(wt440TxCode msgCode) {
 		Serial.print(txPulse);
 		Serial.print(F(":"));
 #endif
-		selectPulse(txPulse);    
+		selectPulse(frame, txPulse);
 	}
 #if STATISTICS==1
 		Serial.println();
@@ -91,74 +96,25 @@ void wt440Transmitter::sendMsg(wt440TxCode msgCode) {
 	for (i = 7; i>0; i--) { // transmit humi of 8 bits
 		byte txPulse=bitRead(msgCode.humi, i-1); // read bits from keycode
 		par ^= txPulse;
-		selectPulse(txPulse);    
+		selectPulse(frame, txPulse);
 	}
 	
 	for (i = 15; i>0; i--) { // transmit temp of 8 bits
 		byte txPulse=bitRead(msgCode.temp, i-1); // read bits from keycode
 		par ^= txPulse;
-		selectPulse(txPulse);    
+		selectPulse(frame, txPulse);
 	}
-	selectPulse((byte)par);
-	delay(50);							// Avoid receiver pick up transmission
-  }
-  digitalWrite(txPin, LOW);
+	selectPulse(frame, (byte)par);
 }
 
-// build transmit sequence so that every high pulse is followed by low and vice versa
+// build transmit sequence so that every high pulse is followed by low and vice versa:
+// a one is two short pulses, a zero is one long pulse
 
-void wt440Transmitter::selectPulse(byte inBit) {
-    switch (inBit) {
-      case 0: 
-		if (high == true) {   // if current pulse should be high, send High Zero
-			sendPulse(2); 
-		} else {              // else send Low Zero
-			sendPulse(4);
-		}
-		high=!high; // invert next pulse
-	  break;
-      case 1:                // if current pulse should be high, send High One
-        if (high == true) {
-			sendPulse(3);			// High
-			sendPulse(5);			// low
-        } else {             // else send Low One
-			sendPulse(5);			// low
-			sendPulse(3);			// high
-        }
-        break;        
+void wt440Transmitter::selectPulse(PulseFrame &frame, byte inBit) {
+	if (inBit) {
+		frame.add(0);
+		frame.add(0);
+	} else {
+		frame.add(1);
 	}
 }
-
-// transmit pulses
-// slightly corrected pulse length, use old (commented out) values if these not working for you
-
-void wt440Transmitter::sendPulse(byte txPulse) {
-
-  switch(txPulse) { // transmit pulse
-   case 1: // Start
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(1100); // Not used
-   // digitalWrite(txPin, LOW); 
-   break;
-   case 2: // "High Zero"
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(PULSE0); // 2000
-   digitalWrite(txPin, HIGH);
-   break;   
-   case 3: // "High One"
-   digitalWrite(txPin, LOW);
-   delayMicroseconds(PULSE1); // 1000
-   digitalWrite(txPin, HIGH);
-   break;      
-   case 4: // "Low Zero"
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(PULSE0); // 2000
-   digitalWrite(txPin, LOW);
-   break;      
-   case 5: // "Low One"
-   digitalWrite(txPin, HIGH);
-   delayMicroseconds(PULSE1); // 1000
-   digitalWrite(txPin, LOW);
-   break;      
-  } 
-}
\ No newline at end of file
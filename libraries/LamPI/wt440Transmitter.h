@@ -8,6 +8,7 @@
 #define wt440_h
 
 #include "Arduino.h"
+#include "PulseTransmitter.h"
 
 #define STATISTICS 0
 
@@ -31,13 +32,11 @@ class wt440Transmitter
   public:
     wt440Transmitter(byte pin);
     void sendMsg(wt440TxCode msgCode);
+    void frameMsg(PulseFrame &frame, wt440TxCode msgCode); // queue with PulseTransmitter::queue()
   private:
     byte txPin;
 	byte i; // just a counter
-	byte pulse; // counter for command repeat
-	boolean high; // pulse "sign"
-	void selectPulse(byte inBit);
-	void sendPulse(byte txPulse);
+	void selectPulse(PulseFrame &frame, byte inBit);
 };
 
 #endif
\ No newline at end of file
@@ -16,7 +16,7 @@
 
 #define BMP085_ADDRESS 0x77	// I2C address of BMP085
 
-const unsigned char OSS = 0;  // Oversampling Setting
+const unsigned char OSS = BMP085_OSS;  // Oversampling Setting
 
 BMP085::BMP085()
 {
@@ -78,9 +78,32 @@ int16_t BMP085::Calibration()
 // Calculate temperature given ut.
 // Value returned will be in units of 0.1 deg C
 int16_t BMP085::GetTemperature()
+{
+  return CalculateTemperature(ReadUT());
+}
+
+// Start a temperature conversion, collect it BMP085_UT_DELAY ms later
+void BMP085::StartTemperature()
+{
+  // Write 0x2E into Register 0xF4
+  // This requests a temperature reading
+  Wire.beginTransmission(BMP085_ADDRESS);
+  Wire.write(0xF4);
+  Wire.write(0x2E);
+  Wire.endTransmission();
+}
+
+// Value returned will be in units of 0.1 deg C, 998 on a timeout
+int16_t BMP085::CollectTemperature()
+{
+  uint16_t ut = ReadInt(0xF6);
+  if (ut == 998) return 998;
+  return CalculateTemperature(ut);
+}
+
+int16_t BMP085::CalculateTemperature(uint16_t ut)
 {
   int32_t x1, x2;
-  uint16_t ut = ReadUT();
   x1 = (((int32_t)ut - (int32_t)ac6)*(int32_t)ac5) >> 15;
   x2 = ((int32_t)mc << 11)/(x1 + md);
   b5 = x1 + x2;
@@ -93,10 +116,33 @@ int16_t BMP085::GetTemperature()
 // b5 is also required so bmp085GetTemperature(...) must be called first.
 // Value returned will be pressure in units of Pa.
 int32_t BMP085::GetPressure()
+{
+  return CalculatePressure(ReadUP());	// This was a function parameter and now internal Class function
+}
+
+// Start a pressure conversion, collect it BMP085_UP_DELAY ms later
+void BMP085::StartPressure()
+{
+  // Write 0x34+(OSS<<6) into register 0xF4
+  // Request a pressure reading w/ oversampling setting
+  Wire.beginTransmission(BMP085_ADDRESS);
+  Wire.write(0xF4);
+  Wire.write(0x34 + (OSS<<6));
+  Wire.endTransmission();
+}
+
+// Value returned will be pressure in units of Pa, 998 on a timeout
+int32_t BMP085::CollectPressure()
+{
+  uint32_t up = CollectUP();
+  if (up == 998) return 998;
+  return CalculatePressure(up);
+}
+
+int32_t BMP085::CalculatePressure(uint32_t up)
 {
   int32_t x1, x2, x3, b3, b6, p;
   uint32_t b4, b7;
-  uint32_t up = ReadUP();				// This was a function parameter and now internal Class function
 
   b6 = b5 - 4000;
   // Calculate B3
@@ -151,38 +197,31 @@ int8_t BMP085::Read(uint8_t address)
 // Read the uncompensated temperature value
 uint16_t BMP085::ReadUT()
 {
-  uint16_t ut;
-  
-  // Write 0x2E into Register 0xF4
-  // This requests a temperature reading
-  Wire.beginTransmission(BMP085_ADDRESS);
-  Wire.write(0xF4);
-  Wire.write(0x2E);
-  Wire.endTransmission();
+  StartTemperature();
   
   // Wait at least 4.5ms
-  delay(5);
+  delay(BMP085_UT_DELAY);
   
   // Read two bytes from registers 0xF6 and 0xF7
-  ut = ReadInt(0xF6);
-  return ut;
+  return ReadInt(0xF6);
 }
 
 // Read the uncompensated pressure value
 uint32_t BMP085::ReadUP()
 {
-  uint8_t msb, lsb, xlsb;
-  uint32_t up = 0;
-  
-  // Write 0x34+(OSS<<6) into register 0xF4
-  // Request a pressure reading w/ oversampling setting
-  Wire.beginTransmission(BMP085_ADDRESS);
-  Wire.write(0xF4);
-  Wire.write(0x34 + (OSS<<6));
-  Wire.endTransmission();
+  StartPressure();
   
   // Wait for conversion, delay time dependent on OSS
-  delay(2 + (3<<OSS));
+  delay(BMP085_UP_DELAY);
+  
+  return CollectUP();
+}
+
+// Read the uncompensated pressure value of the conversion started by StartPressure()
+uint32_t BMP085::CollectUP()
+{
+  uint8_t msb, lsb, xlsb;
+  uint32_t up = 0;
   
   // Read register 0xF6 (MSB), 0xF7 (LSB), and 0xF8 (XLSB)
   Wire.beginTransmission(BMP085_ADDRESS);
@@ -13,6 +13,10 @@
 #include <Arduino.h>
 
 #define BMP085_ADDRESS 0x77  // I2C address of BMP085
+#define BMP085_OSS 0         // Oversampling Setting
+
+#define BMP085_UT_DELAY 5                       // ms from StartTemperature() to CollectTemperature()
+#define BMP085_UP_DELAY (2 + (3<<BMP085_OSS))   // ms from StartPressure() to CollectPressure()
 
 class BMP085 {
 	
@@ -25,6 +29,13 @@ public:
   int16_t GetTemperature();
   int32_t GetPressure();
 
+  // Split versions of the Get functions, for doing other work while the sensor converts.
+  // CollectTemperature() must be called before CollectPressure(), as for the Get functions.
+  void StartTemperature();
+  int16_t CollectTemperature();
+  void StartPressure();
+  int32_t CollectPressure();
+
   //Public Variables
 
   // Use these for altitude conversions
@@ -36,6 +47,9 @@ private:
   int8_t Read(uint8_t address);
   uint16_t ReadUT();
   uint32_t ReadUP();
+  uint32_t CollectUP();
+  int16_t CalculateTemperature(uint16_t ut);
+  int32_t CalculatePressure(uint32_t up);
   
   
   //Private Variables